@@ -0,0 +1,364 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*          Arm kinematics and plans         */
+/*                                           */
+/*  The arm is two servos in the robot's     */
+/*  center plane: the base servo swings the  */
+/*  base arm about a shaft on the front of   */
+/*  the chassis, and the on-arm servo at the */
+/*  end of it swings the second arm. Points  */
+/*  are in that plane, in inches forward of  */
+/*  the wheel axis (like the tool frames)    */
+/*  and up from the floor.                   */
+/*                                           */
+/*  arm_forward() finds the tip for a pair   */
+/*  of servo degrees, arm_inverse() the      */
+/*  degrees for a tip. Each joint's travel   */
+/*  comes from its servo's min/max pulse     */
+/*  widths, its speed from the servo         */
+/*  calibration. arm_plan() moves both       */
+/*  servos together so they arrive at the    */
+/*  same time at full speed, and goes        */
+/*  around through the base stow angle when  */
+/*  the straight path would put the arm      */
+/*  into the chassis or the floor.           */
+/*                                           */
+/*  Nothing here touches the hardware, so    */
+/*  the host tools can use it too. The arm   */
+/*  lengths below are estimates that agree   */
+/*  with the arm reach the tool frames and   */
+/*  the course model use. Measure the robot  */
+/*  and update them before trusting a plan   */
+/*  near the chassis.                        */
+/*********************************************/
+
+#ifndef ARM_H
+#define ARM_H
+
+#include <cmath> // Not <math.h>, that would change which abs() main.cpp gets
+
+/************************************************/
+// Definitions
+
+// Arm geometry (inches)
+#define ARM_PIVOT_FORWARD 3.0f // Base servo shaft ahead of the wheel axis
+#define ARM_PIVOT_HEIGHT 3.5f // Base servo shaft above the floor
+#define ARM_BASE_LENGTH 4.6f // Base servo shaft to the on-arm servo shaft
+#define ARM_ON_ARM_LENGTH 3.0f // On-arm servo shaft to the tip of the second arm
+
+// Joint angles at 0 servo degrees (degrees, counterclockwise seen from the robot's right side)
+#define ARM_BASE_ZERO -40.6f // Base arm below horizontal, its end 6.5 in ahead of the axis and 0.5 in up
+#define ARM_ON_ARM_ZERO -180.0f // Second arm folded back along the base arm
+
+#define ARM_DEGREES_PER_US 0.1f // Servo horn turn per microsecond of pulse width
+
+// What the arm must stay out of (inches)
+#define ARM_CHASSIS_FRONT 3.0f // Front of the chassis ahead of the wheel axis
+#define ARM_CHASSIS_BACK -4.0f // Back of the chassis (negative is behind the axis)
+#define ARM_CHASSIS_TOP 3.0f // Top of the chassis above the floor
+#define ARM_CLEARANCE 0.25f // Closest the arm may come to the chassis or floor
+#define ARM_CHECK_SPACING 0.5f // Inches between the points checked along each arm
+
+// Planning
+#define ARM_SERVO_SPEED 250.0f // Degrees per second a servo turns at full speed (under load) until it is calibrated
+#define ARM_PLAN_CHECK 2.0f // Servo degrees between the poses checked along a path
+#define ARM_PLAN_POINTS 3 // Most waypoints in a plan
+#define ARM_SAFE_BASE 85.0f // Base servo degrees a plan goes through when the straight path is blocked
+#define ARM_STEP_TIME 0.02f // Seconds between servo updates while a plan runs (one servo pulse)
+
+/************************************************/
+// Types
+
+// Degrees for each servo, the way SetDegree() takes them (0 to 180)
+struct ArmJoints {
+    float base;
+    float onArm;
+};
+
+// A point in the arm's plane
+struct ArmPoint {
+    float forward; // Inches ahead of the wheel axis
+    float height; // Inches above the floor
+};
+
+/*******************************************************
+ * @brief One servo joint. The servo sweeps its 0 to 180 degrees over its min to
+ * max pulse width, so its real travel is that span times ARM_DEGREES_PER_US.
+ */
+struct ArmJoint {
+    float minPulse, maxPulse; // SetMin()/SetMax() values
+    float zero; // Joint angle at 0 servo degrees
+    float speed; // Degrees per second the joint turns at full speed
+
+    // Real degrees the joint turns from servo 0 to servo 180
+    constexpr float travel() const { return (maxPulse - minPulse) * ARM_DEGREES_PER_US; }
+
+    // Joint angle for servo degrees
+    constexpr float to_angle(float degree) const { return zero + degree * (travel() / 180); }
+
+    // Servo degrees for a joint angle (outside 0 to 180 if the joint can't reach it)
+    constexpr float to_degree(float angle) const { return (angle - zero) * (180 / travel()); }
+};
+
+// Both joints. The on-arm angle is measured from the base arm's direction.
+struct ArmModel {
+    ArmJoint base;
+    ArmJoint onArm;
+};
+
+/*******************************************************
+ * @brief Coordinated moves through up to ARM_PLAN_POINTS waypoints. Both servos
+ * leave and arrive at each waypoint together.
+ */
+struct ArmPlan {
+    int count; // Waypoints after start
+    ArmJoints start;
+    ArmJoints points[ARM_PLAN_POINTS];
+    float seconds[ARM_PLAN_POINTS]; // Time to each waypoint from the one before
+    float total; // Seconds for the whole plan
+};
+
+/************************************************/
+// Kinematics
+
+/*******************************************************
+ * @brief Where the on-arm servo shaft and the tip are for a pair of servo degrees
+ *
+ * @param elbow Set to the on-arm servo shaft (may be null)
+ * @return ArmPoint The tip
+ */
+inline ArmPoint arm_forward(const ArmModel &model, ArmJoints joints, ArmPoint *elbow = 0) {
+    float baseRad = model.base.to_angle(joints.base) * (3.14159265f / 180);
+    float onArmRad = baseRad + model.onArm.to_angle(joints.onArm) * (3.14159265f / 180);
+
+    ArmPoint shaft = { ARM_PIVOT_FORWARD + ARM_BASE_LENGTH * std::cos(baseRad),
+                       ARM_PIVOT_HEIGHT + ARM_BASE_LENGTH * std::sin(baseRad) };
+    if (elbow) {
+        *elbow = shaft;
+    }
+
+    ArmPoint tip = { shaft.forward + ARM_ON_ARM_LENGTH * std::cos(onArmRad),
+                     shaft.height + ARM_ON_ARM_LENGTH * std::sin(onArmRad) };
+    return tip;
+}
+
+/*******************************************************
+ * @brief Whether a point is inside the chassis or floor, with the clearance
+ */
+inline bool arm_point_blocked(ArmPoint point) {
+    if (point.height < ARM_CLEARANCE) {
+        return true;
+    }
+    return (point.forward > ARM_CHASSIS_BACK - ARM_CLEARANCE) &&
+           (point.forward < ARM_CHASSIS_FRONT - ARM_CLEARANCE) &&
+           (point.height < ARM_CHASSIS_TOP + ARM_CLEARANCE);
+}
+
+/*******************************************************
+ * @brief Whether either arm runs into the chassis or the floor at a pose.
+ * The base shaft sits on the chassis, so the first check is a bit out from it.
+ *
+ * @return bool true if the pose hits something
+ */
+inline bool arm_collides(const ArmModel &model, ArmJoints joints) {
+    ArmPoint elbow;
+    ArmPoint tip = arm_forward(model, joints, &elbow);
+    ArmPoint pivot = { ARM_PIVOT_FORWARD, ARM_PIVOT_HEIGHT };
+
+    // Base arm
+    int checks = (int)std::ceil(ARM_BASE_LENGTH / ARM_CHECK_SPACING);
+    for (int i = 1; i <= checks; i++) {
+        float t = (float)i / checks;
+        ArmPoint point = { pivot.forward + t * (elbow.forward - pivot.forward),
+                           pivot.height + t * (elbow.height - pivot.height) };
+        if (arm_point_blocked(point)) {
+            return true;
+        }
+    }
+
+    // Second arm
+    checks = (int)std::ceil(ARM_ON_ARM_LENGTH / ARM_CHECK_SPACING);
+    for (int i = 1; i <= checks; i++) {
+        float t = (float)i / checks;
+        ArmPoint point = { elbow.forward + t * (tip.forward - elbow.forward),
+                           elbow.height + t * (tip.height - elbow.height) };
+        if (arm_point_blocked(point)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************
+ * @brief Servo degrees for a joint angle, trying it a turn either way so an
+ * angle that wrapped around still lands in the joint's travel
+ *
+ * @return bool false if the joint can't reach it
+ */
+inline bool arm_joint_degree(const ArmJoint &joint, float angle, float *degree) {
+    for (int turn = -1; turn <= 1; turn++) {
+        float servo = joint.to_degree(angle + turn * 360.0f);
+        if ((servo >= 0) && (servo <= 180)) {
+            *degree = servo;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*******************************************************
+ * @brief Servo degrees that put the tip on a point. Of the two ways to bend the
+ * arm there, picks the one in both joints' travel that doesn't hit anything
+ * and is closest to near.
+ *
+ * @param tip Point for the tip
+ * @param near Pose the arm is in now
+ * @param joints Set to the servo degrees
+ * @return bool false if the tip can't get there
+ */
+inline bool arm_inverse(const ArmModel &model, ArmPoint tip, ArmJoints near, ArmJoints *joints) {
+    float dx = tip.forward - ARM_PIVOT_FORWARD;
+    float dy = tip.height - ARM_PIVOT_HEIGHT;
+
+    // Law of cosines for the bend between the arms
+    float bendCos = (dx * dx + dy * dy - ARM_BASE_LENGTH * ARM_BASE_LENGTH - ARM_ON_ARM_LENGTH * ARM_ON_ARM_LENGTH) /
+                    (2 * ARM_BASE_LENGTH * ARM_ON_ARM_LENGTH);
+    if ((bendCos < -1) || (bendCos > 1)) {
+        return false;
+    }
+
+    bool found = false;
+    float bestChange = 0;
+    for (int side = -1; side <= 1; side += 2) {
+        float bend = side * std::acos(bendCos);
+        float base = std::atan2(dy, dx) - std::atan2(ARM_ON_ARM_LENGTH * std::sin(bend), ARM_BASE_LENGTH + ARM_ON_ARM_LENGTH * std::cos(bend));
+
+        ArmJoints option;
+        if (!arm_joint_degree(model.base, base * (180 / 3.14159265f), &option.base) ||
+            !arm_joint_degree(model.onArm, bend * (180 / 3.14159265f), &option.onArm) ||
+            arm_collides(model, option)) {
+            continue;
+        }
+
+        float change = std::fabs(option.base - near.base) + std::fabs(option.onArm - near.onArm);
+        if (!found || (change < bestChange)) {
+            *joints = option;
+            bestChange = change;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+/************************************************/
+// Plans
+
+/*******************************************************
+ * @brief Seconds for both servos to get from one pose to another at full speed
+ */
+inline float arm_move_time(const ArmModel &model, ArmJoints from, ArmJoints to) {
+    float baseTime = std::fabs(to.base - from.base) * (model.base.travel() / 180) / model.base.speed;
+    float onArmTime = std::fabs(to.onArm - from.onArm) * (model.onArm.travel() / 180) / model.onArm.speed;
+    return std::fmax(baseTime, onArmTime);
+}
+
+/*******************************************************
+ * @brief Whether moving both servos together from one pose to another stays clear
+ */
+inline bool arm_path_clear(const ArmModel &model, ArmJoints from, ArmJoints to) {
+    float change = std::fmax(std::fabs(to.base - from.base), std::fabs(to.onArm - from.onArm));
+    int checks = (int)std::ceil(change / ARM_PLAN_CHECK);
+    for (int i = 1; i <= checks; i++) {
+        float t = (float)i / checks;
+        ArmJoints pose = { from.base + t * (to.base - from.base), from.onArm + t * (to.onArm - from.onArm) };
+        if (arm_collides(model, pose)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*******************************************************
+ * @brief Plans a move between two poses. Goes straight if that is clear,
+ * otherwise raises the base to ARM_SAFE_BASE, swings the second arm there
+ * and lowers the base again.
+ *
+ * @param plan Filled in
+ * @return bool false if neither way is clear (or either pose hits something)
+ */
+inline bool arm_plan(const ArmModel &model, ArmJoints from, ArmJoints to, ArmPlan *plan) {
+    plan->start = from;
+    plan->count = 0;
+    plan->total = 0;
+
+    if (arm_collides(model, to)) {
+        return false;
+    }
+
+    ArmJoints via[ARM_PLAN_POINTS];
+    int count = 0;
+    if (arm_path_clear(model, from, to)) {
+        via[count++] = to;
+    } else {
+        ArmJoints up = { ARM_SAFE_BASE, from.onArm };
+        ArmJoints over = { ARM_SAFE_BASE, to.onArm };
+        via[count++] = up;
+        via[count++] = over;
+        via[count++] = to;
+    }
+
+    ArmJoints last = from;
+    for (int i = 0; i < count; i++) {
+        if (!arm_path_clear(model, last, via[i])) {
+            plan->count = 0;
+            plan->total = 0;
+            return false;
+        }
+        plan->points[i] = via[i];
+        plan->seconds[i] = arm_move_time(model, last, via[i]);
+        plan->total += plan->seconds[i];
+        plan->count++;
+        last = via[i];
+    }
+    return true;
+}
+
+/*******************************************************
+ * @brief Plans a move that ends with the tip on a point
+ *
+ * @return bool false if the tip can't get there or the way is blocked
+ */
+inline bool arm_plan_to(const ArmModel &model, ArmJoints from, ArmPoint tip, ArmPlan *plan) {
+    ArmJoints to;
+    if (!arm_inverse(model, tip, from, &to)) {
+        plan->start = from;
+        plan->count = 0;
+        plan->total = 0;
+        return false;
+    }
+    return arm_plan(model, from, to, plan);
+}
+
+/*******************************************************
+ * @brief Where the servos should be a time into a plan
+ *
+ * @param seconds Time since the plan started
+ */
+inline ArmJoints arm_plan_at(const ArmPlan &plan, float seconds) {
+    ArmJoints last = plan.start;
+    for (int i = 0; i < plan.count; i++) {
+        if (seconds < plan.seconds[i]) {
+            float t = seconds / plan.seconds[i];
+            ArmJoints pose = { last.base + t * (plan.points[i].base - last.base),
+                               last.onArm + t * (plan.points[i].onArm - last.onArm) };
+            return pose;
+        }
+        seconds -= plan.seconds[i];
+        last = plan.points[i];
+    }
+    return last;
+}
+
+#endif
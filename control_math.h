@@ -0,0 +1,173 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*            Control loop math              */
+/*                                           */
+/*  The Proteus FPU only does single         */
+/*  precision, so every double operation is  */
+/*  done in software. The PID and odometry   */
+/*  math runs on control_t instead, picked   */
+/*  at compile time with CONTROL_MATH:       */
+/*                                           */
+/*    CONTROL_MATH_DOUBLE  double (old path) */
+/*    CONTROL_MATH_FLOAT   float (default)   */
+/*    CONTROL_MATH_FIXED   16.16 fixed point */
+/*                                           */
+/*  The PID math is a template so            */
+/*  host/control_accuracy can run all three  */
+/*  side by side.                            */
+/*********************************************/
+
+#ifndef CONTROL_MATH_H
+#define CONTROL_MATH_H
+
+#include <stdint.h>
+
+/************************************************/
+// Definitions
+#define CONTROL_MATH_DOUBLE 0
+#define CONTROL_MATH_FLOAT 1
+#define CONTROL_MATH_FIXED 2
+
+#ifndef CONTROL_MATH
+#define CONTROL_MATH CONTROL_MATH_FLOAT
+#endif
+
+#define FIXED_FRACTION_BITS 16
+#define FIXED_ONE (1 << FIXED_FRACTION_BITS)
+
+/*******************************************************
+ * @brief Signed 16.16 fixed point number. Covers +/-32767 with a resolution
+ * of 1/65536, which fits counts, inches, seconds of a run and PID terms.
+ * Multiplies and divides go through 64 bits so they don't overflow in between.
+ */
+class Fixed {
+public:
+    Fixed() : raw(0) {}
+    Fixed(int i) : raw(i * FIXED_ONE) {}
+    Fixed(float f) : raw((int32_t)(f * FIXED_ONE + ((f < 0) ? -0.5f : 0.5f))) {}
+    Fixed(double d) : raw((int32_t)(d * FIXED_ONE + ((d < 0) ? -0.5 : 0.5))) {}
+
+    static Fixed from_raw(int32_t raw) {
+        Fixed f;
+        f.raw = raw;
+        return f;
+    }
+
+    explicit operator float() const { return (float)raw / FIXED_ONE; }
+    explicit operator double() const { return (double)raw / FIXED_ONE; }
+
+    friend Fixed operator+(Fixed a, Fixed b) { return from_raw(a.raw + b.raw); }
+    friend Fixed operator-(Fixed a, Fixed b) { return from_raw(a.raw - b.raw); }
+    friend Fixed operator*(Fixed a, Fixed b) { return from_raw((int32_t)(((int64_t)a.raw * b.raw) >> FIXED_FRACTION_BITS)); }
+    friend Fixed operator/(Fixed a, Fixed b) {
+        if (b.raw == 0) {
+            return from_raw((a.raw < 0) ? INT32_MIN : INT32_MAX); // Saturates like dividing by zero would
+        }
+        return from_raw((int32_t)(((int64_t)a.raw * FIXED_ONE) / b.raw));
+    }
+    Fixed operator-() const { return from_raw(-raw); }
+    Fixed &operator+=(Fixed b) { raw += b.raw; return *this; }
+    Fixed &operator-=(Fixed b) { raw -= b.raw; return *this; }
+
+    friend bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+    friend bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+    friend bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+    friend bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+
+private:
+    int32_t raw;
+};
+
+#if CONTROL_MATH == CONTROL_MATH_DOUBLE
+typedef double control_t;
+#elif CONTROL_MATH == CONTROL_MATH_FLOAT
+typedef float control_t;
+#elif CONTROL_MATH == CONTROL_MATH_FIXED
+typedef Fixed control_t;
+#else
+#error "CONTROL_MATH must be CONTROL_MATH_DOUBLE, CONTROL_MATH_FLOAT or CONTROL_MATH_FIXED"
+#endif
+
+/************************************************/
+// PID
+
+template <typename T> struct PIDWheel;
+template <typename T> void pid_reset(PIDWheel<T> &wheel, double startTime);
+
+/*******************************************************
+ * @brief PID state of one wheel
+ */
+template <typename T>
+struct PIDWheel {
+    T linearSpeed, newCounts, lastCounts, newTime, lastTime, newSpeedError, lastSpeedError, errorSum;
+    T pTerm, iTerm, dTerm;
+    T pConst, iConst, dConst;
+    double startTime; // TimeNow() the move started at. newTime and lastTime count from here, so they stay small enough for T.
+
+    PIDWheel(float p, float i, float d) : pConst(p), iConst(i), dConst(d) {
+        pid_reset(*this, 0);
+        errorSum = 0;
+    }
+};
+
+/*******************************************************
+ * @brief Clears a wheel's state before a new move. The error sum carries
+ * over between moves (as it always has).
+ *
+ * @param startTime TimeNow() at the start of the move
+ */
+template <typename T>
+void pid_reset(PIDWheel<T> &wheel, double startTime) {
+    wheel.startTime = startTime;
+    wheel.linearSpeed = 0;
+    wheel.newCounts = 0;
+    wheel.lastCounts = 0;
+    wheel.newTime = 0;
+    wheel.lastTime = 0;
+    wheel.newSpeedError = 0;
+    wheel.lastSpeedError = 0;
+    wheel.pTerm = 0;
+    wheel.iTerm = 0;
+    wheel.dTerm = 0;
+}
+
+/*******************************************************
+ * @brief One PID step for a wheel
+ *
+ * @param distancePerCount Inches per encoder count
+ * @param counts Encoder counts now
+ * @param now TimeNow() when the counts were read. Only the time since
+ * pid_reset() is kept in T, since a float or 16.16 value of the whole
+ * uptime loses the step's milliseconds.
+ * @param expectedSpeed Speed to hold in inches per second
+ * @param oldPower Motor percent set on the last step
+ * @return float Motor percent to set now
+ */
+template <typename T>
+float pid_adjust(PIDWheel<T> &wheel, T distancePerCount, int counts, double now, T expectedSpeed, float oldPower) {
+
+    // Finds change in counts and time since last time
+    wheel.lastCounts = wheel.newCounts;
+    wheel.newCounts = counts;
+    wheel.lastTime = wheel.newTime;
+    wheel.newTime = (T)(now - wheel.startTime);
+
+    // Finds actual velocity
+    wheel.linearSpeed = distancePerCount * ((wheel.newCounts - wheel.lastCounts) / (wheel.newTime - wheel.lastTime));
+
+    // Finds error and adds it to the error sum
+    wheel.newSpeedError = expectedSpeed - wheel.linearSpeed;
+    wheel.errorSum += wheel.newSpeedError;
+
+    // Calculates the terms
+    wheel.pTerm = wheel.newSpeedError * wheel.pConst;
+    wheel.iTerm = wheel.errorSum * wheel.iConst;
+    wheel.dTerm = (wheel.newSpeedError - wheel.lastSpeedError) * wheel.dConst;
+
+    // Saves past error
+    wheel.lastSpeedError = wheel.newSpeedError;
+
+    return oldPower + (float)(wheel.pTerm + wheel.iTerm + wheel.dTerm);
+}
+
+#endif
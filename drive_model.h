@@ -0,0 +1,190 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*             Drive model file              */
+/*                                           */
+/*  Keeps what the SYSID_DRIVE mode fitted   */
+/*  for each drive motor on the SD card: a   */
+/*  first order model for each surface and   */
+/*  direction, so controllers can work out   */
+/*  the percent for a speed and the host     */
+/*  simulator (simulate --drive) can drive   */
+/*  like the real robot. Everything here is  */
+/*  inline, since the simulator includes it  */
+/*  next to main.cpp. A model settles at     */
+/*    gain * (percent - deadband)            */
+/*  inches per second, reaching 63% of a new */
+/*  speed in timeConstant seconds.           */
+/*                                           */
+/*  File layout (forward, then backward,     */
+/*  then the chirp's RMS inches off the      */
+/*  forward model):                          */
+/*    DRIVE <version>                        */
+/*    FLOOR LEFT <gain> <deadband> <time     */
+/*      constant> <gain> <deadband> <time    */
+/*      constant> <chirp error>              */
+/*    FLOOR RIGHT ...                        */
+/*    RAMP LEFT ...                          */
+/*    RAMP RIGHT ...                         */
+/*    END                                    */
+/*********************************************/
+
+#ifndef DRIVE_MODEL_H
+#define DRIVE_MODEL_H
+
+#include <FEHSD.h>
+
+/************************************************/
+// Definitions
+#define DRIVE_MODEL_VERSION 1
+#define DRIVE_MODEL_FILE "drive.txt"
+
+#define DRIVE_SURFACES 2 // Same order as SURFACE_FLOOR and SURFACE_RAMP
+#define DRIVE_SIDES 2 // Left, right
+#define DRIVE_DIRECTIONS 2 // Forward, backward
+
+#define DRIVE_FLOOR 0 // SURFACE_FLOOR
+#define DRIVE_RAMP 1 // SURFACE_RAMP
+#define DRIVE_LEFT 0
+#define DRIVE_RIGHT 1
+#define DRIVE_FORWARD 0
+#define DRIVE_BACKWARD 1
+
+/*******************************************************
+ * @brief One motor in one direction
+ */
+struct MotorModel {
+    float gain; // Inches per second for each percent past the deadband
+    float deadband; // Percent that only keeps the wheel from turning
+    float timeConstant; // Seconds to reach 63% of a new speed
+};
+
+/*******************************************************
+ * @brief Every drive motor on every surface
+ */
+struct DriveModel {
+    MotorModel motor[DRIVE_SURFACES][DRIVE_SIDES][DRIVE_DIRECTIONS];
+    float chirpError[DRIVE_SURFACES][DRIVE_SIDES]; // RMS inches the chirp's counts were off the forward model
+};
+
+/*******************************************************
+ * @brief Whether a model could be real
+ */
+inline bool motor_model_valid(const MotorModel &model) {
+    return (model.gain > 0) && (model.deadband >= 0) && (model.deadband < 100) && (model.timeConstant > 0);
+}
+
+/*******************************************************
+ * @brief Speed a motor settles at for a percent (negative for backward)
+ *
+ * @return float Inches per second, with the percent's sign
+ */
+inline float motor_model_speed(const MotorModel &model, float percent) {
+    float magnitude = (percent < 0) ? -percent : percent;
+    if (magnitude <= model.deadband) {
+        return 0;
+    }
+    float speed = model.gain * (magnitude - model.deadband);
+    return (percent < 0) ? -speed : speed;
+}
+
+/*******************************************************
+ * @brief Percent that settles at a speed, for feedforward
+ *
+ * @param speed Inches per second (negative for backward)
+ * @return float Motor percent, with the speed's sign
+ */
+inline float motor_model_percent(const MotorModel &model, float speed) {
+    if (speed == 0) {
+        return 0;
+    }
+    float magnitude = ((speed < 0) ? -speed : speed) / model.gain + model.deadband;
+    return (speed < 0) ? -magnitude : magnitude;
+}
+
+/*******************************************************
+ * @brief Model for a motor running at a percent
+ *
+ * @param surface SURFACE_FLOOR or SURFACE_RAMP
+ * @param side DRIVE_LEFT or DRIVE_RIGHT
+ */
+inline const MotorModel &drive_model_for(const DriveModel &model, int surface, int side, float percent) {
+    return model.motor[surface][side][(percent < 0) ? DRIVE_BACKWARD : DRIVE_FORWARD];
+}
+
+/*******************************************************
+ * @brief Reads one motor's line. Leaves it alone if the line is bad.
+ */
+inline bool drive_model_load_line(FEHFile *file, const char format[], MotorModel models[], float &chirpError) {
+    MotorModel read[DRIVE_DIRECTIONS];
+    float readError;
+    if (SD.FScanf(file, format, &read[0].gain, &read[0].deadband, &read[0].timeConstant, &read[1].gain,
+                  &read[1].deadband, &read[1].timeConstant, &readError) != 7) {
+        return false;
+    }
+    if (!motor_model_valid(read[0]) || !motor_model_valid(read[1]) || (readError < 0)) {
+        return false;
+    }
+
+    models[0] = read[0];
+    models[1] = read[1];
+    chirpError = readError;
+    return true;
+}
+
+/*******************************************************
+ * @brief Reads the drive model file. A motor whose line is missing or bad
+ * keeps the values it came in with, and so does every line after it.
+ *
+ * @param path File to read
+ * @return bool true if every motor was read
+ */
+inline bool drive_model_load(const char path[], DriveModel &model) {
+    FEHFile *file = SD.FOpen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    static const char *formats[DRIVE_SURFACES][DRIVE_SIDES] = {
+        { " FLOOR LEFT %f %f %f %f %f %f %f", " FLOOR RIGHT %f %f %f %f %f %f %f" },
+        { " RAMP LEFT %f %f %f %f %f %f %f", " RAMP RIGHT %f %f %f %f %f %f %f" },
+    };
+
+    int version = 0;
+    bool haveAll = (SD.FScanf(file, "DRIVE %d", &version) == 1) && (version == DRIVE_MODEL_VERSION);
+    for (int surface = 0; haveAll && (surface < DRIVE_SURFACES); surface++) {
+        for (int side = 0; haveAll && (side < DRIVE_SIDES); side++) {
+            haveAll = drive_model_load_line(file, formats[surface][side], model.motor[surface][side],
+                                            model.chirpError[surface][side]);
+        }
+    }
+    SD.FClose(file);
+
+    return haveAll;
+}
+
+/*******************************************************
+ * @brief Writes the drive model file
+ *
+ * @param path File to write
+ */
+inline void drive_model_save(const char path[], const DriveModel &model) {
+    static const char *names[DRIVE_SURFACES][DRIVE_SIDES] = { { "FLOOR LEFT", "FLOOR RIGHT" },
+                                                              { "RAMP LEFT", "RAMP RIGHT" } };
+
+    FEHFile *file = SD.FOpen(path, "w");
+
+    SD.FPrintf(file, "DRIVE %d\n", DRIVE_MODEL_VERSION);
+    for (int surface = 0; surface < DRIVE_SURFACES; surface++) {
+        for (int side = 0; side < DRIVE_SIDES; side++) {
+            const MotorModel *motor = model.motor[surface][side];
+            SD.FPrintf(file, "%s %.4f %.2f %.3f %.4f %.2f %.3f %.3f\n", names[surface][side], motor[0].gain,
+                       motor[0].deadband, motor[0].timeConstant, motor[1].gain, motor[1].deadband,
+                       motor[1].timeConstant, model.chirpError[surface][side]);
+        }
+    }
+    SD.FPrintf(file, "END\n");
+
+    SD.FClose(file);
+}
+
+#endif
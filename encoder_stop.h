@@ -0,0 +1,122 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*            Encoder target stop            */
+/*                                           */
+/*  Ends an encoder move at a target count.  */
+/*  The counts are polled in a tight loop    */
+/*  that only adds two counts and compares   */
+/*  them to a precomputed integer, and the   */
+/*  motors are cut when it sees the target.  */
+/*  The FEH library owns the encoder         */
+/*  interrupt and has no hook for it, so     */
+/*  the stop can't be done on the edge.      */
+/*                                           */
+/*  Every stop is measured into              */
+/*  encoderStopLast.                         */
+/*                                           */
+/*  MUST be included after probes.h,         */
+/*  telemetry.h and units.h.                 */
+/*********************************************/
+
+#ifndef ENCODER_STOP_H
+#define ENCODER_STOP_H
+
+#include <cmath> // ceil()
+
+#ifdef HOST_BUILD
+#include "feh_host.h"
+#endif
+
+/*******************************************************
+ * @brief How the last encoder move stopped
+ */
+struct EncoderStopReport {
+    int target; // Sum of both encoders the move stops at
+    int atStop; // Sum of both encoders when the loop saw the target
+    float latency; // Seconds from reaching the target to cutting the motors
+};
+
+/************************************************/
+// Global variables for the encoder stop
+EncoderStopReport encoderStopLast;
+
+/*******************************************************
+ * @brief Starts an encoder stop. The encoders must have just been reset.
+ *
+ * @param expectedCounts Average counts of the two drive encoders to stop at
+ * @return int Sum of both encoders to stop at
+ */
+int encoder_stop_arm(Counts expectedCounts) {
+    // (left + right) / 2 < expectedCounts for integer counts
+    int target = (int)ceil(2 * expectedCounts.value);
+
+#ifdef HOST_BUILD
+    host_hardware().EncoderStopArm(target);
+#endif
+
+    telemetry_sample(TELEMETRY_MOVE_START);
+    return target;
+}
+
+/*******************************************************
+ * @brief Records how an encoder stop went, once the motors are cut
+ *
+ * @param target Sum of both encoders it stopped at (from encoder_stop_arm())
+ * @param sum Sum of both encoders that was seen
+ * @param latency Estimated seconds from reaching the target to cutting the motors
+ */
+void encoder_stop_done(int target, int sum, float latency) {
+    encoderStopLast.target = target;
+    encoderStopLast.atStop = sum;
+    encoderStopLast.latency = latency;
+
+#ifdef HOST_BUILD
+    // The simulator knows exactly
+    double simLatency = host_hardware().EncoderStopLatency();
+    if (simLatency >= 0) {
+        encoderStopLast.latency = simLatency;
+    }
+#endif
+
+    telemetry_sample(TELEMETRY_MOVE_STOP);
+}
+
+/*******************************************************
+ * @brief Waits until the average of two encoders reaches expectedCounts,
+ * then stops both motors. The motors must already be running.
+ *
+ * @param left Left encoder
+ * @param right Right encoder
+ * @param leftMotor Left motor
+ * @param rightMotor Right motor
+ * @param expectedCounts Average counts of the two encoders to stop at
+ */
+void encoder_stop_wait(DigitalEncoder &left, DigitalEncoder &right, FEHMotor &leftMotor, FEHMotor &rightMotor, Counts expectedCounts) {
+    int target = encoder_stop_arm(expectedCounts);
+    int sum = 0, lastSum = 0;
+    int passes = 0;
+
+    // Both time reads go through the sensor trace so replays see them
+    double start = TimeNow();
+
+    // Keeps running until the counts add up to the target
+    {
+        ProbeScope probe(PROBE_ENCODER_STOP_LOOP);
+        do {
+            lastSum = sum;
+            sum = left.Counts() + right.Counts();
+            passes++;
+        } while (sum < target);
+    }
+
+    // Turn off motors
+    rightMotor.Stop();
+    leftMotor.Stop();
+
+    // The target was reached somewhere during the last pass through the loop
+    double pass = (TimeNow() - start) / passes;
+    float reached = (sum > lastSum) ? (float)(target - lastSum) / (sum - lastSum) : 1;
+    encoder_stop_done(target, sum, (1 - reached) * pass);
+}
+
+#endif
@@ -0,0 +1,40 @@
+// Host stand-in for the Proteus FEHIO library. See feh_host.h.
+#ifndef FEHIO_H
+#define FEHIO_H
+
+class FEHIO {
+public:
+    typedef enum {
+        P0_0 = 0, P0_1, P0_2, P0_3, P0_4, P0_5, P0_6, P0_7,
+        P1_0, P1_1, P1_2, P1_3, P1_4, P1_5, P1_6, P1_7,
+        P2_0, P2_1, P2_2, P2_3, P2_4, P2_5, P2_6, P2_7,
+        P3_0, P3_1, P3_2, P3_3, P3_4, P3_5, P3_6, P3_7
+    } FEHIOPin;
+
+    typedef enum {
+        RisingEdge = 0,
+        FallingEdge,
+        EitherEdge
+    } FEHIOInterruptTrigger;
+};
+
+class DigitalEncoder {
+public:
+    DigitalEncoder(FEHIO::FEHIOPin pin, FEHIO::FEHIOInterruptTrigger trigger = FEHIO::EitherEdge);
+    int Counts();
+    void ResetCounts();
+
+private:
+    int pin;
+};
+
+class AnalogInputPin {
+public:
+    AnalogInputPin(FEHIO::FEHIOPin pin);
+    float Value();
+
+private:
+    int pin;
+};
+
+#endif
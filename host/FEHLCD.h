@@ -0,0 +1,46 @@
+// Host stand-in for the Proteus FEHLCD library. See feh_host.h.
+#ifndef FEHLCD_H
+#define FEHLCD_H
+
+// Colors (24-bit RGB, same values as the Proteus library)
+#define BLACK 0x000000u
+#define WHITE 0xFFFFFFu
+#define RED 0xFF0000u
+#define GREEN 0x00FF00u
+#define BLUE 0x0000FFu
+#define YELLOW 0xFFFF00u
+#define GRAY 0x808080u
+
+class FEHLCD {
+public:
+    void Clear();
+    void Clear(unsigned int color);
+    void ClearBuffer();
+    void SetBackgroundColor(unsigned int color);
+    void SetFontColor(unsigned int color);
+    void FillRectangle(int x, int y, int width, int height);
+    void DrawHorizontalLine(int y, int x1, int x2);
+    void DrawVerticalLine(int x, int y1, int y2);
+
+    void Write(const char *str);
+    void Write(int i);
+    void Write(float f);
+    void Write(double d);
+    void Write(char c);
+    void WriteLine(const char *str);
+    void WriteLine(int i);
+    void WriteLine(float f);
+    void WriteLine(double d);
+    void WriteLine(char c);
+    void WriteRC(const char *str, int row, int col);
+    void WriteRC(int i, int row, int col);
+    void WriteRC(float f, int row, int col);
+    void WriteRC(double d, int row, int col);
+    void WriteRC(char c, int row, int col);
+
+    bool Touch(int *x, int *y);
+};
+
+extern FEHLCD LCD;
+
+#endif
@@ -0,0 +1,22 @@
+// Host stand-in for the Proteus FEHMotor library. See feh_host.h.
+#ifndef FEHMOTOR_H
+#define FEHMOTOR_H
+
+class FEHMotor {
+public:
+    typedef enum {
+        Motor0 = 0,
+        Motor1,
+        Motor2,
+        Motor3
+    } FEHMotorPort;
+
+    FEHMotor(FEHMotorPort port, float maxVoltage);
+    void SetPercent(float percent);
+    void Stop();
+
+private:
+    int port;
+};
+
+#endif
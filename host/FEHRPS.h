@@ -0,0 +1,18 @@
+// Host stand-in for the Proteus FEHRPS library. See feh_host.h.
+#ifndef FEHRPS_H
+#define FEHRPS_H
+
+class FEHRPS {
+public:
+    void InitializeTouchMenu();
+    float X();
+    float Y();
+    float Heading();
+    int Time();
+    char CurrentRegionLetter();
+    int GetIceCream();
+};
+
+extern FEHRPS RPS;
+
+#endif
@@ -0,0 +1,19 @@
+// Host stand-in for the Proteus FEHSD library. Files go to the current folder. See feh_host.h.
+#ifndef FEHSD_H
+#define FEHSD_H
+
+struct FEHFile;
+
+class FEHSD {
+public:
+    FEHFile *FOpen(const char *str, const char *mode);
+    int FClose(FEHFile *fptr);
+    int FCloseAll();
+    int FPrintf(FEHFile *fptr, const char *format, ...);
+    int FScanf(FEHFile *fptr, const char *format, ...);
+    int FEof(FEHFile *fptr);
+};
+
+extern FEHSD SD;
+
+#endif
@@ -0,0 +1,23 @@
+// Host stand-in for the Proteus FEHServo library. See feh_host.h.
+#ifndef FEHSERVO_H
+#define FEHSERVO_H
+
+class FEHServo {
+public:
+    typedef enum {
+        Servo0 = 0, Servo1, Servo2, Servo3,
+        Servo4, Servo5, Servo6, Servo7
+    } FEHServoPort;
+
+    FEHServo(FEHServoPort port);
+    void SetMin(int min);
+    void SetMax(int max);
+    void SetDegree(float degree);
+    void TouchCalibrate();
+    void Off();
+
+private:
+    int port;
+};
+
+#endif
@@ -0,0 +1,10 @@
+// Host stand-in for the Proteus FEHUtility library. See feh_host.h.
+#ifndef FEHUTILITY_H
+#define FEHUTILITY_H
+
+double TimeNow();
+void Sleep(int msec);
+void Sleep(float seconds);
+void Sleep(double seconds);
+
+#endif
@@ -0,0 +1,94 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*              Arm plan checker             */
+/*                                           */
+/*  Prints where the arm model in arm.h puts */
+/*  the tip for the servo poses the course   */
+/*  uses, so the lengths can be checked      */
+/*  against the robot. With a point, prints  */
+/*  the servo degrees for the tip there and  */
+/*  the plan from the stowed pose (or from   */
+/*  -f base on_arm).                         */
+/*                                           */
+/*  Usage: ./arm_plan [-f base on_arm]       */
+/*             [forward height]              */
+/*********************************************/
+
+#include "../arm.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Same as main.cpp
+#define BASE_SERVO_MIN 500
+#define BASE_SERVO_MAX 2290
+#define ON_ARM_SERVO_MIN 500
+#define ON_ARM_SERVO_MAX 2400
+
+static const ArmModel model = { { BASE_SERVO_MIN, BASE_SERVO_MAX, ARM_BASE_ZERO, ARM_SERVO_SPEED },
+                                { ON_ARM_SERVO_MIN, ON_ARM_SERVO_MAX, ARM_ON_ARM_ZERO, ARM_SERVO_SPEED } };
+
+// Servo poses from flip_burger(), flip_ice_cream_lever() and the ticket
+static const ArmJoints coursePoses[] = {
+    { 85, 8 }, { 0, 8 }, { 20, 8 }, { 45, 8 }, { 45, 145 }, { 55, 50 },
+    { 55, 180 }, { 85, 180 }, { 85, 90 }, { 40, 90 }, { 0, 180 }, { 50, 180 },
+    { 105, 8 }, { 0, 45 },
+};
+
+/*******************************************************
+ * @brief Prints a pose and where it puts the arm
+ */
+static void print_pose(ArmJoints joints) {
+    ArmPoint elbow;
+    ArmPoint tip = arm_forward(model, joints, &elbow);
+    printf("%6.1f %7.1f   %7.2f %7.2f   %7.2f %7.2f   %s\n", joints.base, joints.onArm, elbow.forward, elbow.height,
+           tip.forward, tip.height, arm_collides(model, joints) ? "HITS" : "clear");
+}
+
+int main(int argc, char *argv[]) {
+    ArmJoints from = { 85, 8 };
+    bool target = false;
+    ArmPoint tip = { 0, 0 };
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-f") && (i + 2 < argc)) {
+            from.base = atof(argv[++i]);
+            from.onArm = atof(argv[++i]);
+        } else if (!target && (i + 1 < argc) && (argv[i][0] != '-' || isdigit(argv[i][1]))) {
+            tip.forward = atof(argv[i]);
+            tip.height = atof(argv[++i]);
+            target = true;
+        } else {
+            fprintf(stderr, "usage: %s [-f base on_arm] [forward height]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    printf("Joint travel: base %.1f deg from %.1f, on-arm %.1f deg from %.1f\n", model.base.travel(), model.base.zero,
+           model.onArm.travel(), model.onArm.zero);
+    printf("Points are inches ahead of the wheel axis and above the floor.\n\n");
+    printf("%6s %7s   %15s   %15s\n", "base", "on_arm", "elbow", "tip");
+
+    if (!target) {
+        for (size_t i = 0; i < sizeof(coursePoses) / sizeof(coursePoses[0]); i++) {
+            print_pose(coursePoses[i]);
+        }
+        return 0;
+    }
+
+    ArmPlan plan;
+    if (!arm_plan_to(model, from, tip, &plan)) {
+        printf("No clear way to put the tip at %.2f, %.2f from %.1f, %.1f\n", tip.forward, tip.height, from.base,
+               from.onArm);
+        return 1;
+    }
+
+    print_pose(from);
+    for (int i = 0; i < plan.count; i++) {
+        print_pose(plan.points[i]);
+    }
+    printf("\n%d move%s, %.3f s\n", plan.count, (plan.count == 1) ? "" : "s", plan.total);
+    return 0;
+}
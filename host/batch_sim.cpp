@@ -0,0 +1,269 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*     Batch robot simulator (host, impl)    */
+/*********************************************/
+
+#include "batch_sim.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+/************************************************/
+// Definitions (same values as main.cpp)
+#define BATCH_PI 3.14159265 // PI
+#define BATCH_COUNT_PER_INCH (318 / (2 * 3.14159265 * 1.25)) // COUNT_PER_INCH
+#define BATCH_ROBOT_WIDTH 7.95 // ROBOT_WIDTH
+#define BATCH_BACKWARDS_CALIBRATOR 2.4 // BACKWARDS_CALIBRATOR
+
+/************************************************/
+// Program helpers
+
+static void add_op(BatchProgram &program, float leftPercent, float rightPercent, float targetCounts, float seconds) {
+    BatchOp op = { leftPercent, rightPercent, targetCounts, seconds };
+    program.push_back(op);
+}
+
+void batch_forward_inches(BatchProgram &program, int percent, float inches) {
+    add_op(program, percent, percent, BATCH_COUNT_PER_INCH * inches, BATCH_NEVER);
+}
+
+void batch_forward_seconds(BatchProgram &program, float percent, float seconds) {
+    if (percent < 0) {
+        percent -= BATCH_BACKWARDS_CALIBRATOR;
+    }
+    add_op(program, percent, percent, BATCH_NEVER, seconds);
+}
+
+void batch_turn_right(BatchProgram &program, int percent, float degrees) {
+    float expectedCounts = BATCH_COUNT_PER_INCH * ((degrees * BATCH_PI) / 180.0) * (BATCH_ROBOT_WIDTH / 2);
+    add_op(program, percent, -percent - BATCH_BACKWARDS_CALIBRATOR, expectedCounts, BATCH_NEVER);
+}
+
+void batch_turn_left(BatchProgram &program, int percent, float degrees) {
+    float expectedCounts = BATCH_COUNT_PER_INCH * ((degrees * BATCH_PI) / 180.0) * (BATCH_ROBOT_WIDTH / 2);
+    add_op(program, -percent - BATCH_BACKWARDS_CALIBRATOR, percent, expectedCounts, BATCH_NEVER);
+}
+
+void batch_sleep(BatchProgram &program, float seconds) {
+    add_op(program, 0, 0, BATCH_NEVER, seconds);
+}
+
+/************************************************/
+// BatchSim
+
+/*******************************************************
+ * @brief CourseModel::clearance() on the raw grid, written without branches
+ * so the step loop still vectorizes (the lookup becomes a gather)
+ */
+static inline float clearance_lookup(const float *grid, int gridWidth, int gridLength, float x, float y) {
+    int ix = (int)(x * (1 / COURSE_CELL));
+    int iy = (int)(y * (1 / COURSE_CELL));
+    ix = std::min(std::max(ix, 0), gridWidth - 1);
+    iy = std::min(std::max(iy, 0), gridLength - 1);
+    return grid[iy * gridWidth + ix];
+}
+
+BatchSim::BatchSim(int count, const SimParams &base, const BatchSpread &spread, unsigned seed)
+    : count(count), base(base), course(0), time(0), robotSteps(0),
+      countsPerInch(count), trackWidth(count), backwardsLoss(count),
+      x(count, SIM_START_X), y(count, SIM_START_Y),
+      headingCos(count, cos(SIM_START_HEADING * BATCH_PI / 180)), headingSin(count, sin(SIM_START_HEADING * BATCH_PI / 180)),
+      speedLeft(count, 0), speedRight(count, 0), countsLeft(count, 0), countsRight(count, 0),
+      percentLeft(count, 0), percentRight(count, 0),
+      targetCounts(count, BATCH_NEVER), endTime(count, BATCH_NEVER), opIndex(count, 0), done(count, 0),
+      stalledTime(count, 0), program(0) {
+    std::mt19937 random(seed);
+    std::normal_distribution<double> normal(0, 1);
+
+    for (int i = 0; i < count; i++) {
+        countsPerInch[i] = base.countsPerInch * (1 + spread.countsPerInch * normal(random));
+        trackWidth[i] = base.trackWidth * (1 + spread.trackWidth * normal(random));
+        backwardsLoss[i] = base.backwardsLoss + spread.backwardsLoss * normal(random);
+    }
+}
+
+float BatchSim::heading(int robot) const {
+    float degrees = atan2f(headingSin[robot], headingCos[robot]) * 180 / BATCH_PI;
+    return (degrees < 0) ? degrees + 360 : degrees;
+}
+
+void BatchSim::start_op(int robot, float now) {
+    countsLeft[robot] = 0;
+    countsRight[robot] = 0;
+
+    if (opIndex[robot] >= (int)program->size()) {
+        // Finished, motors off and nothing left to stop
+        percentLeft[robot] = 0;
+        percentRight[robot] = 0;
+        targetCounts[robot] = BATCH_NEVER;
+        endTime[robot] = BATCH_NEVER;
+        return;
+    }
+
+    const BatchOp &op = (*program)[opIndex[robot]];
+    percentLeft[robot] = op.leftPercent;
+    percentRight[robot] = op.rightPercent;
+    targetCounts[robot] = op.targetCounts;
+    endTime[robot] = (op.seconds >= BATCH_NEVER) ? BATCH_NEVER : now + op.seconds;
+}
+
+int BatchSim::run(const BatchProgram &newProgram, float timeout) {
+    program = &newProgram;
+    time = 0;
+    robotSteps = 0;
+    int finished = 0;
+
+    // Robots don't affect each other, so each block runs the whole program while its arrays are in cache
+    for (int begin = 0; begin < count; begin += BATCH_BLOCK) {
+        int end = std::min(begin + BATCH_BLOCK, count);
+        int blockFinished = newProgram.empty() ? end - begin : 0;
+        long steps = 0;
+        float now = 0;
+
+        for (int i = begin; i < end; i++) {
+            opIndex[i] = 0;
+            stalledTime[i] = 0;
+            start_op(i, now);
+        }
+
+        while ((blockFinished < end - begin) && (now < timeout)) {
+            int stopped = step(begin, end, now);
+            now = ++steps * BATCH_STEP;
+
+            // Rare compared to steps, so a plain loop is fine here
+            if (stopped) {
+                for (int i = begin; i < end; i++) {
+                    if (done[i]) {
+                        opIndex[i]++;
+                        start_op(i, now);
+                        if (opIndex[i] == (int)newProgram.size()) {
+                            blockFinished++;
+                        }
+                    }
+                }
+            }
+        }
+
+        finished += blockFinished;
+        robotSteps += (double)steps * (end - begin);
+        time = std::max(time, now);
+    }
+
+    return finished;
+}
+
+int BatchSim::step(int begin, int end, float now) {
+    return course ? step_robots<true>(begin, end, now) : step_robots<false>(begin, end, now);
+}
+
+template <bool collide> int BatchSim::step_robots(int begin, int end, float now) {
+    const float dt = BATCH_STEP;
+    const float blend = 1 - expf(-dt / base.motorTimeConstant);
+    const float inchesPerSecPerPercent = base.inchesPerSecPerPercent;
+
+    // Plain pointers to each array. Every robot only touches its own elements, which ivdep tells the compiler.
+    const float *cpi = countsPerInch.data();
+    const float *width = trackWidth.data();
+    const float *loss = backwardsLoss.data();
+    const float *pctL = percentLeft.data();
+    const float *pctR = percentRight.data();
+    const float *target = targetCounts.data();
+    const float *endAt = endTime.data();
+    float *px = x.data();
+    float *py = y.data();
+    float *hc = headingCos.data();
+    float *hs = headingSin.data();
+    float *vL = speedLeft.data();
+    float *vR = speedRight.data();
+    float *cL = countsLeft.data();
+    float *cR = countsRight.data();
+    unsigned char *stop = done.data();
+    float *stalled = stalledTime.data();
+
+    // Clearance grid, see CourseModel::clearance()
+    const float *grid = collide ? course->clearanceGrid.data() : 0;
+    const int gridWidth = collide ? course->gridWidth : 0;
+    const int gridLength = collide ? course->gridLength : 0;
+
+    int stopped = 0;
+#pragma GCC ivdep
+    for (int i = begin; i < end; i++) {
+        // Motors running backwards are weaker (SimRobot::steady_speed)
+        float left = (pctL[i] < 0) ? std::min(pctL[i] + loss[i], 0.0f) : pctL[i];
+        float right = (pctR[i] < 0) ? std::min(pctR[i] + loss[i], 0.0f) : pctR[i];
+
+        // First order response of each wheel to its motor
+        vL[i] += (left * inchesPerSecPerPercent - vL[i]) * blend;
+        vR[i] += (right * inchesPerSecPerPercent - vR[i]) * blend;
+
+        // Encoders count both directions the same way
+        cL[i] += fabsf(vL[i]) * dt * cpi[i];
+        cR[i] += fabsf(vR[i]) * dt * cpi[i];
+
+        // Differential drive, heading vector rotated by a small angle (second order) then renormalized
+        float speed = (vL[i] + vR[i]) * 0.5f;
+        float angle = (vR[i] - vL[i]) / width[i] * dt;
+        float c = hc[i], s = hs[i];
+        float half = 0.5f * angle * angle;
+        float nc = c - s * angle - c * half;
+        float ns = s + c * angle - s * half;
+        float norm = 1.5f - 0.5f * (nc * nc + ns * ns);
+        float dx = speed * c * dt;
+        float dy = speed * s * dt;
+
+        // Same rule as CourseModel::blocked(), the wheels slip and the robot stays put
+        if (collide) {
+            float before = clearance_lookup(grid, gridWidth, gridLength, px[i], py[i]);
+            float after = clearance_lookup(grid, gridWidth, gridLength, px[i] + dx, py[i] + dy);
+            float moving = ((after < COURSE_ROBOT_RADIUS) & (after < before)) ? 0.0f : 1.0f;
+            dx *= moving;
+            dy *= moving;
+            stalled[i] += (1 - moving) * dt;
+        }
+
+        px[i] += dx;
+        py[i] += dy;
+        hc[i] = nc * norm;
+        hs[i] = ns * norm;
+
+        // Same stop check as the course code, on whole encoder counts
+        float average = ((float)(int)cL[i] + (float)(int)cR[i]) * 0.5f;
+        unsigned char over = (average >= target[i]) | (now + dt >= endAt[i] - 0.5f * dt);
+        stop[i] = over;
+        stopped += over;
+    }
+
+    return stopped;
+}
+
+/************************************************/
+// Scalar reference
+
+void batch_run_scalar(const BatchProgram &program, const SimParams &params, SimRobot &robot, float timeout) {
+    robot.params = params;
+    robot.place(SIM_START_X, SIM_START_Y, SIM_START_HEADING);
+    robot.time = 0;
+
+    long steps = 0;
+    for (size_t op = 0; (op < program.size()) && (robot.time < timeout); op++) {
+        const BatchOp &move = program[op];
+        robot.encoderCounts[0] = 0;
+        robot.encoderCounts[1] = 0;
+        robot.motorPercent[0] = move.leftPercent;
+        robot.motorPercent[1] = move.rightPercent;
+        double endTime = (move.seconds >= BATCH_NEVER) ? BATCH_NEVER : steps * BATCH_STEP + move.seconds;
+
+        while (robot.time < timeout) {
+            robot.advance(BATCH_STEP);
+            steps++;
+            double average = ((int)robot.encoderCounts[0] + (int)robot.encoderCounts[1]) / 2.;
+            if ((average >= move.targetCounts) || (steps * BATCH_STEP >= endTime - 0.5 * BATCH_STEP)) {
+                break;
+            }
+        }
+    }
+
+    robot.motorPercent[0] = 0;
+    robot.motorPercent[1] = 0;
+}
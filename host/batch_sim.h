@@ -0,0 +1,146 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*        Batch robot simulator (host)       */
+/*                                           */
+/*  Steps thousands of copies of the         */
+/*  SimRobot model at once for Monte Carlo   */
+/*  runs. State is kept as one array per     */
+/*  field (structure of arrays) so the step  */
+/*  loop vectorizes, and every robot gets    */
+/*  its own perturbed parameters.            */
+/*                                           */
+/*  The course code can't run thousands of   */
+/*  times in lock step, so robots run a      */
+/*  BatchProgram: the same open loop moves   */
+/*  main.cpp makes (encoder count stops and  */
+/*  timed drives), built with the batch_*    */
+/*  helpers below.                           */
+/*                                           */
+/*  With a course set, robots stop against   */
+/*  its static solids (walls, jukebox, sink, */
+/*  final button) using the clearance grid.  */
+/*  The ramp and hot plate are left out.     */
+/*********************************************/
+
+#ifndef BATCH_SIM_H
+#define BATCH_SIM_H
+
+#include "course_model.h"
+#include "sim_robot.h"
+
+#include <vector>
+
+/************************************************/
+// Definitions
+#define BATCH_STEP 0.001f // Seconds per step, same as SIM_MAX_STEP
+#define BATCH_NEVER 1e30f // Target/end time for "no limit"
+#define BATCH_BLOCK 1024 // Robots stepped together, small enough that their state stays in cache
+
+/*******************************************************
+ * @brief One move in a batch program. The robot drives at the given motor
+ * percents until the average encoder count reaches targetCounts or seconds
+ * pass, then both motors stop. Encoders are reset at the start.
+ */
+struct BatchOp {
+    float leftPercent;
+    float rightPercent;
+    float targetCounts; // BATCH_NEVER for timed moves
+    float seconds; // BATCH_NEVER for count moves
+};
+
+typedef std::vector<BatchOp> BatchProgram;
+
+// Same moves as the functions in main.cpp, using the constants there
+void batch_forward_inches(BatchProgram &program, int percent, float inches); // move_forward_inches()
+void batch_forward_seconds(BatchProgram &program, float percent, float seconds); // move_forward_seconds()
+void batch_turn_right(BatchProgram &program, int percent, float degrees); // turn_right_degrees()
+void batch_turn_left(BatchProgram &program, int percent, float degrees); // turn_left_degrees()
+void batch_sleep(BatchProgram &program, float seconds); // Sleep() with the motors off
+
+/*******************************************************
+ * @brief Relative (or absolute for backwardsLoss) standard deviations used
+ * to perturb each robot's parameters around the base SimParams
+ */
+struct BatchSpread {
+    double countsPerInch = 0.02; // Fraction, wheel diameter and encoder slip
+    double trackWidth = 0.02; // Fraction, tire contact width
+    double backwardsLoss = 0.5; // Percent
+};
+
+/*******************************************************
+ * @brief N robots stepped together
+ */
+class BatchSim {
+public:
+    /*******************************************************
+     * @brief Makes count robots at the SimRobot start pose
+     *
+     * @param base Parameters every robot starts from
+     * @param spread Standard deviations of the per robot perturbation
+     * @param seed Random seed, same seed gives the same robots
+     */
+    BatchSim(int count, const SimParams &base, const BatchSpread &spread, unsigned seed);
+
+    int count;
+    SimParams base;
+    const CourseModel *course; // Course to collide with, 0 (the default) for open floor
+    float time; // Virtual seconds the slowest block took in the last run
+    double robotSteps; // Steps taken by all robots in the last run
+
+    // Per robot parameters
+    std::vector<float> countsPerInch, trackWidth, backwardsLoss;
+
+    // Per robot state
+    std::vector<float> x, y, headingCos, headingSin; // Heading kept as a unit vector so no trig is needed per step
+    std::vector<float> speedLeft, speedRight; // Inches per second
+    std::vector<float> countsLeft, countsRight; // Since the start of the current move
+    std::vector<float> percentLeft, percentRight; // Motor command
+
+    // Per robot program position
+    std::vector<float> targetCounts, endTime; // Stop conditions of the current move
+    std::vector<int> opIndex; // Index into the program, program size when finished
+    std::vector<unsigned char> done; // Set by step() when the current move is over
+    std::vector<float> stalledTime; // Seconds spent pushing against the course
+
+    /*******************************************************
+     * @brief Runs a program on every robot until all of them finish it.
+     * Robots that finish early coast until the rest of their block is done.
+     *
+     * @param timeout Virtual seconds before giving up
+     * @return int Number of robots that finished
+     */
+    int run(const BatchProgram &program, float timeout);
+
+    /*******************************************************
+     * @brief Heading of one robot in degrees CCW from east
+     */
+    float heading(int robot) const;
+
+    /*******************************************************
+     * @brief Moves robots [begin, end) one BATCH_STEP forward. This is the hot loop.
+     *
+     * @param now Virtual time at the start of the step
+     * @return int Number of robots whose move finished during the step
+     */
+    int step(int begin, int end, float now);
+
+private:
+    const BatchProgram *program;
+
+    void start_op(int robot, float now);
+
+    // step() body, with the course lookups compiled in or out so the open floor loop stays as fast as before
+    template <bool collide> int step_robots(int begin, int end, float now);
+};
+
+/*******************************************************
+ * @brief Runs the same program one robot at a time on SimRobot, checking
+ * stop conditions every BATCH_STEP. Used to check the batch results and
+ * as the throughput baseline.
+ *
+ * @param params Parameters of this robot
+ * @param robot Robot to run, left where the program ends
+ */
+void batch_run_scalar(const BatchProgram &program, const SimParams &params, SimRobot &robot, float timeout);
+
+#endif
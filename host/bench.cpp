@@ -0,0 +1,392 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*       Control loop benchmark (host)       */
+/*                                           */
+/*  Runs each motion primitive from main.cpp */
+/*  against the simulated robot and times    */
+/*  every loop iteration on this computer.   */
+/*                                           */
+/*  Usage:                                   */
+/*    ./bench [-n runs] [-l label] [-o file] */
+/*    ./bench --compare old.json new.json    */
+/*                                           */
+/*  Output is one JSON object per primitive  */
+/*  per line, keys always in the same order. */
+/*  Drawing is counted by the LCD emulator   */
+/*  (lcd_frame.h) per iteration and per      */
+/*  second of robot time.                    */
+/*********************************************/
+
+#include "lcd_frame.h"
+#include "sim_robot.h"
+#include "../units.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/************************************************/
+// Course code from main.cpp (line is the call site for the cost report)
+void move_forward_inches(Percent percent, Inches inches, int line = __builtin_LINE());
+void turn_right_degrees(Percent percent, Degrees degrees, int line = __builtin_LINE());
+void turn_left_degrees(Percent percent, Degrees degrees, int line = __builtin_LINE());
+void move_forward_PID(InchesPerSecond speed, Inches inches, int line = __builtin_LINE());
+void RPS_correct_heading(float heading, double secondsToCheck, int line = __builtin_LINE());
+void RPS_check_x(float x_coord, double secondsToCheck, int line = __builtin_LINE());
+void RPS_check_y(float y_coord, double secondsToCheck, int line = __builtin_LINE());
+int detect_color(int timeToDetect, int line = __builtin_LINE());
+
+/************************************************/
+// Definitions
+#define BENCH_DEFAULT_RUNS 5
+
+// Sleeps that end one loop iteration. Same values as in main.cpp.
+#define BENCH_SLEEP_PID 0.15 // SLEEP_PID
+#define BENCH_RPS_DELAY_TIME 0.35 // RPS_DELAY_TIME
+#define BENCH_COLOR_SLEEP 0.1 // Sleep at the end of the detect_color() loop
+
+#define BENCH_COLOR_READS 20 // detect_color() sees the light on its first read, so it runs this many times
+
+typedef std::chrono::steady_clock BenchClock;
+
+/*******************************************************
+ * @brief Simulated robot that marks the end of each loop iteration. An iteration ends
+ * on a read of the left encoder (busy loops) or on a specific Sleep (timed loops).
+ * Time inside Sleep() is left out, on the robot nothing runs then.
+ */
+class BenchRobot : public SimRobot {
+public:
+    int markerPin = -1; // Encoder pin that ends an iteration, -1 for none
+    double markerSleep = -1; // Sleep length that ends an iteration, -1 for none
+
+    std::vector<double> latencies; // Host seconds for each iteration
+    double shares[HOST_CALL_KINDS + 1]; // Host seconds in each call kind, last entry is math (sleep stays 0)
+
+    void start() {
+        haveLast = false;
+        latencies.clear();
+        for (int i = 0; i <= HOST_CALL_KINDS; i++) {
+            shares[i] = 0;
+        }
+    }
+
+    int EncoderCounts(int pin) override {
+        // Busy loops only count while the motors are running, which skips the reads for the printout after the loop
+        if ((pin == markerPin) && ((motorPercent[0] != 0) || (motorPercent[1] != 0))) {
+            mark();
+        }
+        return SimRobot::EncoderCounts(pin);
+    }
+
+    void Sleep(double seconds) override {
+        if ((markerSleep > 0) && (fabs(seconds - markerSleep) < 1e-6)) {
+            mark();
+        }
+        SimRobot::Sleep(seconds);
+    }
+
+private:
+    bool haveLast;
+    BenchClock::time_point last;
+    double lastSeconds[HOST_CALL_KINDS];
+
+    void mark() {
+        BenchClock::time_point now = BenchClock::now();
+
+        if (haveLast) {
+            double total = std::chrono::duration<double>(now - last).count();
+            double inCalls = 0;
+
+            for (int i = 0; i < HOST_CALL_KINDS; i++) {
+                double spent = hostCallProfile.seconds[i] - lastSeconds[i];
+                if (i == HOST_CALL_SLEEP) {
+                    total -= spent;
+                } else {
+                    shares[i] += spent;
+                    inCalls += spent;
+                }
+            }
+
+            total = std::max(0.0, total);
+            shares[HOST_CALL_KINDS] += std::max(0.0, total - inCalls);
+            latencies.push_back(total);
+        }
+
+        for (int i = 0; i < HOST_CALL_KINDS; i++) {
+            lastSeconds[i] = hostCallProfile.seconds[i];
+        }
+        last = now;
+        haveLast = true;
+    }
+};
+
+/************************************************/
+// Benchmarks
+
+struct BenchCase {
+    const char *name;
+    void (*setup)(BenchRobot &robot);
+    void (*run)();
+};
+
+static void setup_drive(BenchRobot &robot) {
+    robot.place(20, 20, 90);
+    robot.markerPin = SIM_LEFT_ENCODER_PIN;
+}
+
+static void setup_PID(BenchRobot &robot) {
+    robot.place(20, 20, 90);
+    robot.markerSleep = BENCH_SLEEP_PID;
+}
+
+static void setup_heading(BenchRobot &robot) {
+    robot.place(20, 30, 80);
+    robot.markerSleep = BENCH_RPS_DELAY_TIME;
+}
+
+static void setup_x(BenchRobot &robot) {
+    robot.place(20, 30, 2);
+    robot.markerSleep = BENCH_RPS_DELAY_TIME;
+}
+
+static void setup_y(BenchRobot &robot) {
+    robot.place(20, 30, 88);
+    robot.markerSleep = BENCH_RPS_DELAY_TIME;
+}
+
+static void setup_color(BenchRobot &robot) {
+    robot.place(20, 20, 90);
+    robot.markerSleep = BENCH_COLOR_SLEEP;
+}
+
+static void run_forward() { move_forward_inches(45_pct, 12_in); } // FORWARD_SPEED
+static void run_turn_right() { turn_right_degrees(30_pct, 90_deg); } // TURN_SPEED
+static void run_turn_left() { turn_left_degrees(30_pct, 90_deg); }
+static void run_PID() { move_forward_PID(5_ips, 12_in); }
+static void run_heading() { RPS_correct_heading(90, 10); }
+static void run_x() { RPS_check_x(22, 10); }
+static void run_y() { RPS_check_y(32, 10); }
+
+static void run_color() {
+    for (int i = 0; i < BENCH_COLOR_READS; i++) {
+        detect_color(4);
+    }
+}
+
+static const BenchCase benchCases[] = {
+    { "move_forward_inches", setup_drive, run_forward },
+    { "turn_right_degrees", setup_drive, run_turn_right },
+    { "turn_left_degrees", setup_drive, run_turn_left },
+    { "move_forward_PID", setup_PID, run_PID },
+    { "RPS_correct_heading", setup_heading, run_heading },
+    { "RPS_check_x", setup_x, run_x },
+    { "RPS_check_y", setup_y, run_y },
+    { "detect_color", setup_color, run_color },
+};
+
+/*******************************************************
+ * @brief Value at a percentile of sorted samples
+ */
+static double percentile(const std::vector<double> &sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = (size_t)(fraction * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+/*******************************************************
+ * @brief Runs one benchmark and writes its JSON line
+ */
+static void run_case(const BenchCase &benchCase, int runs, const char *label, FILE *out) {
+    std::vector<double> latencies;
+    double shares[HOST_CALL_KINDS + 1] = { 0 };
+    double simSeconds = 0;
+    unsigned long long lcdCalls = 0, lcdPixels = 0;
+
+    for (int run = 0; run < runs; run++) {
+        BenchRobot robot;
+        host_set_hardware(&robot);
+        benchCase.setup(robot);
+
+        lcd_reset();
+        lcd_reset_stats();
+        memset(&hostCallProfile, 0, sizeof(hostCallProfile));
+        hostCallProfile.enabled = true;
+        robot.start();
+
+        double simStart = robot.time;
+        benchCase.run();
+        simSeconds += robot.time - simStart;
+
+        hostCallProfile.enabled = false;
+        host_set_hardware(0);
+        lcdCalls += lcd_total_calls();
+        lcdPixels += lcd_total_pixels();
+
+        latencies.insert(latencies.end(), robot.latencies.begin(), robot.latencies.end());
+        for (int i = 0; i <= HOST_CALL_KINDS; i++) {
+            shares[i] += robot.shares[i];
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    double total = 0;
+    for (size_t i = 0; i < latencies.size(); i++) {
+        total += latencies[i];
+    }
+    double mean = latencies.empty() ? 0 : total / latencies.size();
+
+    double variance = 0;
+    for (size_t i = 0; i < latencies.size(); i++) {
+        variance += (latencies[i] - mean) * (latencies[i] - mean);
+    }
+    double stddev = latencies.empty() ? 0 : sqrt(variance / latencies.size());
+
+    double shareTotal = 0;
+    for (int i = 0; i <= HOST_CALL_KINDS; i++) {
+        shareTotal += shares[i];
+    }
+    if (shareTotal <= 0) {
+        shareTotal = 1;
+    }
+
+    double iterations = latencies.empty() ? 1 : latencies.size();
+
+    fprintf(out, "{\"primitive\":\"%s\",\"label\":\"%s\",\"runs\":%d,\"iterations\":%zu,"
+                 "\"iterations_per_sec\":%.1f,"
+                 "\"latency_mean_ns\":%.1f,\"latency_p50_ns\":%.1f,\"latency_p90_ns\":%.1f,"
+                 "\"latency_p99_ns\":%.1f,\"latency_max_ns\":%.1f,\"jitter_stddev_ns\":%.1f,"
+                 "\"share_sensor\":%.4f,\"share_math\":%.4f,\"share_lcd\":%.4f,\"share_output\":%.4f,"
+                 "\"sim_seconds_per_run\":%.4f,"
+                 "\"lcd_calls_per_iteration\":%.1f,\"lcd_pixels_per_iteration\":%.1f,"
+                 "\"lcd_calls_per_sim_sec\":%.1f,\"lcd_pixels_per_sim_sec\":%.1f}\n",
+            benchCase.name, label, runs, latencies.size(),
+            (total > 0) ? latencies.size() / total : 0.0,
+            mean * 1e9, percentile(latencies, 0.5) * 1e9, percentile(latencies, 0.9) * 1e9,
+            percentile(latencies, 0.99) * 1e9, latencies.empty() ? 0.0 : latencies.back() * 1e9, stddev * 1e9,
+            shares[HOST_CALL_SENSOR] / shareTotal, shares[HOST_CALL_KINDS] / shareTotal,
+            shares[HOST_CALL_LCD] / shareTotal, shares[HOST_CALL_OUTPUT] / shareTotal,
+            simSeconds / runs,
+            lcdCalls / iterations, lcdPixels / iterations,
+            (simSeconds > 0) ? lcdCalls / simSeconds : 0.0, (simSeconds > 0) ? lcdPixels / simSeconds : 0.0);
+}
+
+/************************************************/
+// Comparing two result files
+
+/*******************************************************
+ * @brief Finds "key":value in a JSON line
+ *
+ * @return bool true if the key was found
+ */
+static bool json_number(const char *line, const char *key, double &value) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *at = strstr(line, pattern);
+    return at && (sscanf(at + strlen(pattern), "%lf", &value) == 1);
+}
+
+static bool json_string(const char *line, const char *key, std::string &value) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":\"", key);
+    const char *at = strstr(line, pattern);
+    if (!at) {
+        return false;
+    }
+    at += strlen(pattern);
+    const char *end = strchr(at, '"');
+    value.assign(at, end ? end - at : strlen(at));
+    return true;
+}
+
+static std::vector<std::string> read_lines(const char *path) {
+    std::vector<std::string> lines;
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "%s: can't open file\n", path);
+        exit(2);
+    }
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+        lines.push_back(line);
+    }
+    fclose(file);
+    return lines;
+}
+
+/*******************************************************
+ * @brief Prints the change in the main numbers of every primitive in both files
+ */
+static int compare(const char *oldPath, const char *newPath) {
+    std::vector<std::string> oldLines = read_lines(oldPath);
+    std::vector<std::string> newLines = read_lines(newPath);
+    const char *keys[] = { "iterations_per_sec", "latency_p50_ns", "latency_p99_ns", "jitter_stddev_ns",
+                           "lcd_pixels_per_sim_sec" };
+
+    printf("%-22s %-20s %14s %14s %9s\n", "primitive", "metric", "old", "new", "change");
+    for (size_t i = 0; i < newLines.size(); i++) {
+        std::string name, oldName;
+        if (!json_string(newLines[i].c_str(), "primitive", name)) {
+            continue;
+        }
+
+        for (size_t j = 0; j < oldLines.size(); j++) {
+            if (!json_string(oldLines[j].c_str(), "primitive", oldName) || (oldName != name)) {
+                continue;
+            }
+
+            for (size_t k = 0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+                double oldValue, newValue;
+                if (json_number(oldLines[j].c_str(), keys[k], oldValue) && json_number(newLines[i].c_str(), keys[k], newValue)) {
+                    double change = (oldValue != 0) ? 100 * (newValue - oldValue) / oldValue : 0;
+                    printf("%-22s %-20s %14.1f %14.1f %+8.1f%%\n", name.c_str(), keys[k], oldValue, newValue, change);
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int runs = BENCH_DEFAULT_RUNS;
+    const char *label = "";
+    const char *outPath = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--compare") && (i + 2 < argc)) {
+            return compare(argv[i + 1], argv[i + 2]);
+        } else if (!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+            runs = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-l") && (i + 1 < argc)) {
+            label = argv[++i];
+        } else if (!strcmp(argv[i], "-o") && (i + 1 < argc)) {
+            outPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [-n runs] [-l label] [-o file]\n       %s --compare old.json new.json\n", argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    FILE *out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "%s: can't open file\n", outPath);
+        return 2;
+    }
+
+    for (size_t i = 0; i < sizeof(benchCases) / sizeof(benchCases[0]); i++) {
+        run_case(benchCases[i], (runs > 0) ? runs : 1, label, out);
+    }
+
+    if (outPath) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,216 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*       Control math accuracy (host)        */
+/*                                           */
+/*  Runs the PID math from control_math.h    */
+/*  on double, float and 16.16 fixed point   */
+/*  and compares the last two against        */
+/*  double:                                  */
+/*   - same encoder/time inputs, motor       */
+/*     percent each step                     */
+/*   - closed loop on the simulated robot,   */
+/*     where the move ends                   */
+/*   - host nanoseconds per PID step         */
+/*                                           */
+/*  Usage: ./control_accuracy [-i inches]    */
+/*********************************************/
+
+#include "../control_math.h"
+#include "sim_robot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/************************************************/
+// Definitions (same values as main.cpp)
+#define ACCURACY_P 0.75 // PConstR/PConstL
+#define ACCURACY_I 0.05 // IConstR/IConstL
+#define ACCURACY_D 0.25 // DConstR/DConstL
+#define ACCURACY_SLEEP_PID 0.15 // SLEEP_PID
+#define ACCURACY_INCH_PER_COUNT ((2 * 3.14159265 * 1.25) / 318) // INCH_PER_COUNT
+
+#define ACCURACY_DEFAULT_INCHES 24
+#define ACCURACY_TIMING_PASSES 20000 // Replays of the inputs when timing a PID step
+
+// Speeds tried, inches per second
+static const float accuracySpeeds[] = { 3, 5, 8 };
+
+/************************************************/
+// move_forward_PID() against the simulated robot
+
+// Inputs of one step of the loop
+struct PidSample {
+    int countsRight, countsLeft;
+    double timeRight, timeLeft;
+};
+
+struct PidRun {
+    std::vector<PidSample> samples;
+    std::vector<float> powers; // Right then left for every step
+    double startTime; // TimeNow() the PID was reset at, as ResetPIDVariables() does
+    double seconds;
+    double x, y, heading;
+};
+
+/*******************************************************
+ * @brief Same loop as move_forward_PID() in main.cpp, with the math on T
+ */
+template <typename T>
+static PidRun run_closed_loop(float speed, float inches) {
+    PidRun run;
+    SimRobot robot;
+    robot.place(20, 10, 90);
+
+    PIDWheel<T> right(ACCURACY_P, ACCURACY_I, ACCURACY_D);
+    PIDWheel<T> left(ACCURACY_P, ACCURACY_I, ACCURACY_D);
+    T distancePerCount = (T)ACCURACY_INCH_PER_COUNT;
+    float oldRight = 0, oldLeft = 0;
+
+    run.startTime = robot.TimeNow();
+    pid_reset(right, run.startTime);
+    pid_reset(left, run.startTime);
+    robot.EncoderReset(SIM_LEFT_ENCODER_PIN);
+    robot.EncoderReset(SIM_RIGHT_ENCODER_PIN);
+    robot.Sleep(ACCURACY_SLEEP_PID);
+    double start = robot.time;
+
+    while (((robot.EncoderCounts(SIM_LEFT_ENCODER_PIN) + robot.EncoderCounts(SIM_RIGHT_ENCODER_PIN)) / 2) * distancePerCount < (T)inches) {
+        PidSample sample;
+        sample.countsRight = robot.EncoderCounts(SIM_RIGHT_ENCODER_PIN);
+        sample.timeRight = robot.TimeNow();
+        float newRight = pid_adjust(right, distancePerCount, sample.countsRight, sample.timeRight, (T)speed, oldRight);
+        sample.countsLeft = robot.EncoderCounts(SIM_LEFT_ENCODER_PIN);
+        sample.timeLeft = robot.TimeNow();
+        float newLeft = pid_adjust(left, distancePerCount, sample.countsLeft, sample.timeLeft, (T)speed, oldLeft);
+
+        robot.MotorPercent(SIM_RIGHT_MOTOR_PORT, newRight);
+        robot.MotorPercent(SIM_LEFT_MOTOR_PORT, newLeft);
+        oldRight = newRight;
+        oldLeft = newLeft;
+
+        run.samples.push_back(sample);
+        run.powers.push_back(newRight);
+        run.powers.push_back(newLeft);
+        robot.Sleep(ACCURACY_SLEEP_PID);
+    }
+
+    robot.MotorStop(SIM_RIGHT_MOTOR_PORT);
+    robot.MotorStop(SIM_LEFT_MOTOR_PORT);
+
+    run.seconds = robot.time - start;
+    run.x = robot.x;
+    run.y = robot.y;
+    run.heading = robot.heading;
+    return run;
+}
+
+/*******************************************************
+ * @brief Feeds recorded inputs through the PID math on T
+ *
+ * @return std::vector<float> Motor percents, right then left for every step
+ */
+template <typename T>
+static std::vector<float> replay(const PidRun &run, float speed) {
+    const std::vector<PidSample> &samples = run.samples;
+    std::vector<float> powers;
+    PIDWheel<T> right(ACCURACY_P, ACCURACY_I, ACCURACY_D);
+    PIDWheel<T> left(ACCURACY_P, ACCURACY_I, ACCURACY_D);
+    T distancePerCount = (T)ACCURACY_INCH_PER_COUNT;
+    float oldRight = 0, oldLeft = 0;
+
+    pid_reset(right, run.startTime);
+    pid_reset(left, run.startTime);
+
+    for (size_t i = 0; i < samples.size(); i++) {
+        oldRight = pid_adjust(right, distancePerCount, samples[i].countsRight, samples[i].timeRight, (T)speed, oldRight);
+        oldLeft = pid_adjust(left, distancePerCount, samples[i].countsLeft, samples[i].timeLeft, (T)speed, oldLeft);
+        powers.push_back(oldRight);
+        powers.push_back(oldLeft);
+    }
+    return powers;
+}
+
+/*******************************************************
+ * @brief Host nanoseconds per PID step on T, replaying the inputs many times
+ */
+template <typename T>
+static double step_nanoseconds(const PidRun &run, float speed) {
+    const std::vector<PidSample> &samples = run.samples;
+    PIDWheel<T> wheel(ACCURACY_P, ACCURACY_I, ACCURACY_D);
+    T distancePerCount = (T)ACCURACY_INCH_PER_COUNT;
+    volatile float sink = 0; // Keeps the compiler from dropping the work
+    float power = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < ACCURACY_TIMING_PASSES; pass++) {
+        pid_reset(wheel, run.startTime);
+        for (size_t i = 0; i < samples.size(); i++) {
+            power = pid_adjust(wheel, distancePerCount, samples[i].countsRight, samples[i].timeRight, (T)speed, power);
+        }
+        sink = power;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    (void)sink;
+    return seconds * 1e9 / ((double)ACCURACY_TIMING_PASSES * samples.size());
+}
+
+/*******************************************************
+ * @brief Largest and RMS difference between two runs of motor percents
+ */
+static void compare_powers(const std::vector<float> &reference, const std::vector<float> &other, double &largest, double &rms) {
+    largest = 0;
+    rms = 0;
+    size_t count = std::min(reference.size(), other.size());
+    for (size_t i = 0; i < count; i++) {
+        double difference = fabs(reference[i] - other[i]);
+        largest = std::max(largest, difference);
+        rms += difference * difference;
+    }
+    rms = count ? sqrt(rms / count) : 0;
+}
+
+template <typename T>
+static void print_type(const char *name, const PidRun &reference, float speed, float inches) {
+    double largest, rms;
+    compare_powers(reference.powers, replay<T>(reference, speed), largest, rms);
+
+    PidRun run = run_closed_loop<T>(speed, inches);
+    double endError = hypot(run.x - reference.x, run.y - reference.y);
+
+    printf("%-8s %12.5f %12.5f %12.4f %10.3f %12.1f\n", name, largest, rms, endError, run.seconds - reference.seconds,
+           step_nanoseconds<T>(reference, speed));
+}
+
+int main(int argc, char *argv[]) {
+    float inches = ACCURACY_DEFAULT_INCHES;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-i") && (i + 1 < argc)) {
+            inches = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-i inches]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (size_t s = 0; s < sizeof(accuracySpeeds) / sizeof(accuracySpeeds[0]); s++) {
+        float speed = accuracySpeeds[s];
+        PidRun reference = run_closed_loop<double>(speed, inches);
+
+        printf("move_forward_PID(%.0f, %.0f): %zu steps, %.2f s\n", speed, inches, reference.samples.size(), reference.seconds);
+        printf("%-8s %12s %12s %12s %10s %12s\n", "type", "max diff %", "rms diff %", "end diff in", "time diff", "ns per step");
+        print_type<double>("double", reference, speed, inches);
+        print_type<float>("float", reference, speed, inches);
+        print_type<Fixed>("fixed", reference, speed, inches);
+        printf("\n");
+    }
+
+    printf("Host timings only show relative cost. On the Proteus, double math is done in software\n"
+           "while float runs on the FPU and fixed point on the integer unit.\n");
+    return 0;
+}
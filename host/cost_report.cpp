@@ -0,0 +1,250 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*           Run cost report tool            */
+/*                                           */
+/*  Reads costs.txt (timeline_write_costs()) */
+/*  and prints where the run's time went:    */
+/*  by category, by stage, and the call      */
+/*  sites in main.cpp that cost the most     */
+/*  time that isn't spent moving.            */
+/*                                           */
+/*  Usage: ./cost_report costs.txt [-n sites]*/
+/*             [-s ../main.cpp]              */
+/*********************************************/
+
+#include "../timeline_format.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+/************************************************/
+// Definitions
+#define REPORT_DEFAULT_SITES 15
+#define REPORT_DEFAULT_SOURCE "../main.cpp"
+
+// Column names, indexed by TimelineCost
+static const char *costNames[COST_COUNT] = { "other", "motion", "rps", "sleep", "servo", "sensor", "lcd" };
+
+/************************************************/
+// One C line of the cost file
+struct ReportEntry {
+    int stage;
+    int cost;
+    int line;
+    double seconds;
+};
+
+// Loaded cost file
+struct ReportCosts {
+    std::vector<std::string> stages;
+    std::vector<ReportEntry> entries;
+    bool overflowed = false;
+};
+
+// Everything charged to one call site line
+struct ReportSite {
+    int line = 0;
+    int stage = 0;
+    double seconds[COST_COUNT] = {};
+
+    double total() const {
+        double sum = 0;
+        for (int i = 0; i < COST_COUNT; i++) {
+            sum += seconds[i];
+        }
+        return sum;
+    }
+};
+
+/*******************************************************
+ * @brief Reads a cost file
+ *
+ * @return bool true if the file could be read
+ */
+static bool load_costs(const char *path, ReportCosts &costs) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "%s: can't open file\n", path);
+        return false;
+    }
+
+    char line[256];
+    int version = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        int stage, cost, siteLine, count, overflowed;
+        unsigned long micros;
+        char name[160];
+
+        if (sscanf(line, "COSTS %d", &version) == 1) {
+            continue;
+        } else if (sscanf(line, "STAGE %d %159[^\n]", &stage, name) == 2) {
+            if ((int)costs.stages.size() <= stage) {
+                costs.stages.resize(stage + 1);
+            }
+            costs.stages[stage] = name;
+        } else if (sscanf(line, "C %d %d %d %lu", &stage, &cost, &siteLine, &micros) == 4) {
+            if ((cost < 0) || (cost >= COST_COUNT)) {
+                continue;
+            }
+            ReportEntry entry = { stage, cost, siteLine, micros / 1e6 };
+            costs.entries.push_back(entry);
+        } else if (sscanf(line, "END %d %d", &count, &overflowed) == 2) {
+            costs.overflowed = overflowed;
+        }
+    }
+
+    fclose(file);
+
+    if (version != TIMELINE_VERSION) {
+        fprintf(stderr, "%s: not a version %d cost file\n", path, TIMELINE_VERSION);
+        return false;
+    }
+    return true;
+}
+
+/*******************************************************
+ * @brief Reads every line of the course source so call sites can be shown
+ */
+static std::vector<std::string> load_source(const char *path) {
+    std::vector<std::string> lines(1); // Lines start at 1
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return lines;
+    }
+
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        char *text = line;
+        while ((*text == ' ') || (*text == '\t')) {
+            text++;
+        }
+        text[strcspn(text, "\r\n")] = 0;
+        lines.push_back(text);
+    }
+
+    fclose(file);
+    return lines;
+}
+
+/*******************************************************
+ * @brief Prints one row of seconds per category
+ */
+static void print_row(const char *label, const double seconds[COST_COUNT]) {
+    double total = 0;
+    printf("%-20.20s", label);
+    for (int i = 0; i < COST_COUNT; i++) {
+        printf(" %7.2f", seconds[i]);
+        total += seconds[i];
+    }
+    printf(" %8.2f\n", total);
+}
+
+static void print_header(const char *label) {
+    printf("%-20s", label);
+    for (int i = 0; i < COST_COUNT; i++) {
+        printf(" %7s", costNames[i]);
+    }
+    printf(" %8s\n", "total");
+}
+
+int main(int argc, char *argv[]) {
+    const char *costPath = 0;
+    const char *sourcePath = REPORT_DEFAULT_SOURCE;
+    int siteCount = REPORT_DEFAULT_SITES;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+            siteCount = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-s") && (i + 1 < argc)) {
+            sourcePath = argv[++i];
+        } else if (!costPath && (argv[i][0] != '-')) {
+            costPath = argv[i];
+        } else {
+            costPath = 0;
+            break;
+        }
+    }
+
+    if (!costPath) {
+        fprintf(stderr, "usage: %s costs.txt [-n sites] [-s ../main.cpp]\n", argv[0]);
+        return 2;
+    }
+
+    ReportCosts costs;
+    if (!load_costs(costPath, costs)) {
+        return 2;
+    }
+    std::vector<std::string> source = load_source(sourcePath);
+
+    // Totals per category and per stage
+    double totals[COST_COUNT] = {};
+    std::vector<std::vector<double> > stageSeconds(costs.stages.size(), std::vector<double>(COST_COUNT, 0));
+    std::map<std::pair<int, int>, ReportSite> sites;
+
+    for (size_t i = 0; i < costs.entries.size(); i++) {
+        const ReportEntry &entry = costs.entries[i];
+        totals[entry.cost] += entry.seconds;
+        if ((entry.stage >= 0) && (entry.stage < (int)stageSeconds.size())) {
+            stageSeconds[entry.stage][entry.cost] += entry.seconds;
+        }
+
+        ReportSite &site = sites[std::make_pair(entry.line, entry.stage)];
+        site.line = entry.line;
+        site.stage = entry.stage;
+        site.seconds[entry.cost] += entry.seconds;
+    }
+
+    double runTime = 0;
+    for (int i = 0; i < COST_COUNT; i++) {
+        runTime += totals[i];
+    }
+    if (runTime <= 0) {
+        fprintf(stderr, "%s: no time recorded\n", costPath);
+        return 2;
+    }
+
+    printf("Run time %.2f s%s\n\n", runTime, costs.overflowed ? " (site table overflowed, some time is missing)" : "");
+
+    printf("%-16s %8s %6s\n", "Category", "seconds", "share");
+    for (int i = 0; i < COST_COUNT; i++) {
+        printf("%-16s %8.2f %5.1f%%\n", costNames[i], totals[i], 100 * totals[i] / runTime);
+    }
+
+    printf("\n");
+    print_header("Stage");
+    for (size_t stage = 0; stage < costs.stages.size(); stage++) {
+        print_row(costs.stages[stage].c_str(), stageSeconds[stage].data());
+    }
+
+    // Call sites ranked by time not spent moving, since that is what can be cut without driving faster
+    std::vector<ReportSite> ranked;
+    for (std::map<std::pair<int, int>, ReportSite>::iterator it = sites.begin(); it != sites.end(); ++it) {
+        if (it->second.line) {
+            ranked.push_back(it->second);
+        }
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const ReportSite &a, const ReportSite &b) {
+        return (a.total() - a.seconds[COST_MOTION]) > (b.total() - b.seconds[COST_MOTION]);
+    });
+
+    printf("\nCall sites with the most time not spent moving\n");
+    print_header("Line and stage");
+    for (int i = 0; (i < siteCount) && (i < (int)ranked.size()); i++) {
+        const ReportSite &site = ranked[i];
+        char label[64];
+        const char *stageName = ((site.stage >= 0) && (site.stage < (int)costs.stages.size())) ? costs.stages[site.stage].c_str() : "?";
+        snprintf(label, sizeof(label), "%d %s", site.line, stageName);
+        print_row(label, site.seconds);
+        if ((site.line > 0) && (site.line < (int)source.size())) {
+            printf("    %s\n", source[site.line].c_str());
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,203 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*     Course geometry model (host, impl)    */
+/*********************************************/
+
+#include "course_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#define COURSE_PI 3.14159265358979
+#define COURSE_CONTACT 0.1f // Extra distance that still counts as touching
+#define COURSE_TRAY_DROP 1.0f // Gap between the robot and the sink the tray still falls into
+
+/*******************************************************
+ * @brief Distance from a point to a box, negative inside it
+ */
+static float box_distance(const CourseBox &box, float x, float y) {
+    float dx = std::max(std::max(box.x0 - x, x - box.x1), 0.0f);
+    float dy = std::max(std::max(box.y0 - y, y - box.y1), 0.0f);
+    if ((dx > 0) || (dy > 0)) {
+        return sqrtf(dx * dx + dy * dy);
+    }
+    return -std::min(std::min(x - box.x0, box.x1 - x), std::min(y - box.y0, box.y1 - y));
+}
+
+static bool solid_kind(int kind) {
+    return (kind == COURSE_WALL) || (kind == COURSE_JUKEBOX) || (kind == COURSE_SINK) || (kind == COURSE_FINAL_BUTTON);
+}
+
+CourseModel::CourseModel() {
+    // Outside walls
+    add_box("left wall", -5, -5, 0, COURSE_LENGTH + 5, COURSE_WALL);
+    add_box("right wall", COURSE_WIDTH, -5, COURSE_WIDTH + 5, COURSE_LENGTH + 5, COURSE_WALL);
+    add_box("bottom wall", -5, -5, COURSE_WIDTH + 5, 0, COURSE_WALL);
+    add_box("top wall", -5, COURSE_LENGTH, COURSE_WIDTH + 5, COURSE_LENGTH + 5, COURSE_WALL);
+
+    // Upper level edge and the sides of the ramp between the levels
+    add_box("upper edge left", 0, 33.5, 10.5, 34, COURSE_WALL);
+    add_box("upper edge right", 21.25, 33.5, COURSE_WIDTH, 34, COURSE_WALL);
+    add_box("ramp left side", 10.5, 20.5, 11, 34, COURSE_WALL);
+    add_box("ramp right side", 20.75, 20.5, 21.25, 34, COURSE_WALL);
+    rampX0 = 11;
+    rampY0 = 20.5;
+    rampX1 = 20.75;
+    rampY1 = 34;
+    rampPitch = 15;
+    rampPercent = 40;
+
+    // Jukebox in the lower left, buttons are areas on its face the arm tip reaches
+    add_box("jukebox", 0.5, 0, 10.5, 8.75, COURSE_JUKEBOX);
+    add_box("red button", 1.5, 8.25, 5.4, 9.75, COURSE_RED_BUTTON, 0);
+    add_box("blue button", 5.4, 8.25, 9.5, 9.75, COURSE_BLUE_BUTTON, 1);
+
+    // Upper level fixtures
+    add_box("sink", 2, 30, 11.5, 35, COURSE_SINK);
+    add_box("hot plate", 18, 62, 27, 68, COURSE_HOT_PLATE);
+    add_box("vanilla lever", 1.75, 53.75, 4.25, 56.25, COURSE_LEVER, 0);
+    add_box("twist lever", 3.95, 57.05, 6.45, 59.55, COURSE_LEVER, 1);
+    add_box("chocolate lever", 6.15, 60.35, 8.65, 62.85, COURSE_LEVER, 2);
+
+    // Final button in the lower right corner
+    add_box("final button", 32, 0, COURSE_WIDTH, 3, COURSE_FINAL_BUTTON);
+
+    build_grid();
+}
+
+void CourseModel::add_box(const char *name, float x0, float y0, float x1, float y1, int kind, int index) {
+    CourseBox box = { name, x0, y0, x1, y1, kind, index };
+    boxes.push_back(box);
+}
+
+void CourseModel::build_grid() {
+    gridWidth = (int)(COURSE_WIDTH / COURSE_CELL);
+    gridLength = (int)(COURSE_LENGTH / COURSE_CELL);
+    clearanceGrid.assign(gridWidth * gridLength, 1e9f);
+
+    for (int iy = 0; iy < gridLength; iy++) {
+        for (int ix = 0; ix < gridWidth; ix++) {
+            float x = (ix + 0.5f) * COURSE_CELL;
+            float y = (iy + 0.5f) * COURSE_CELL;
+            float &cell = clearanceGrid[iy * gridWidth + ix];
+            for (size_t i = 0; i < boxes.size(); i++) {
+                if (solid_kind(boxes[i].kind)) {
+                    cell = std::min(cell, box_distance(boxes[i], x, y));
+                }
+            }
+        }
+    }
+}
+
+float CourseModel::ramp_grade(float x, float y) const {
+    if ((x >= rampX0) && (x <= rampX1) && (y >= rampY0) && (y <= rampY1)) {
+        return sin(rampPitch * COURSE_PI / 180);
+    }
+    return 0;
+}
+
+bool CourseModel::blocked(const CourseState &state, float x, float y, float newX, float newY) const {
+    float after = clearance(newX, newY);
+    if ((after < COURSE_ROBOT_RADIUS) && (after < clearance(x, y))) {
+        return true;
+    }
+
+    // The hot plate is only solid when the arm isn't holding it
+    if ((state.hotPlate == HOT_PLATE_DOWN) || (state.hotPlate == HOT_PLATE_FLIPPED)) {
+        for (size_t i = 0; i < boxes.size(); i++) {
+            if (boxes[i].kind == COURSE_HOT_PLATE) {
+                float plateAfter = box_distance(boxes[i], newX, newY);
+                if ((plateAfter < COURSE_ROBOT_RADIUS) && (plateAfter < box_distance(boxes[i], x, y))) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+void CourseModel::interact(CourseState &state, double time, float x, float y, float heading, bool pushing,
+                           float baseDegree, float armDegree, float lastBaseDegree) const {
+    float headingRad = heading * COURSE_PI / 180;
+    float tipX = x + COURSE_ARM_REACH * cos(headingRad);
+    float tipY = y + COURSE_ARM_REACH * sin(headingRad);
+
+    for (size_t i = 0; i < boxes.size(); i++) {
+        const CourseBox &box = boxes[i];
+        float robotDistance = box_distance(box, x, y);
+        float tipDistance = box_distance(box, tipX, tipY);
+        bool touching = robotDistance <= COURSE_ROBOT_RADIUS + COURSE_CONTACT;
+
+        switch (box.kind) {
+        case COURSE_RED_BUTTON:
+        case COURSE_BLUE_BUTTON:
+            // Base servo down with the tip on this button
+            if ((state.jukeboxButton < 0) && (baseDegree <= 20) && (tipDistance <= 0)) {
+                state.jukeboxButton = box.index;
+                state.jukeboxTime = time;
+            }
+            break;
+
+        case COURSE_SINK:
+            // Tray falls off the back of the robot when the base servo tips it back, so it has to be close
+            if ((robotDistance <= COURSE_ROBOT_RADIUS + COURSE_TRAY_DROP) && (baseDegree >= 100)) {
+                state.trayDropped = true;
+            }
+            break;
+
+        case COURSE_HOT_PLATE:
+            if ((state.hotPlate == HOT_PLATE_DOWN) && (tipDistance <= 0.5f) && (baseDegree <= 10)) {
+                state.hotPlate = HOT_PLATE_UNDER;
+            } else if (state.hotPlate == HOT_PLATE_UNDER) {
+                if (tipDistance > 1) {
+                    state.hotPlate = HOT_PLATE_DOWN; // Arm slid back out
+                } else if (baseDegree >= 15) {
+                    state.hotPlate = HOT_PLATE_LIFTED;
+                }
+            } else if (state.hotPlate == HOT_PLATE_LIFTED) {
+                if (tipDistance > 2) {
+                    state.hotPlate = HOT_PLATE_DOWN; // Dropped it
+                } else if (armDegree >= 140) {
+                    state.hotPlate = HOT_PLATE_FLIPPED;
+                }
+            }
+            break;
+
+        case COURSE_LEVER:
+            // Base servo coming down onto the lever
+            if ((state.leverDown < 0) && (tipDistance <= 1) && (lastBaseDegree > 60) && (baseDegree <= 45)) {
+                state.leverDown = box.index;
+            }
+            break;
+
+        case COURSE_FINAL_BUTTON:
+            if ((state.finalButtonTime < 0) && pushing && touching) {
+                state.finalButtonTime = time;
+            }
+            break;
+        }
+    }
+}
+
+void CourseModel::print(const CourseState &state) const {
+    static const char *colors[] = { "red", "blue" };
+    static const char *flavors[] = { "vanilla", "twist", "chocolate" };
+    static const char *plates[] = { "down", "arm under it", "lifted", "flipped" };
+
+    if (state.jukeboxButton >= 0) {
+        printf("Jukebox: %s button pressed at %.2f s\n", colors[state.jukeboxButton], state.jukeboxTime);
+    } else {
+        printf("Jukebox: no button pressed\n");
+    }
+    printf("Tray: %s\n", state.trayDropped ? "dropped in the sink" : "not dropped in the sink");
+    printf("Hot plate: %s\n", plates[state.hotPlate]);
+    printf("Ice cream: %s\n", (state.leverDown >= 0) ? flavors[state.leverDown] : "no lever pulled");
+    if (state.finalButtonTime >= 0) {
+        printf("Final button: pressed at %.2f s\n", state.finalButtonTime);
+    } else {
+        printf("Final button: not pressed\n");
+    }
+    printf("Stalled against something for %.2f s\n", state.stalledTime);
+}
@@ -0,0 +1,135 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*        Course geometry model (host)       */
+/*                                           */
+/*  Walls, fixtures and the ramp for the     */
+/*  simulators, in RPS coordinates (inches). */
+/*  Positions are worked back from the moves */
+/*  in run_course() like the start pose, so  */
+/*  adjust them against the real course.     */
+/*                                           */
+/*  Solid boxes are baked into a clearance   */
+/*  grid (distance to the nearest solid) so  */
+/*  a collision check is one array lookup.   */
+/*  That keeps it cheap enough for the batch */
+/*  simulator's vectorized loop.             */
+/*********************************************/
+
+#ifndef COURSE_MODEL_H
+#define COURSE_MODEL_H
+
+#include <vector>
+
+/************************************************/
+// Definitions
+#define COURSE_WIDTH 36.0f // x from 0 to here
+#define COURSE_LENGTH 72.0f // y from 0 to here
+#define COURSE_CELL 0.25f // Clearance grid resolution in inches
+#define COURSE_ROBOT_RADIUS 4.0f // Robot footprint as a circle around the wheel axis center, half of the 8 inch sides
+#define COURSE_ARM_REACH 6.5f // Wheel axis center to the arm tip with the arm down
+
+// What touching a box does
+enum CourseBoxKind {
+    COURSE_WALL, // Solid, nothing else
+    COURSE_JUKEBOX, // Solid, the arm tip on a button with the base servo down presses it
+    COURSE_RED_BUTTON, // Not solid, area on the jukebox face
+    COURSE_BLUE_BUTTON,
+    COURSE_SINK, // Solid, dropping the tray next to it counts
+    COURSE_HOT_PLATE, // Solid until the arm gets under it
+    COURSE_LEVER, // Not solid, arm tip area of an ice cream lever
+    COURSE_FINAL_BUTTON // Solid, pressed by driving into it
+};
+
+struct CourseBox {
+    const char *name;
+    float x0, y0, x1, y1;
+    int kind;
+    int index; // Which button/lever for kinds that have more than one
+};
+
+// Hot plate progress in flip_burger()
+enum CourseHotPlate {
+    HOT_PLATE_DOWN, // Blocks the robot
+    HOT_PLATE_UNDER, // Arm is under the plate, robot can drive forward
+    HOT_PLATE_LIFTED, // Arm raised with the plate on it
+    HOT_PLATE_FLIPPED // On arm servo pushed it over
+};
+
+/*******************************************************
+ * @brief Results of a run on the course
+ */
+struct CourseState {
+    int jukeboxButton = -1; // -1 none, 0 red, 1 blue (same as detect_color())
+    double jukeboxTime = -1; // When it was pressed
+    bool trayDropped = false;
+    int hotPlate = HOT_PLATE_DOWN;
+    int leverDown = -1; // -1 none, 0 vanilla, 1 twist, 2 chocolate (same as RPS.GetIceCream())
+    double finalButtonTime = -1;
+    double stalledTime = 0; // Seconds spent pushing against something solid
+};
+
+/*******************************************************
+ * @brief Course geometry, clearance grid and fixture rules
+ */
+class CourseModel {
+public:
+    CourseModel();
+
+    std::vector<CourseBox> boxes;
+
+    // Ramp area, uphill is +y
+    float rampX0, rampY0, rampX1, rampY1;
+    float rampPitch; // Degrees
+    float rampPercent; // Motor percent lost per unit of sin(pitch) driving straight uphill
+
+    // Clearance grid, row major in y
+    int gridWidth, gridLength;
+    std::vector<float> clearanceGrid;
+
+    /*******************************************************
+     * @brief Distance from a point to the nearest static solid (walls, jukebox,
+     * sink, final button). Negative inside one.
+     */
+    float clearance(float x, float y) const {
+        int ix = (int)(x * (1 / COURSE_CELL));
+        int iy = (int)(y * (1 / COURSE_CELL));
+        ix = (ix < 0) ? 0 : ((ix >= gridWidth) ? gridWidth - 1 : ix);
+        iy = (iy < 0) ? 0 : ((iy >= gridLength) ? gridLength - 1 : iy);
+        return clearanceGrid[iy * gridWidth + ix];
+    }
+
+    /*******************************************************
+     * @brief sin(pitch) of the ramp under a point, 0 off the ramp
+     */
+    float ramp_grade(float x, float y) const;
+
+    /*******************************************************
+     * @brief Checks a move of the footprint from one point to another,
+     * including the hot plate in its current state
+     *
+     * @return bool true if the move pushes further into something solid
+     */
+    bool blocked(const CourseState &state, float x, float y, float newX, float newY) const;
+
+    /*******************************************************
+     * @brief Applies the fixture rules after the robot moves or a servo changes
+     *
+     * @param pushing true if the last move was blocked
+     * @param baseDegree Base servo (Servo5) angle
+     * @param armDegree On arm servo (Servo7) angle
+     * @param lastBaseDegree Base servo angle before this call, to catch it coming down
+     */
+    void interact(CourseState &state, double time, float x, float y, float heading, bool pushing,
+                  float baseDegree, float armDegree, float lastBaseDegree) const;
+
+    /*******************************************************
+     * @brief Prints what happened to each fixture
+     */
+    void print(const CourseState &state) const;
+
+private:
+    void add_box(const char *name, float x0, float y0, float x1, float y1, int kind, int index = 0);
+    void build_grid();
+};
+
+#endif
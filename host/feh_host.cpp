@@ -0,0 +1,195 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*    Host stand-in for the Proteus (impl)   */
+/*********************************************/
+
+#include "feh_host.h"
+#include "lcd_frame.h"
+
+#include <FEHLCD.h>
+#include <FEHIO.h>
+#include <FEHUtility.h>
+#include <FEHMotor.h>
+#include <FEHRPS.h>
+#include <FEHServo.h>
+#include <FEHSD.h>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+
+/************************************************/
+// Active hardware
+static HostHardware idleHardware;
+static HostHardware *activeHardware = &idleHardware;
+
+void host_set_hardware(HostHardware *hardware) {
+    activeHardware = hardware ? hardware : &idleHardware;
+}
+
+HostHardware &host_hardware() {
+    return *activeHardware;
+}
+
+/************************************************/
+// Call profiling
+HostCallProfile hostCallProfile;
+
+// Adds the time until it goes out of scope to hostCallProfile
+class HostCallTimer {
+public:
+    HostCallTimer(HostCallKind kind) : kind(kind) {
+        if (hostCallProfile.enabled) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~HostCallTimer() {
+        if (hostCallProfile.enabled) {
+            hostCallProfile.calls[kind]++;
+            hostCallProfile.seconds[kind] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+private:
+    HostCallKind kind;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define SENSOR_CALL HostCallTimer timer(HOST_CALL_SENSOR)
+#define OUTPUT_CALL HostCallTimer timer(HOST_CALL_OUTPUT)
+#define LCD_CALL HostCallTimer timer(HOST_CALL_LCD)
+#define SLEEP_CALL HostCallTimer timer(HOST_CALL_SLEEP)
+
+#define LCD_NUMBER_LENGTH 32 // Longest number the LCD stand-in formats
+
+/************************************************/
+// FEHUtility
+double TimeNow() { SENSOR_CALL; return activeHardware->TimeNow(); }
+void Sleep(int msec) { SLEEP_CALL; activeHardware->Sleep(msec / 1000.0); }
+void Sleep(float seconds) { SLEEP_CALL; activeHardware->Sleep(seconds); }
+void Sleep(double seconds) { SLEEP_CALL; activeHardware->Sleep(seconds); }
+
+/************************************************/
+// FEHIO
+DigitalEncoder::DigitalEncoder(FEHIO::FEHIOPin pin, FEHIO::FEHIOInterruptTrigger trigger) : pin(pin) {}
+int DigitalEncoder::Counts() { SENSOR_CALL; return activeHardware->EncoderCounts(pin); }
+void DigitalEncoder::ResetCounts() { OUTPUT_CALL; activeHardware->EncoderReset(pin); }
+
+AnalogInputPin::AnalogInputPin(FEHIO::FEHIOPin pin) : pin(pin) {}
+float AnalogInputPin::Value() { SENSOR_CALL; return activeHardware->AnalogValue(pin); }
+
+/************************************************/
+// FEHMotor
+FEHMotor::FEHMotor(FEHMotorPort port, float maxVoltage) : port(port) {}
+void FEHMotor::SetPercent(float percent) { OUTPUT_CALL; activeHardware->MotorPercent(port, percent); }
+void FEHMotor::Stop() { OUTPUT_CALL; activeHardware->MotorStop(port); }
+
+/************************************************/
+// FEHServo
+FEHServo::FEHServo(FEHServoPort port) : port(port) {}
+void FEHServo::SetMin(int min) {}
+void FEHServo::SetMax(int max) {}
+void FEHServo::SetDegree(float degree) { OUTPUT_CALL; activeHardware->ServoDegree(port, degree); }
+void FEHServo::TouchCalibrate() {}
+void FEHServo::Off() {}
+
+/************************************************/
+// FEHRPS
+FEHRPS RPS;
+
+void FEHRPS::InitializeTouchMenu() {}
+float FEHRPS::X() { SENSOR_CALL; return activeHardware->RPSX(); }
+float FEHRPS::Y() { SENSOR_CALL; return activeHardware->RPSY(); }
+float FEHRPS::Heading() { SENSOR_CALL; return activeHardware->RPSHeading(); }
+int FEHRPS::Time() { SENSOR_CALL; return activeHardware->RPSTime(); }
+char FEHRPS::CurrentRegionLetter() { SENSOR_CALL; return activeHardware->RPSRegion(); }
+int FEHRPS::GetIceCream() { SENSOR_CALL; return activeHardware->RPSIceCream(); }
+
+/************************************************/
+// FEHLCD. Drawing goes into the framebuffer in lcd_frame.h, only touches reach the hardware.
+FEHLCD LCD;
+
+// Number formats of the Proteus library
+static void format_int(char *text, int i) { snprintf(text, LCD_NUMBER_LENGTH, "%d", i); }
+static void format_float(char *text, double f) { snprintf(text, LCD_NUMBER_LENGTH, "%.3f", f); }
+
+void FEHLCD::Clear() { LCD_CALL; lcd_clear(lcd_background_color()); }
+void FEHLCD::Clear(unsigned int color) { LCD_CALL; lcd_clear(color); }
+void FEHLCD::ClearBuffer() { LCD_CALL; } // Clears the touch buffer, nothing to draw
+void FEHLCD::SetBackgroundColor(unsigned int color) { LCD_CALL; lcd_set_background_color(color); }
+void FEHLCD::SetFontColor(unsigned int color) { LCD_CALL; lcd_set_font_color(color); }
+void FEHLCD::FillRectangle(int x, int y, int width, int height) { LCD_CALL; lcd_fill_rectangle(x, y, width, height); }
+void FEHLCD::DrawHorizontalLine(int y, int x1, int x2) { LCD_CALL; lcd_horizontal_line(y, x1, x2); }
+void FEHLCD::DrawVerticalLine(int x, int y1, int y2) { LCD_CALL; lcd_vertical_line(x, y1, y2); }
+
+void FEHLCD::Write(const char *str) { LCD_CALL; lcd_write(str, false); }
+void FEHLCD::Write(int i) { LCD_CALL; char text[LCD_NUMBER_LENGTH]; format_int(text, i); lcd_write(text, false); }
+void FEHLCD::Write(float f) { LCD_CALL; char text[LCD_NUMBER_LENGTH]; format_float(text, f); lcd_write(text, false); }
+void FEHLCD::Write(double d) { LCD_CALL; char text[LCD_NUMBER_LENGTH]; format_float(text, d); lcd_write(text, false); }
+void FEHLCD::Write(char c) { LCD_CALL; char text[2] = { c, 0 }; lcd_write(text, false); }
+void FEHLCD::WriteLine(const char *str) { LCD_CALL; lcd_write(str, true); }
+void FEHLCD::WriteLine(int i) { LCD_CALL; char text[LCD_NUMBER_LENGTH]; format_int(text, i); lcd_write(text, true); }
+void FEHLCD::WriteLine(float f) { LCD_CALL; char text[LCD_NUMBER_LENGTH]; format_float(text, f); lcd_write(text, true); }
+void FEHLCD::WriteLine(double d) { LCD_CALL; char text[LCD_NUMBER_LENGTH]; format_float(text, d); lcd_write(text, true); }
+void FEHLCD::WriteLine(char c) { LCD_CALL; char text[2] = { c, 0 }; lcd_write(text, true); }
+void FEHLCD::WriteRC(const char *str, int row, int col) { LCD_CALL; lcd_write_rc(str, row, col); }
+void FEHLCD::WriteRC(int i, int row, int col) { LCD_CALL; char text[LCD_NUMBER_LENGTH]; format_int(text, i); lcd_write_rc(text, row, col); }
+void FEHLCD::WriteRC(float f, int row, int col) { LCD_CALL; char text[LCD_NUMBER_LENGTH]; format_float(text, f); lcd_write_rc(text, row, col); }
+void FEHLCD::WriteRC(double d, int row, int col) { LCD_CALL; char text[LCD_NUMBER_LENGTH]; format_float(text, d); lcd_write_rc(text, row, col); }
+void FEHLCD::WriteRC(char c, int row, int col) { LCD_CALL; char text[2] = { c, 0 }; lcd_write_rc(text, row, col); }
+
+bool FEHLCD::Touch(int *x, int *y) { SENSOR_CALL; return activeHardware->Touch(x, y); }
+
+/************************************************/
+// FEHSD. Backed by normal files.
+FEHSD SD;
+
+struct FEHFile {
+    FILE *file;
+};
+
+FEHFile *FEHSD::FOpen(const char *str, const char *mode) {
+    FILE *file = fopen(str, mode);
+    if (!file) {
+        return 0;
+    }
+    FEHFile *fptr = new FEHFile;
+    fptr->file = file;
+    return fptr;
+}
+
+int FEHSD::FClose(FEHFile *fptr) {
+    if (!fptr) {
+        return -1;
+    }
+    int result = fclose(fptr->file);
+    delete fptr;
+    return result;
+}
+
+int FEHSD::FCloseAll() { return 0; }
+
+int FEHSD::FPrintf(FEHFile *fptr, const char *format, ...) {
+    if (!fptr) {
+        return -1;
+    }
+    va_list args;
+    va_start(args, format);
+    int result = vfprintf(fptr->file, format, args);
+    va_end(args);
+    return result;
+}
+
+int FEHSD::FScanf(FEHFile *fptr, const char *format, ...) {
+    if (!fptr) {
+        return -1;
+    }
+    va_list args;
+    va_start(args, format);
+    int result = vfscanf(fptr->file, format, args);
+    va_end(args);
+    return result;
+}
+
+int FEHSD::FEof(FEHFile *fptr) { return fptr ? feof(fptr->file) : 1; }
@@ -0,0 +1,86 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*        Host stand-in for the Proteus      */
+/*                                           */
+/*  The FEH*.h headers in this folder let    */
+/*  main.cpp compile on a computer. Every    */
+/*  call they get is passed to whichever     */
+/*  HostHardware is active (a trace replay,  */
+/*  a simulator, ...).                       */
+/*********************************************/
+
+#ifndef FEH_HOST_H
+#define FEH_HOST_H
+
+/*******************************************************
+ * @brief Hardware the FEH stand-ins talk to. The defaults act like a robot
+ * sitting still with nothing plugged in.
+ */
+class HostHardware {
+public:
+    virtual ~HostHardware() {}
+
+    // Time
+    virtual double TimeNow() { return 0; }
+    virtual void Sleep(double seconds) {}
+
+    // Time for instrumentation (timeline_time()), which the sensor trace doesn't record. Read
+    // from destructors, so it must not throw.
+    virtual double Clock() { return TimeNow(); }
+
+    // Inputs
+    virtual int EncoderCounts(int pin) { return 0; }
+    virtual float AnalogValue(int pin) { return 3.3f; }
+    virtual float RPSHeading() { return -1; }
+    virtual float RPSX() { return -1; }
+    virtual float RPSY() { return -1; }
+    virtual int RPSTime() { return 0; }
+    virtual char RPSRegion() { return 'A'; }
+    virtual int RPSIceCream() { return 0; }
+    virtual bool Touch(int *x, int *y) { return false; }
+
+    // Outputs
+    virtual void EncoderReset(int pin) {}
+    virtual void MotorPercent(int port, float percent) {}
+    virtual void MotorStop(int port) {}
+    virtual void ServoDegree(int port, float degree) {}
+
+    // Encoder stop (encoder_stop.h). targetCounts is the sum of both drive encoders a move stops
+    // at. The hardware notes when the counts get there, so the stop latency can be measured.
+    virtual void EncoderStopArm(int targetCounts) {}
+
+    // Seconds from the drive encoders reaching the armed target to both drive motors stopping, -1 if not known
+    virtual double EncoderStopLatency() { return -1; }
+};
+
+/************************************************/
+// Host time spent inside FEH calls, used by the benchmarks
+enum HostCallKind {
+    HOST_CALL_SENSOR = 0, // TimeNow, encoders, analog pins, RPS, touch
+    HOST_CALL_OUTPUT, // Motors, servos, encoder resets
+    HOST_CALL_LCD, // Everything drawn on the screen
+    HOST_CALL_SLEEP, // Sleep (the robot is idle, only the simulation works here)
+    HOST_CALL_KINDS
+};
+
+struct HostCallProfile {
+    bool enabled;
+    unsigned long long calls[HOST_CALL_KINDS];
+    double seconds[HOST_CALL_KINDS];
+};
+
+extern HostCallProfile hostCallProfile;
+
+/*******************************************************
+ * @brief Sets the hardware the FEH stand-ins use
+ *
+ * @param hardware Hardware to use, 0 for the idle default
+ */
+void host_set_hardware(HostHardware *hardware);
+
+/*******************************************************
+ * @brief Gets the hardware the FEH stand-ins are using
+ */
+HostHardware &host_hardware();
+
+#endif
@@ -0,0 +1,262 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*    LCD framebuffer emulator (host, impl)  */
+/*********************************************/
+
+#include "lcd_frame.h"
+
+#include <FEHLCD.h>
+
+#include <algorithm>
+#include <cstring>
+
+/************************************************/
+// Definitions
+#define LCD_GLYPH_SCALE 2 // 5x8 glyphs drawn at 10x16 inside the 12x17 cell
+#define LCD_FIRST_GLYPH ' '
+#define LCD_LAST_GLYPH '~'
+
+// 5x8 font, one byte per column, bit 0 at the top
+static const unsigned char lcdFont[LCD_LAST_GLYPH - LCD_FIRST_GLYPH + 1][5] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 }, // space ! "
+    { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, // # $ %
+    { 0x36, 0x49, 0x56, 0x20, 0x50 }, { 0x00, 0x08, 0x07, 0x03, 0x00 }, { 0x00, 0x1C, 0x22, 0x41, 0x00 }, // & ' (
+    { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x2A, 0x1C, 0x7F, 0x1C, 0x2A }, { 0x08, 0x08, 0x3E, 0x08, 0x08 }, // ) * +
+    { 0x00, 0x80, 0x70, 0x30, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x00, 0x60, 0x60, 0x00 }, // , - .
+    { 0x20, 0x10, 0x08, 0x04, 0x02 }, { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, // / 0 1
+    { 0x72, 0x49, 0x49, 0x49, 0x46 }, { 0x21, 0x41, 0x49, 0x4D, 0x33 }, { 0x18, 0x14, 0x12, 0x7F, 0x10 }, // 2 3 4
+    { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x31 }, { 0x41, 0x21, 0x11, 0x09, 0x07 }, // 5 6 7
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x46, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x00, 0x14, 0x00, 0x00 }, // 8 9 :
+    { 0x00, 0x40, 0x34, 0x00, 0x00 }, { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, // ; < =
+    { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x59, 0x09, 0x06 }, { 0x3E, 0x41, 0x5D, 0x59, 0x4E }, // > ? @
+    { 0x7C, 0x12, 0x11, 0x12, 0x7C }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 }, // A B C
+    { 0x7F, 0x41, 0x41, 0x41, 0x3E }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x09, 0x01 }, // D E F
+    { 0x3E, 0x41, 0x41, 0x51, 0x73 }, { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, // G H I
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, { 0x7F, 0x40, 0x40, 0x40, 0x40 }, // J K L
+    { 0x7F, 0x02, 0x1C, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E }, // M N O
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 }, // P Q R
+    { 0x26, 0x49, 0x49, 0x49, 0x32 }, { 0x03, 0x01, 0x7F, 0x01, 0x03 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, // S T U
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F }, { 0x63, 0x14, 0x08, 0x14, 0x63 }, // V W X
+    { 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x59, 0x49, 0x4D, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x41 }, // Y Z [
+    { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x41, 0x7F }, { 0x04, 0x02, 0x01, 0x02, 0x04 }, // \ ] ^
+    { 0x40, 0x40, 0x40, 0x40, 0x40 }, { 0x00, 0x03, 0x07, 0x08, 0x00 }, { 0x20, 0x54, 0x54, 0x78, 0x40 }, // _ ` a
+    { 0x7F, 0x28, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x28 }, { 0x38, 0x44, 0x44, 0x28, 0x7F }, // b c d
+    { 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x00, 0x08, 0x7E, 0x09, 0x02 }, { 0x18, 0xA4, 0xA4, 0x9C, 0x78 }, // e f g
+    { 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, { 0x20, 0x40, 0x40, 0x3D, 0x00 }, // h i j
+    { 0x7F, 0x10, 0x28, 0x44, 0x00 }, { 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x78, 0x04, 0x78 }, // k l m
+    { 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 }, { 0xFC, 0x18, 0x24, 0x24, 0x18 }, // n o p
+    { 0x18, 0x24, 0x24, 0x18, 0xFC }, { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x24 }, // q r s
+    { 0x04, 0x04, 0x3F, 0x44, 0x24 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, { 0x1C, 0x20, 0x40, 0x20, 0x1C }, // t u v
+    { 0x3C, 0x40, 0x30, 0x40, 0x3C }, { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x4C, 0x90, 0x90, 0x90, 0x7C }, // w x y
+    { 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 }, { 0x00, 0x00, 0x77, 0x00, 0x00 }, // z { |
+    { 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x02, 0x01, 0x02, 0x04, 0x02 }, // } ~
+};
+
+// Names for lcd_print_stats(), indexed by LcdOp
+static const char *lcdOpNames[LCD_OP_COUNT] = {
+    "Clear", "FillRectangle", "DrawHorizontalLine", "DrawVerticalLine",
+    "Write", "WriteRC", "SetBackgroundColor", "SetFontColor"
+};
+
+/************************************************/
+// State
+LcdStats lcdStats;
+unsigned int lcdFrame[LCD_HEIGHT * LCD_WIDTH];
+
+static unsigned int backgroundColor = BLACK;
+static unsigned int fontColor = WHITE;
+static int cursorRow = 0;
+static int cursorCol = 0;
+
+void lcd_reset() {
+    std::fill(lcdFrame, lcdFrame + LCD_WIDTH * LCD_HEIGHT, BLACK);
+    backgroundColor = BLACK;
+    fontColor = WHITE;
+    cursorRow = 0;
+    cursorCol = 0;
+}
+
+/************************************************/
+// Drawing
+
+/*******************************************************
+ * @brief Fills a clipped rectangle with a color
+ *
+ * @return unsigned long Pixels written
+ */
+static unsigned long fill(int x0, int y0, int x1, int y1, unsigned int color) {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, LCD_WIDTH);
+    y1 = std::min(y1, LCD_HEIGHT);
+    if ((x0 >= x1) || (y0 >= y1)) {
+        return 0;
+    }
+
+    for (int y = y0; y < y1; y++) {
+        std::fill(lcdFrame + y * LCD_WIDTH + x0, lcdFrame + y * LCD_WIDTH + x1, color);
+    }
+    return (unsigned long)(x1 - x0) * (y1 - y0);
+}
+
+/*******************************************************
+ * @brief Draws one character cell, background first then the glyph
+ *
+ * @return unsigned long Pixels written
+ */
+static unsigned long draw_char(char c, int row, int col) {
+    int left = col * LCD_CHAR_WIDTH;
+    int top = row * LCD_CHAR_HEIGHT;
+    unsigned long pixels = fill(left, top, left + LCD_CHAR_WIDTH, top + LCD_CHAR_HEIGHT, backgroundColor);
+
+    if ((c < LCD_FIRST_GLYPH) || (c > LCD_LAST_GLYPH)) {
+        c = '?';
+    }
+    const unsigned char *glyph = lcdFont[c - LCD_FIRST_GLYPH];
+
+    for (int gx = 0; gx < 5; gx++) {
+        for (int gy = 0; gy < 8; gy++) {
+            if (glyph[gx] & (1 << gy)) {
+                int x = left + 1 + gx * LCD_GLYPH_SCALE;
+                int y = top + gy * LCD_GLYPH_SCALE;
+                fill(x, y, x + LCD_GLYPH_SCALE, y + LCD_GLYPH_SCALE, fontColor);
+            }
+        }
+    }
+    return pixels;
+}
+
+void lcd_clear(unsigned int color) {
+    lcdStats.calls[LCD_OP_CLEAR]++;
+    lcdStats.pixels[LCD_OP_CLEAR] += fill(0, 0, LCD_WIDTH, LCD_HEIGHT, color);
+    cursorRow = 0;
+    cursorCol = 0;
+}
+
+void lcd_set_background_color(unsigned int color) {
+    lcdStats.calls[LCD_OP_BACKGROUND_COLOR]++;
+    backgroundColor = color;
+}
+
+void lcd_set_font_color(unsigned int color) {
+    lcdStats.calls[LCD_OP_FONT_COLOR]++;
+    fontColor = color;
+}
+
+unsigned int lcd_background_color() {
+    return backgroundColor;
+}
+
+void lcd_fill_rectangle(int x, int y, int width, int height) {
+    // Like the Proteus, rectangles are filled with the font color
+    lcdStats.calls[LCD_OP_FILL_RECTANGLE]++;
+    lcdStats.pixels[LCD_OP_FILL_RECTANGLE] += fill(x, y, x + width, y + height, fontColor);
+}
+
+void lcd_horizontal_line(int y, int x1, int x2) {
+    lcdStats.calls[LCD_OP_HORIZONTAL_LINE]++;
+    lcdStats.pixels[LCD_OP_HORIZONTAL_LINE] += fill(std::min(x1, x2), y, std::max(x1, x2) + 1, y + 1, fontColor);
+}
+
+void lcd_vertical_line(int x, int y1, int y2) {
+    lcdStats.calls[LCD_OP_VERTICAL_LINE]++;
+    lcdStats.pixels[LCD_OP_VERTICAL_LINE] += fill(x, std::min(y1, y2), x + 1, std::max(y1, y2) + 1, fontColor);
+}
+
+void lcd_write(const char *text, bool newline) {
+    lcdStats.calls[LCD_OP_WRITE]++;
+
+    for (const char *c = text; *c; c++) {
+        if (*c == '\n') {
+            cursorCol = LCD_COLUMNS;
+        } else {
+            lcdStats.pixels[LCD_OP_WRITE] += draw_char(*c, cursorRow, cursorCol);
+            cursorCol++;
+        }
+
+        if (cursorCol >= LCD_COLUMNS) {
+            cursorCol = 0;
+            cursorRow = (cursorRow + 1) % LCD_ROWS;
+        }
+    }
+
+    if (newline) {
+        cursorCol = 0;
+        cursorRow = (cursorRow + 1) % LCD_ROWS;
+    }
+}
+
+void lcd_write_rc(const char *text, int row, int col) {
+    lcdStats.calls[LCD_OP_WRITE_RC]++;
+
+    // Text past the right edge is cut off
+    for (const char *c = text; *c && (col < LCD_COLUMNS); c++, col++) {
+        if ((row >= 0) && (row < LCD_ROWS) && (col >= 0)) {
+            lcdStats.pixels[LCD_OP_WRITE_RC] += draw_char(*c, row, col);
+        }
+    }
+}
+
+/************************************************/
+// Screenshots and stats
+
+bool lcd_write_ppm(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", LCD_WIDTH, LCD_HEIGHT);
+    unsigned char row[LCD_WIDTH * 3];
+    for (int y = 0; y < LCD_HEIGHT; y++) {
+        for (int x = 0; x < LCD_WIDTH; x++) {
+            unsigned int color = lcdFrame[y * LCD_WIDTH + x];
+            row[x * 3] = (color >> 16) & 0xFF;
+            row[x * 3 + 1] = (color >> 8) & 0xFF;
+            row[x * 3 + 2] = color & 0xFF;
+        }
+        fwrite(row, 1, sizeof(row), file);
+    }
+
+    return fclose(file) == 0;
+}
+
+void lcd_reset_stats() {
+    memset(&lcdStats, 0, sizeof(lcdStats));
+}
+
+unsigned long long lcd_total_calls() {
+    unsigned long long total = 0;
+    for (int i = 0; i < LCD_OP_COUNT; i++) {
+        total += lcdStats.calls[i];
+    }
+    return total;
+}
+
+unsigned long long lcd_total_pixels() {
+    unsigned long long total = 0;
+    for (int i = 0; i < LCD_OP_COUNT; i++) {
+        total += lcdStats.pixels[i];
+    }
+    return total;
+}
+
+void lcd_print_stats(FILE *out, double seconds) {
+    fprintf(out, "%-20s %9s %11s", "LCD call", "calls", "pixels");
+    if (seconds > 0) {
+        fprintf(out, " %9s %11s", "calls/s", "pixels/s");
+    }
+    fprintf(out, "\n");
+
+    for (int i = 0; i <= LCD_OP_COUNT; i++) {
+        const char *name = (i < LCD_OP_COUNT) ? lcdOpNames[i] : "total";
+        unsigned long long calls = (i < LCD_OP_COUNT) ? lcdStats.calls[i] : lcd_total_calls();
+        unsigned long long pixels = (i < LCD_OP_COUNT) ? lcdStats.pixels[i] : lcd_total_pixels();
+
+        fprintf(out, "%-20s %9llu %11llu", name, calls, pixels);
+        if (seconds > 0) {
+            fprintf(out, " %9.1f %11.0f", calls / seconds, pixels / seconds);
+        }
+        fprintf(out, "\n");
+    }
+}
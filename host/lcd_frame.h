@@ -0,0 +1,100 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*       LCD framebuffer emulator (host)     */
+/*                                           */
+/*  The host FEHLCD draws into a 320x240     */
+/*  framebuffer here instead of doing        */
+/*  nothing, and counts the calls made and   */
+/*  pixels written by each kind of drawing   */
+/*  call so display work can be measured.    */
+/*  lcd_write_ppm() saves a screenshot.      */
+/*********************************************/
+
+#ifndef LCD_FRAME_H
+#define LCD_FRAME_H
+
+#include <cstdio>
+
+/************************************************/
+// Definitions (same layout as the Proteus screen and font)
+#define LCD_WIDTH 320
+#define LCD_HEIGHT 240
+#define LCD_CHAR_WIDTH 12
+#define LCD_CHAR_HEIGHT 17
+#define LCD_COLUMNS (LCD_WIDTH / LCD_CHAR_WIDTH) // 26
+#define LCD_ROWS (LCD_HEIGHT / LCD_CHAR_HEIGHT) // 14
+
+// Kinds of drawing call that are counted
+enum LcdOp {
+    LCD_OP_CLEAR = 0, // Clear()
+    LCD_OP_FILL_RECTANGLE, // FillRectangle()
+    LCD_OP_HORIZONTAL_LINE, // DrawHorizontalLine()
+    LCD_OP_VERTICAL_LINE, // DrawVerticalLine()
+    LCD_OP_WRITE, // Write() and WriteLine()
+    LCD_OP_WRITE_RC, // WriteRC()
+    LCD_OP_BACKGROUND_COLOR, // SetBackgroundColor()
+    LCD_OP_FONT_COLOR, // SetFontColor()
+    LCD_OP_COUNT
+};
+
+struct LcdStats {
+    unsigned long long calls[LCD_OP_COUNT];
+    unsigned long long pixels[LCD_OP_COUNT]; // Pixels written, text counts its whole character cells
+};
+
+extern LcdStats lcdStats;
+extern unsigned int lcdFrame[LCD_HEIGHT * LCD_WIDTH]; // 24-bit RGB, row major
+
+/*******************************************************
+ * @brief Clears the screen to black, homes the text cursor and resets the colors
+ */
+void lcd_reset();
+
+// Drawing, called by the FEHLCD stand-in
+void lcd_clear(unsigned int color);
+void lcd_set_background_color(unsigned int color);
+void lcd_set_font_color(unsigned int color);
+unsigned int lcd_background_color();
+void lcd_fill_rectangle(int x, int y, int width, int height);
+void lcd_horizontal_line(int y, int x1, int x2);
+void lcd_vertical_line(int x, int y1, int y2);
+
+/*******************************************************
+ * @brief Writes text at the cursor, wrapping at the right edge and back
+ * to the top after the last row
+ *
+ * @param newline true to move the cursor to the next row afterwards (WriteLine)
+ */
+void lcd_write(const char *text, bool newline);
+
+/*******************************************************
+ * @brief Writes text starting at a character row and column. Leaves the cursor alone.
+ */
+void lcd_write_rc(const char *text, int row, int col);
+
+/*******************************************************
+ * @brief Saves the framebuffer as a binary PPM (P6) image
+ *
+ * @return bool true if the file was written
+ */
+bool lcd_write_ppm(const char *path);
+
+/*******************************************************
+ * @brief Zeroes lcdStats
+ */
+void lcd_reset_stats();
+
+/*******************************************************
+ * @brief Totals of lcdStats over all kinds
+ */
+unsigned long long lcd_total_calls();
+unsigned long long lcd_total_pixels();
+
+/*******************************************************
+ * @brief Prints calls and pixels per kind, and per second of robot time
+ *
+ * @param seconds Robot seconds the stats cover, 0 to leave out the rates
+ */
+void lcd_print_stats(FILE *out, double seconds);
+
+#endif
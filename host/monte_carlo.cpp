@@ -0,0 +1,205 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*        Monte Carlo open loop drift        */
+/*                                           */
+/*  Runs the opening moves of FINAL_COMP on  */
+/*  thousands of robots with perturbed       */
+/*  COUNT_PER_INCH, ROBOT_WIDTH and          */
+/*  BACKWARDS_CALIBRATOR models and reports  */
+/*  where they end up before the first RPS   */
+/*  correction.                              */
+/*                                           */
+/*  Usage: ./monte_carlo [-n robots]         */
+/*    [-p opening|jukebox] [-s seed]         */
+/*    [--cpi f] [--width f] [--backwards p]  */
+/*    [--scalar] [--course]                  */
+/*                                           */
+/*  --scalar also runs every robot one at a  */
+/*  time on SimRobot, checks the results     */
+/*  agree and compares throughput.           */
+/*  --course makes robots stop against the   */
+/*  walls and fixtures of course_model.h.    */
+/*********************************************/
+
+#include "batch_sim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/************************************************/
+// Definitions
+#define MC_DEFAULT_ROBOTS 4096
+#define MC_TIMEOUT 60.0f // Virtual seconds
+#define MC_SETTLE_TIME 0.35f // RPS_DELAY_TIME, the robot settles before RPS looks at it
+#define MC_FORWARD_SPEED 45 // FORWARD_SPEED
+#define MC_TURN_SPEED 30 // TURN_SPEED
+#define MC_DIST_AXIS_CDS 4.125 // DIST_AXIS_CDS
+
+/************************************************/
+// Programs, copied from the FINAL_COMP case of run_course() without the RPS corrections
+
+static void program_opening(BatchProgram &program) {
+    batch_forward_inches(program, MC_FORWARD_SPEED, 9 + MC_DIST_AXIS_CDS);
+    batch_turn_left(program, MC_TURN_SPEED, 45);
+    batch_forward_inches(program, MC_FORWARD_SPEED, 11.5 - 1.0607);
+    batch_sleep(program, MC_SETTLE_TIME); // RPS_check_x(RPS_Top_Level_X_Reference - 8.2, 1)
+}
+
+static void program_jukebox(BatchProgram &program) {
+    program_opening(program);
+    batch_turn_left(program, MC_TURN_SPEED, 90);
+    batch_forward_inches(program, -MC_FORWARD_SPEED, MC_DIST_AXIS_CDS + 0.25 - 1.0607);
+    batch_sleep(program, MC_SETTLE_TIME); // RPS_check_y(RPS_Top_Level_Y_Reference - 33.75, 2)
+}
+
+struct MonteCarloProgram {
+    const char *name;
+    void (*build)(BatchProgram &program);
+};
+
+static const MonteCarloProgram programs[] = {
+    { "opening", program_opening },
+    { "jukebox", program_jukebox },
+};
+
+/*******************************************************
+ * @brief Prints mean, standard deviation and 5th/95th percentiles of a value
+ */
+static void print_spread(const char *name, std::vector<double> values, double nominal) {
+    double mean = 0, variance = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        mean += values[i];
+    }
+    mean /= values.size();
+    for (size_t i = 0; i < values.size(); i++) {
+        variance += (values[i] - mean) * (values[i] - mean);
+    }
+    std::sort(values.begin(), values.end());
+
+    printf("%-8s nominal %8.3f  mean %8.3f  stddev %6.3f  p5 %8.3f  p95 %8.3f\n", name, nominal, mean,
+           sqrt(variance / values.size()), values[values.size() * 5 / 100], values[values.size() * 95 / 100]);
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int robots = MC_DEFAULT_ROBOTS;
+    unsigned seed = 1;
+    const MonteCarloProgram *program = &programs[0];
+    bool scalar = false;
+    bool useCourse = false;
+    BatchSpread spread;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && (i + 1 < argc)) {
+            robots = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-s") && (i + 1 < argc)) {
+            seed = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-p") && (i + 1 < argc)) {
+            const char *name = argv[++i];
+            program = 0;
+            for (size_t p = 0; p < sizeof(programs) / sizeof(programs[0]); p++) {
+                if (!strcmp(programs[p].name, name)) {
+                    program = &programs[p];
+                }
+            }
+            if (!program) {
+                fprintf(stderr, "unknown program %s\n", name);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--cpi") && (i + 1 < argc)) {
+            spread.countsPerInch = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--width") && (i + 1 < argc)) {
+            spread.trackWidth = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--backwards") && (i + 1 < argc)) {
+            spread.backwardsLoss = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--scalar")) {
+            scalar = true;
+        } else if (!strcmp(argv[i], "--course")) {
+            useCourse = true;
+        } else {
+            fprintf(stderr, "usage: %s [-n robots] [-p opening|jukebox] [-s seed] [--cpi f] [--width f] [--backwards p] [--scalar] [--course]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (robots < 1) {
+        fprintf(stderr, "need at least one robot\n");
+        return 2;
+    }
+
+    BatchProgram moves;
+    program->build(moves);
+    SimParams base;
+    CourseModel model;
+    const CourseModel *course = useCourse ? &model : 0;
+
+    // Unperturbed robot, what the course code was tuned for
+    SimRobot nominal(base);
+    nominal.course = course;
+    batch_run_scalar(moves, base, nominal, MC_TIMEOUT);
+
+    BatchSim batch(robots, base, spread, seed);
+    batch.course = course;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int finished = batch.run(moves, MC_TIMEOUT);
+    double batchSeconds = seconds_since(start);
+
+    printf("Program %s, %d robots, spread cpi %.3f width %.3f backwards %.2f, seed %u%s\n", program->name, robots,
+           spread.countsPerInch, spread.trackWidth, spread.backwardsLoss, seed, useCourse ? ", on the course" : "");
+    if (finished < robots) {
+        printf("%d robots did not finish within %.0f s\n", robots - finished, MC_TIMEOUT);
+    }
+
+    std::vector<double> xs(robots), ys(robots), headings(robots), errors(robots);
+    for (int i = 0; i < robots; i++) {
+        xs[i] = batch.x[i];
+        ys[i] = batch.y[i];
+        headings[i] = batch.heading(i);
+        errors[i] = hypot(batch.x[i] - nominal.x, batch.y[i] - nominal.y);
+    }
+    print_spread("x", xs, nominal.x);
+    print_spread("y", ys, nominal.y);
+    print_spread("heading", headings, nominal.heading);
+    print_spread("error", errors, 0);
+
+    if (useCourse) {
+        int stalledRobots = 0;
+        for (int i = 0; i < robots; i++) {
+            stalledRobots += (batch.stalledTime[i] > 0);
+        }
+        printf("%d robots (%.1f%%) ran into something\n", stalledRobots, 100.0 * stalledRobots / robots);
+    }
+
+    printf("Batch:  %.3f s, %.1f M robot steps/s\n", batchSeconds, batch.robotSteps / batchSeconds / 1e6);
+
+    if (scalar) {
+        SimRobot robot(base);
+        robot.course = course;
+        double largest = 0;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < robots; i++) {
+            SimParams params = base;
+            params.countsPerInch = batch.countsPerInch[i];
+            params.trackWidth = batch.trackWidth[i];
+            params.backwardsLoss = batch.backwardsLoss[i];
+            batch_run_scalar(moves, params, robot, MC_TIMEOUT);
+            largest = std::max(largest, hypot(robot.x - batch.x[i], robot.y - batch.y[i]));
+        }
+        double scalarSeconds = seconds_since(start);
+
+        printf("Scalar: %.3f s, batch is %.1fx faster\n", scalarSeconds, scalarSeconds / batchSeconds);
+        printf("Largest batch/scalar position difference %.4f in\n", largest);
+    }
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*            Timing probe report            */
+/*                                           */
+/*  Prints the probes.txt a run wrote        */
+/*  (probes.h): passes, mean, min, max and   */
+/*  percentiles of every probe, and with -h  */
+/*  the histogram behind them.               */
+/*                                           */
+/*  Usage: ./probe_report [-h] [probes.txt]  */
+/*********************************************/
+
+#include "../probes_format.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define REPORT_BAR_WIDTH 40 // Characters in the longest histogram bar
+
+struct ProbeLine {
+    std::string name;
+    unsigned long count, mean, min, max;
+    unsigned long buckets[PROBE_BUCKETS];
+};
+
+/*******************************************************
+ * @brief Reads a probes file
+ *
+ * @return bool false if it can't be read
+ */
+static bool read_probes(const char path[], unsigned long &ticksPerSec, std::vector<ProbeLine> &probes) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "%s: can't open file\n", path);
+        return false;
+    }
+
+    int version = 0;
+    bool ended = false;
+    char line[1024];
+    while (fgets(line, sizeof(line), file)) {
+        char name[64];
+        int count;
+        ProbeLine probe;
+        int used = 0;
+
+        if (sscanf(line, "PROBES %d %lu", &version, &ticksPerSec) == 2) {
+            continue;
+        } else if (sscanf(line, "END %d", &count) == 1) {
+            ended = true;
+        } else if (sscanf(line, "P %63s %lu %lu %lu %lu%n", name, &probe.count, &probe.mean, &probe.min, &probe.max, &used) == 5) {
+            const char *rest = line + used;
+            for (int b = 0; b < PROBE_BUCKETS; b++) {
+                int length = 0;
+                probe.buckets[b] = 0;
+                sscanf(rest, " %lu%n", &probe.buckets[b], &length);
+                rest += length;
+            }
+            probe.name = name;
+            probes.push_back(probe);
+        }
+    }
+    fclose(file);
+
+    if (version != PROBES_VERSION) {
+        fprintf(stderr, "%s: not a version %d probes file\n", path, PROBES_VERSION);
+        return false;
+    }
+    if (!ended) {
+        fprintf(stderr, "%s: file was cut short\n", path);
+    }
+    return true;
+}
+
+/*******************************************************
+ * @brief Longest time (bucket upper bound, ticks) that fraction of the passes stayed under
+ */
+static double percentile(const ProbeLine &probe, double fraction) {
+    unsigned long seen = 0;
+    for (int b = 0; b < PROBE_BUCKETS; b++) {
+        seen += probe.buckets[b];
+        if (seen >= fraction * probe.count) {
+            double bound = b ? (double)(1ULL << b) - 1 : 0;
+            return (bound < probe.max) ? bound : probe.max;
+        }
+    }
+    return probe.max;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = PROBES_FILE;
+    bool histograms = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-h")) {
+            histograms = true;
+        } else if (argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "usage: %s [-h] [probes.txt]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    unsigned long ticksPerSec = 0;
+    std::vector<ProbeLine> probes;
+    if (!read_probes(path, ticksPerSec, probes) || !ticksPerSec) {
+        return 2;
+    }
+    double usPerTick = 1e6 / ticksPerSec;
+
+    printf("%lu ticks per second. Times in microseconds, percentiles are histogram bucket bounds.\n\n", ticksPerSec);
+    printf("%-10s %10s %10s %10s %10s %10s %10s %10s\n", "probe", "passes", "mean", "min", "p50", "p90", "p99", "max");
+    for (size_t i = 0; i < probes.size(); i++) {
+        const ProbeLine &probe = probes[i];
+        if (!probe.count) {
+            printf("%-10s %10s\n", probe.name.c_str(), "-");
+            continue;
+        }
+        printf("%-10s %10lu %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", probe.name.c_str(), probe.count, probe.mean * usPerTick,
+               probe.min * usPerTick, percentile(probe, 0.5) * usPerTick, percentile(probe, 0.9) * usPerTick,
+               percentile(probe, 0.99) * usPerTick, probe.max * usPerTick);
+    }
+
+    for (size_t i = 0; histograms && (i < probes.size()); i++) {
+        const ProbeLine &probe = probes[i];
+        unsigned long largest = 0;
+        for (int b = 0; b < PROBE_BUCKETS; b++) {
+            largest = (probe.buckets[b] > largest) ? probe.buckets[b] : largest;
+        }
+        if (!largest) {
+            continue;
+        }
+
+        printf("\n%s\n", probe.name.c_str());
+        for (int b = 0; b < PROBE_BUCKETS; b++) {
+            if (!probe.buckets[b]) {
+                continue;
+            }
+            double low = b ? (double)(1ULL << (b - 1)) : 0;
+            int bar = (int)((double)probe.buckets[b] * REPORT_BAR_WIDTH / largest + 0.5);
+            printf("  >= %10.3f us %10lu %s\n", low * usPerTick, probe.buckets[b], std::string(bar ? bar : 1, '#').c_str());
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,463 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*          Sensor trace replay tool         */
+/*                                           */
+/*  Feeds a trace recorded on the robot      */
+/*  (sensor_trace.h) back into the course    */
+/*  code from main.cpp and reports the first */
+/*  command that differs from the recording. */
+/*                                           */
+/*  Usage: ./replay trace.txt [more.txt ...] */
+/*  Exit code is 0 if every trace matched,   */
+/*  1 if any diverged, 2 if one can't load.  */
+/*  That makes it usable with git bisect run.*/
+/*  Each trace runs in its own process, so   */
+/*  nothing one run learned or buffered      */
+/*  carries into the next.                   */
+/*********************************************/
+
+#include "feh_host.h"
+#include "../arm.h"
+#include "../sensor_trace_format.h"
+#include "../track_width.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+/************************************************/
+// Course code from main.cpp
+void run_course(int courseNumber);
+
+extern float RPS_0_Degrees, RPS_90_Degrees, RPS_180_Degrees, RPS_270_Degrees;
+extern float RPS_Top_Level_X_Reference, RPS_Top_Level_Y_Reference;
+extern float startX, startY, startHeading;
+extern int startIceCream;
+extern TrackWidths trackWidths;
+extern ArmModel armModel;
+
+// Globals that can be restored from STATE lines. Names match the sensor_trace_state() calls in main().
+struct ReplayState {
+    const char *name;
+    float *value;
+    int *intValue; // For int globals instead
+};
+
+static ReplayState replayStates[] = {
+    { "RPS_0_Degrees", &RPS_0_Degrees },
+    { "RPS_90_Degrees", &RPS_90_Degrees },
+    { "RPS_180_Degrees", &RPS_180_Degrees },
+    { "RPS_270_Degrees", &RPS_270_Degrees },
+    { "RPS_Top_Level_X_Reference", &RPS_Top_Level_X_Reference },
+    { "RPS_Top_Level_Y_Reference", &RPS_Top_Level_Y_Reference },
+    { "startIceCream", 0, &startIceCream }, // Read before the start light, so not in the inputs
+    { "startX", &startX },
+    { "startY", &startY },
+    { "startHeading", &startHeading },
+    { "trackWidths.width[0][0]", &trackWidths.width[0][0] }, // From the SD card, so not in the inputs
+    { "trackWidths.width[0][1]", &trackWidths.width[0][1] },
+    { "trackWidths.width[1][0]", &trackWidths.width[1][0] },
+    { "trackWidths.width[1][1]", &trackWidths.width[1][1] },
+    { "trackWidths.samples[0][0]", 0, &trackWidths.samples[0][0] },
+    { "trackWidths.samples[0][1]", 0, &trackWidths.samples[0][1] },
+    { "trackWidths.samples[1][0]", 0, &trackWidths.samples[1][0] },
+    { "trackWidths.samples[1][1]", 0, &trackWidths.samples[1][1] },
+    { "armModel.base.minPulse", &armModel.base.minPulse }, // Servo calibration file
+    { "armModel.base.maxPulse", &armModel.base.maxPulse },
+    { "armModel.base.speed", &armModel.base.speed },
+    { "armModel.onArm.minPulse", &armModel.onArm.minPulse },
+    { "armModel.onArm.maxPulse", &armModel.onArm.maxPulse },
+    { "armModel.onArm.speed", &armModel.onArm.speed },
+};
+
+/************************************************/
+// Loaded trace file
+struct ReplayTrace {
+    int courseNumber = 0;
+    std::vector<std::pair<std::string, double> > states;
+    std::vector<SensorTraceRecord> records;
+    bool overflowed = false;
+    bool complete = false; // END line was found
+};
+
+// Thrown out of the course code to stop a replay
+struct ReplayStop {
+    bool diverged;
+    std::string reason;
+};
+
+/*******************************************************
+ * @brief Converts bits written by the recorder back into a double
+ */
+static double bits_to_double(unsigned long long bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/*******************************************************
+ * @brief Describes a record for reports, e.g. "Motor2 SetPercent(45)"
+ */
+static std::string describe(int kind, int channel, double value) {
+    static const char *names[TRACE_KIND_COUNT] = {
+        "TimeNow", "Encoder Counts", "Analog Value", "RPS.Heading", "RPS.X", "RPS.Y", "RPS.Time",
+        "RPS.CurrentRegionLetter", "RPS.GetIceCream", "LCD.Touch",
+        "SetPercent", "Stop", "SetDegree", "Sleep", "ResetCounts"
+    };
+
+    char text[96];
+    const char *name = ((kind >= 0) && (kind < TRACE_KIND_COUNT)) ? names[kind] : "?";
+
+    switch (kind) {
+    case TRACE_MOTOR_PERCENT:
+    case TRACE_MOTOR_STOP:
+        snprintf(text, sizeof(text), "Motor%d %s(%g)", channel, name, value);
+        break;
+    case TRACE_SERVO_DEGREE:
+        snprintf(text, sizeof(text), "Servo%d %s(%g)", channel, name, value);
+        break;
+    case TRACE_ENCODER_COUNTS:
+    case TRACE_ENCODER_RESET:
+    case TRACE_ANALOG_VALUE:
+        snprintf(text, sizeof(text), "P%d_%d %s(%g)", channel / 8, channel % 8, name, value);
+        break;
+    default:
+        snprintf(text, sizeof(text), "%s(%g)", name, value);
+        break;
+    }
+
+    return text;
+}
+
+/*******************************************************
+ * @brief Reads a trace file written by the robot
+ *
+ * @return bool true if the file could be read
+ */
+static bool load_trace(const char *path, ReplayTrace &trace) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "%s: can't open file\n", path);
+        return false;
+    }
+
+    char line[256];
+    int version = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        char name[128];
+        int kind, channel, overflowed;
+        unsigned int count;
+        unsigned long long bits;
+        unsigned long numRecords;
+
+        if (sscanf(line, "SENSOR_TRACE %d", &version) == 1) {
+            continue;
+        } else if (sscanf(line, "COURSE %d", &trace.courseNumber) == 1) {
+            continue;
+        } else if (sscanf(line, "STATE %127s %llx", name, &bits) == 2) {
+            trace.states.push_back(std::make_pair(std::string(name), bits_to_double(bits)));
+        } else if (sscanf(line, "END %lu %d", &numRecords, &overflowed) == 2) {
+            trace.overflowed = overflowed;
+            trace.complete = true;
+        } else if (sscanf(line, "%d %d %u %llx", &kind, &channel, &count, &bits) == 4) {
+            if ((kind < 0) || (kind >= TRACE_KIND_COUNT) || (channel < 0) || (channel >= SENSOR_TRACE_CHANNELS)) {
+                fprintf(stderr, "%s: bad record: %s", path, line);
+                fclose(file);
+                return false;
+            }
+
+            SensorTraceRecord record;
+            record.kind = kind;
+            record.channel = channel;
+            record.spare = 0;
+            record.count = count;
+            record.value = bits_to_double(bits);
+            trace.records.push_back(record);
+        }
+    }
+
+    fclose(file);
+
+    if (version != SENSOR_TRACE_VERSION) {
+        fprintf(stderr, "%s: not a version %d sensor trace\n", path, SENSOR_TRACE_VERSION);
+        return false;
+    }
+
+    // A trace cut short (robot turned off before the END line) replays like an overflowed one
+    if (!trace.complete) {
+        trace.overflowed = true;
+    }
+
+    return true;
+}
+
+/*******************************************************
+ * @brief Hardware that answers every input with the recorded value and checks
+ * every output against the recorded command.
+ */
+class ReplayHardware : public HostHardware {
+public:
+    ReplayHardware(const ReplayTrace &trace) : trace(trace) {
+        // Splits inputs into one queue per channel, outputs stay in order
+        for (size_t i = 0; i < trace.records.size(); i++) {
+            const SensorTraceRecord &record = trace.records[i];
+            if (record.kind < TRACE_FIRST_OUTPUT) {
+                inputs[record.kind][record.channel].push_back(record);
+            } else {
+                outputs.push_back(record);
+            }
+        }
+
+        for (int kind = 0; kind < TRACE_FIRST_OUTPUT; kind++) {
+            for (int channel = 0; channel < SENSOR_TRACE_CHANNELS; channel++) {
+                position[kind][channel] = 0;
+                used[kind][channel] = 0;
+            }
+        }
+    }
+
+    unsigned int inputsRead = 0;
+    size_t outputsMatched = 0;
+    double firstTime = -1, lastTime = -1;
+
+    /*******************************************************
+     * @brief Inputs recorded but never read (the course stopped early)
+     */
+    unsigned long unreadInputs() const {
+        unsigned long unread = 0;
+        for (int kind = 0; kind < TRACE_FIRST_OUTPUT; kind++) {
+            for (int channel = 0; channel < SENSOR_TRACE_CHANNELS; channel++) {
+                const std::vector<SensorTraceRecord> &queue = inputs[kind][channel];
+                for (size_t i = position[kind][channel]; i < queue.size(); i++) {
+                    unread += queue[i].count;
+                }
+                unread -= used[kind][channel];
+            }
+        }
+        return unread;
+    }
+
+    size_t unmatchedOutputs() const { return outputs.size() - outputsMatched; }
+
+    double TimeNow() override {
+        double time = input(TRACE_TIME_NOW, 0);
+        if (firstTime < 0) {
+            firstTime = time;
+        }
+        lastTime = time;
+        return time;
+    }
+
+    // The last recorded time, without using up any input
+    double Clock() override { return (lastTime >= 0) ? lastTime : 0; }
+
+    void Sleep(double seconds) override { output(TRACE_SLEEP, 0, seconds); }
+
+    int EncoderCounts(int pin) override { return (int)input(TRACE_ENCODER_COUNTS, pin); }
+    float AnalogValue(int pin) override { return (float)input(TRACE_ANALOG_VALUE, pin); }
+    float RPSHeading() override { return (float)input(TRACE_RPS_HEADING, 0); }
+    float RPSX() override { return (float)input(TRACE_RPS_X, 0); }
+    float RPSY() override { return (float)input(TRACE_RPS_Y, 0); }
+    int RPSTime() override { return (int)input(TRACE_RPS_TIME, 0); }
+    char RPSRegion() override { return (char)input(TRACE_RPS_REGION, 0); }
+    int RPSIceCream() override { return (int)input(TRACE_RPS_ICE_CREAM, 0); }
+
+    bool Touch(int *x, int *y) override {
+        int touch = (int)input(TRACE_LCD_TOUCH, 0);
+        if (touch < 0) {
+            return false;
+        }
+        *x = touch % 320;
+        *y = touch / 320;
+        return true;
+    }
+
+    void EncoderReset(int pin) override { output(TRACE_ENCODER_RESET, pin, 0); }
+    void MotorPercent(int port, float percent) override { output(TRACE_MOTOR_PERCENT, port, percent); }
+    void MotorStop(int port) override { output(TRACE_MOTOR_STOP, port, 0); }
+    void ServoDegree(int port, float degree) override { output(TRACE_SERVO_DEGREE, port, degree); }
+
+private:
+    const ReplayTrace &trace;
+    std::vector<SensorTraceRecord> inputs[TRACE_FIRST_OUTPUT][SENSOR_TRACE_CHANNELS];
+    std::vector<SensorTraceRecord> outputs;
+
+    // Current record and reads used from it for every input channel
+    size_t position[TRACE_FIRST_OUTPUT][SENSOR_TRACE_CHANNELS];
+    unsigned int used[TRACE_FIRST_OUTPUT][SENSOR_TRACE_CHANNELS];
+
+    /*******************************************************
+     * @brief Returns the next recorded value of an input
+     */
+    double input(int kind, int channel) {
+        std::vector<SensorTraceRecord> &queue = inputs[kind][channel];
+        size_t &at = position[kind][channel];
+
+        if (at >= queue.size()) {
+            if (trace.overflowed) {
+                throw ReplayStop{ false, "recording ends here (robot buffer overflowed or file was cut short)" };
+            }
+            throw ReplayStop{ true, "course read " + describe(kind, channel, 0) + " more times than recorded (input #" + std::to_string(inputsRead) + ")" };
+        }
+
+        double value = queue[at].value;
+        if (++used[kind][channel] >= queue[at].count) {
+            used[kind][channel] = 0;
+            at++;
+        }
+
+        inputsRead++;
+        return value;
+    }
+
+    /*******************************************************
+     * @brief Checks a command against the next recorded one
+     */
+    void output(int kind, int channel, double value) {
+        if (outputsMatched >= outputs.size()) {
+            if (trace.overflowed) {
+                throw ReplayStop{ false, "recording ends here (robot buffer overflowed or file was cut short)" };
+            }
+            throw ReplayStop{ true, "course gave " + describe(kind, channel, value) + " after the recorded run had ended" };
+        }
+
+        const SensorTraceRecord &expected = outputs[outputsMatched];
+        if ((expected.kind != kind) || (expected.channel != channel) || (expected.value != value) || (expected.count != inputsRead)) {
+            char where[128];
+            snprintf(where, sizeof(where), "command #%zu: recorded after input #%u, course gave after input #%u",
+                     outputsMatched, expected.count, inputsRead);
+            throw ReplayStop{ true, std::string(where) + "\n    recorded: " + describe(expected.kind, expected.channel, expected.value) +
+                                    "\n    course:   " + describe(kind, channel, value) };
+        }
+
+        outputsMatched++;
+    }
+};
+
+/*******************************************************
+ * @brief Replays one trace and prints the result
+ *
+ * @return int 0 if it matched, 1 if it diverged, 2 if it couldn't be loaded
+ */
+static int replay_trace(const char *path) {
+    ReplayTrace trace;
+    if (!load_trace(path, trace)) {
+        return 2;
+    }
+
+    // Restores the globals the course was run with
+    for (size_t i = 0; i < trace.states.size(); i++) {
+        bool found = false;
+        for (size_t j = 0; j < sizeof(replayStates) / sizeof(replayStates[0]); j++) {
+            if (trace.states[i].first == replayStates[j].name) {
+                if (replayStates[j].intValue) {
+                    *replayStates[j].intValue = (int)trace.states[i].second;
+                } else {
+                    *replayStates[j].value = (float)trace.states[i].second;
+                }
+                found = true;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "%s: warning: unknown state %s\n", path, trace.states[i].first.c_str());
+        }
+    }
+
+    ReplayHardware hardware(trace);
+    host_set_hardware(&hardware);
+
+    bool diverged = false;
+    bool cutShort = false;
+    std::string reason;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    try {
+        run_course(trace.courseNumber);
+
+        if (hardware.unmatchedOutputs() > 0) {
+            diverged = true;
+            reason = "course finished but " + std::to_string(hardware.unmatchedOutputs()) + " more recorded commands were never given";
+        }
+    } catch (const ReplayStop &stop) {
+        diverged = stop.diverged;
+        cutShort = !stop.diverged;
+        reason = stop.reason;
+    }
+    double hostSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    host_set_hardware(0);
+
+    double runSeconds = (hardware.firstTime >= 0) ? (hardware.lastTime - hardware.firstTime) : 0;
+
+    printf("%s: %s, course %d, %u inputs, %zu commands matched, %.2f s of run replayed in %.4f s",
+           path, diverged ? "DIVERGED" : (cutShort ? "MATCHED (trace incomplete)" : "MATCHED"),
+           trace.courseNumber, hardware.inputsRead, hardware.outputsMatched, runSeconds, hostSeconds);
+    if (hostSeconds > 0) {
+        printf(" (%.0fx real time)", runSeconds / hostSeconds);
+    }
+    printf("\n");
+
+    if (!reason.empty()) {
+        printf("  %s\n", reason.c_str());
+    }
+    if (!diverged && !cutShort && (hardware.unreadInputs() > 0)) {
+        printf("  note: %lu recorded inputs were never read\n", hardware.unreadInputs());
+    }
+
+    return diverged ? 1 : 0;
+}
+
+/*******************************************************
+ * @brief Replays one trace in a child process. The course code keeps what it
+ * learns and records in globals (distance scale, track width chains, PID error
+ * sums, timeline and telemetry buffers), and only the traced STATEs are
+ * restored, so a run in the same process would start from the last one's.
+ *
+ * @return int Same as replay_trace(), 2 if the child couldn't run or crashed
+ */
+static int replay_trace_alone(const char *path) {
+    // Anything still buffered would be printed by both processes
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        return 2;
+    }
+    if (child == 0) {
+        int result = replay_trace(path);
+        fflush(stdout);
+        fflush(stderr);
+        _exit(result);
+    }
+
+    int status;
+    if ((waitpid(child, &status, 0) < 0) || !WIFEXITED(status)) {
+        fprintf(stderr, "%s: replay crashed\n", path);
+        return 2;
+    }
+    return WEXITSTATUS(status);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s trace.txt [more traces...]\n", argv[0]);
+        return 2;
+    }
+
+    int worst = 0;
+    for (int i = 1; i < argc; i++) {
+        int result = replay_trace_alone(argv[i]);
+        if (result > worst) {
+            worst = result;
+        }
+    }
+
+    return worst;
+}
@@ -0,0 +1,270 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*        Simulated robot (host, impl)       */
+/*********************************************/
+
+#include "sim_robot.h"
+
+#include <cmath>
+
+#define SIM_PI 3.14159265358979
+
+SimRobot::SimRobot(const SimParams &params) : params(params) {
+    time = 0;
+
+    for (int i = 0; i < SIM_SERVO_PORTS; i++) {
+        servoDegree[i] = 0;
+    }
+
+    rpsAvailable = true;
+    cdsValue = 0.3f; // Red jukebox light / start light on
+    touching = true; // Every touch wait passes straight away
+    iceCream = 0;
+
+    course = 0;
+    pushing = false;
+
+    place(SIM_START_X, SIM_START_Y, SIM_START_HEADING);
+}
+
+void SimRobot::place(double newX, double newY, double newHeading) {
+    x = newX;
+    y = newY;
+    heading = newHeading;
+
+    for (int i = 0; i < 2; i++) {
+        wheelSpeed[i] = 0;
+        motorPercent[i] = 0;
+        encoderCounts[i] = 0;
+    }
+
+    // New run on the course
+    courseState = CourseState();
+    pushing = false;
+
+    stopTarget = -1;
+    stopReachedTime = -1;
+    stopCutTime = -1;
+    stopReachedCounts = -1;
+    stopCutCounts = -1;
+
+    rpsUpdated = -1;
+    update_rps();
+}
+
+double SimRobot::steady_speed(double percent, int wheel) const {
+    if (params.useMotorModels) {
+        return motor_model_speed(params.motors[wheel][(percent < 0) ? DRIVE_BACKWARD : DRIVE_FORWARD], percent);
+    }
+
+    // Motors running backwards are weaker (what BACKWARDS_CALIBRATOR makes up for)
+    if (percent < 0) {
+        percent = fmin(percent + params.backwardsLoss, 0);
+    }
+    return percent * params.inchesPerSecPerPercent;
+}
+
+void SimRobot::advance(double seconds) {
+    while (seconds > 0) {
+        double dt = fmin(stop_step(fmin(seconds, SIM_MAX_STEP)), seconds);
+        seconds -= dt;
+        time += dt;
+
+        double headingRad = heading * SIM_PI / 180;
+
+        // Driving up the ramp takes some of each running motor's percent, driving down adds it
+        double grade = course ? course->ramp_grade(x, y) : 0;
+        double rampPercent = course ? course->rampPercent * grade * sin(headingRad) : 0;
+
+        // First order response of each wheel to its motor
+        double blend = 1 - exp(-dt / params.motorTimeConstant);
+        for (int i = 0; i < 2; i++) {
+            double percent = (motorPercent[i] != 0) ? motorPercent[i] - rampPercent : 0;
+            double wheelBlend = blend;
+            if (params.useMotorModels) {
+                // Coasting follows the way the wheel is still turning
+                double way = (percent != 0) ? percent : wheelSpeed[i];
+                wheelBlend = 1 - exp(-dt / params.motors[i][(way < 0) ? DRIVE_BACKWARD : DRIVE_FORWARD].timeConstant);
+            }
+            wheelSpeed[i] += (steady_speed(percent, i) - wheelSpeed[i]) * wheelBlend;
+        }
+
+        // Differential drive kinematics. On the ramp the wheels travel along the slope, so less of it shows up in x/y.
+        double speed = (wheelSpeed[0] + wheelSpeed[1]) / 2;
+        double tilt = 1 - (1 - sqrt(1 - grade * grade)) * fabs(sin(headingRad));
+        double dx = speed * cos(headingRad) * dt * tilt;
+        double dy = speed * sin(headingRad) * dt * tilt;
+
+        // Pushing into something solid, the wheels slip (encoders keep counting) but the robot stays put
+        pushing = course && course->blocked(courseState, x, y, x + dx, y + dy);
+        if (pushing) {
+            dx = 0;
+            dy = 0;
+            courseState.stalledTime += dt;
+        }
+
+        // Encoders count both directions the same way
+        for (int i = 0; i < 2; i++) {
+            encoderCounts[i] += fabs(wheelSpeed[i]) * dt * params.countsPerInch;
+        }
+
+        double turnRate = (wheelSpeed[1] - wheelSpeed[0]) / params.trackWidth; // rad/s CCW
+        x += dx;
+        y += dy;
+        heading = fmod(heading + turnRate * dt * 180 / SIM_PI + 360, 360);
+
+        if (course) {
+            double base = servoDegree[SIM_BASE_SERVO_PORT];
+            course->interact(courseState, time, x, y, heading, pushing, base, servoDegree[SIM_ARM_SERVO_PORT], base);
+        }
+
+        stop_check();
+    }
+
+    update_rps();
+}
+
+void SimRobot::update_rps() {
+    if ((rpsUpdated < 0) || (time - rpsUpdated >= params.rpsPeriod)) {
+        rpsX = x;
+        rpsY = y;
+        rpsHeading = heading;
+        rpsUpdated = time;
+    }
+}
+
+/************************************************/
+// HostHardware
+
+double SimRobot::TimeNow() {
+    advance(params.timeReadTime);
+    return time;
+}
+
+void SimRobot::Sleep(double seconds) {
+    advance(seconds);
+}
+
+int SimRobot::EncoderCounts(int pin) {
+    advance(params.encoderReadTime);
+    return (int)encoderCounts[(pin == SIM_RIGHT_ENCODER_PIN) ? 1 : 0];
+}
+
+float SimRobot::AnalogValue(int pin) {
+    advance(params.analogReadTime);
+    return cdsValue;
+}
+
+float SimRobot::RPSHeading() {
+    advance(params.rpsReadTime);
+    return rpsAvailable ? rpsHeading : -1;
+}
+
+float SimRobot::RPSX() {
+    advance(params.rpsReadTime);
+    return rpsAvailable ? rpsX : -1;
+}
+
+float SimRobot::RPSY() {
+    advance(params.rpsReadTime);
+    return rpsAvailable ? rpsY : -1;
+}
+
+int SimRobot::RPSTime() {
+    advance(params.rpsReadTime);
+    return (int)time;
+}
+
+int SimRobot::RPSIceCream() {
+    advance(params.rpsReadTime);
+    return iceCream;
+}
+
+bool SimRobot::Touch(int *touchX, int *touchY) {
+    advance(params.touchReadTime);
+    if (touching) {
+        *touchX = 160;
+        *touchY = 120;
+    }
+    return touching;
+}
+
+void SimRobot::EncoderReset(int pin) {
+    encoderCounts[(pin == SIM_RIGHT_ENCODER_PIN) ? 1 : 0] = 0;
+}
+
+void SimRobot::MotorPercent(int port, float percent) {
+    motorPercent[(port == SIM_RIGHT_MOTOR_PORT) ? 1 : 0] = percent;
+}
+
+void SimRobot::MotorStop(int port) {
+    motorPercent[(port == SIM_RIGHT_MOTOR_PORT) ? 1 : 0] = 0;
+    stop_check();
+}
+
+void SimRobot::ServoDegree(int port, float degree) {
+    if ((port >= 0) && (port < SIM_SERVO_PORTS)) {
+        double lastBase = servoDegree[SIM_BASE_SERVO_PORT];
+        servoDegree[port] = degree;
+
+        if (course) {
+            course->interact(courseState, time, x, y, heading, pushing, servoDegree[SIM_BASE_SERVO_PORT],
+                             servoDegree[SIM_ARM_SERVO_PORT], lastBase);
+        }
+    }
+}
+
+void SimRobot::EncoderStopArm(int targetCounts) {
+    stopTarget = targetCounts;
+    stopReachedTime = -1;
+    stopCutTime = -1;
+    stopReachedCounts = -1;
+    stopCutCounts = -1;
+    stop_check();
+}
+
+double SimRobot::EncoderStopLatency() {
+    return ((stopReachedTime >= 0) && (stopCutTime >= 0)) ? stopCutTime - stopReachedTime : -1;
+}
+
+/************************************************/
+// Encoder stop
+
+int SimRobot::stop_counts() const {
+    return (int)encoderCounts[0] + (int)encoderCounts[1];
+}
+
+double SimRobot::stop_step(double dt) const {
+    if (stopTarget < 0) {
+        return dt;
+    }
+
+    // Encoders reach the target on an edge, so steps end on the next edge of either one
+    if (stopReachedTime < 0) {
+        for (int i = 0; i < 2; i++) {
+            double rate = fabs(wheelSpeed[i]) * params.countsPerInch;
+            if (rate > 0) {
+                dt = fmin(dt, fmax((floor(encoderCounts[i]) + 1 - encoderCounts[i]) / rate, SIM_MIN_STEP));
+            }
+        }
+    }
+    return dt;
+}
+
+void SimRobot::stop_check() {
+    if (stopTarget < 0) {
+        return;
+    }
+
+    if ((stopReachedTime < 0) && (stop_counts() >= stopTarget)) {
+        stopReachedTime = time;
+        stopReachedCounts = encoderCounts[0] + encoderCounts[1];
+    }
+
+    if ((stopReachedTime >= 0) && (stopCutCounts < 0)) {
+        if ((motorPercent[0] == 0) && (motorPercent[1] == 0)) {
+            stopCutTime = time;
+            stopCutCounts = encoderCounts[0] + encoderCounts[1];
+        }
+    }
+}
@@ -0,0 +1,147 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*           Simulated robot (host)          */
+/*                                           */
+/*  A HostHardware that drives a simple      */
+/*  model of our robot on a virtual clock.   */
+/*  Time only moves when the course code     */
+/*  reads something or sleeps, so runs are   */
+/*  repeatable and much faster than real.    */
+/*********************************************/
+
+#ifndef SIM_ROBOT_H
+#define SIM_ROBOT_H
+
+#include "course_model.h"
+#include "feh_host.h"
+#include "../drive_model.h"
+
+/************************************************/
+// Definitions
+
+// Ports/pins main.cpp uses
+#define SIM_LEFT_ENCODER_PIN 25 // FEHIO::P3_1
+#define SIM_RIGHT_ENCODER_PIN 26 // FEHIO::P3_2
+#define SIM_LEFT_MOTOR_PORT 3 // FEHMotor::Motor3
+#define SIM_RIGHT_MOTOR_PORT 2 // FEHMotor::Motor2
+#define SIM_CDS_PIN 7 // FEHIO::P0_7
+#define SIM_SERVO_PORTS 8
+#define SIM_BASE_SERVO_PORT 5 // FEHServo::Servo5
+#define SIM_ARM_SERVO_PORT 7 // FEHServo::Servo7
+
+// Starting pose worked back from the opening moves of FINAL_COMP (RPS coords, degrees CCW from east)
+#define SIM_START_X 27.0
+#define SIM_START_Y 5.9
+#define SIM_START_HEADING 135.0
+
+#define SIM_MAX_STEP 0.001 // Longest time step the model integrates over in seconds
+#define SIM_MIN_STEP 1e-7 // Shortest step, used when a step is cut short to land on an encoder edge
+
+/*******************************************************
+ * @brief Parameters of the robot model. Defaults match the constants in main.cpp.
+ */
+struct SimParams {
+    double countsPerInch = 318 / (2 * 3.14159265 * 1.25); // Real encoder counts per inch of wheel travel
+    double trackWidth = 7.95; // Real distance between the wheels in inches
+    double backwardsLoss = 2.4; // Percent lost by a motor running backwards
+    double inchesPerSecPerPercent = 0.25; // Wheel speed at steady state for each motor percent
+    double motorTimeConstant = 0.08; // Seconds for a wheel to reach 63% of a new speed
+
+    // Fitted motors from a drive model file (simulate --drive), [left/right][forward/backward].
+    // When set they stand in for the three numbers above.
+    bool useMotorModels = false;
+    MotorModel motors[DRIVE_SIDES][DRIVE_DIRECTIONS];
+
+    // Time the Proteus takes for each call (seconds). Moves the virtual clock in busy loops.
+    double encoderReadTime = 20e-6;
+    double analogReadTime = 30e-6;
+    double rpsReadTime = 10e-6;
+    double timeReadTime = 5e-6;
+    double touchReadTime = 200e-6;
+
+    double rpsPeriod = 0.1; // Seconds between RPS updates
+};
+
+/*******************************************************
+ * @brief Differential drive robot on a virtual clock
+ */
+class SimRobot : public HostHardware {
+public:
+    SimRobot(const SimParams &params = SimParams());
+
+    SimParams params;
+
+    // State
+    double time; // Virtual seconds since start
+    double x, y, heading; // Pose of the wheel axis center (inches, inches, degrees CCW from east)
+    double wheelSpeed[2]; // Left, right in inches per second
+    double motorPercent[2]; // Left, right as last commanded
+    double encoderCounts[2]; // Left, right since last reset
+    double servoDegree[SIM_SERVO_PORTS];
+
+    // Environment
+    bool rpsAvailable; // false acts like a dead zone (RPS returns -1)
+    float cdsValue; // Value the CdS cell reads
+    bool touching; // true if the screen is held down
+    int iceCream; // 0 vanilla, 1 twist, 2 chocolate
+
+    // Walls, fixtures and the ramp. 0 (the default) drives on an empty plane.
+    const CourseModel *course;
+    CourseState courseState;
+    bool pushing; // true if the last step pushed into something solid
+
+    // Encoder stop the course code armed (EncoderStopArm)
+    int stopTarget; // Sum of both drive encoders, -1 when nothing is armed
+    double stopReachedTime; // When the counts got to the target, -1 before
+    double stopCutTime; // When both drive motors stopped after that, -1 before
+    double stopReachedCounts; // Sum of both drive encoders (with fractions of a count) at stopReachedTime
+    double stopCutCounts; // Same when the motors stopped, -1 before
+
+    /*******************************************************
+     * @brief Puts the robot at a pose, stopped, with encoders and course state cleared
+     */
+    void place(double x, double y, double heading);
+
+    /*******************************************************
+     * @brief Moves the virtual clock and the robot forward
+     *
+     * @param seconds Time to simulate
+     */
+    void advance(double seconds);
+
+    /*******************************************************
+     * @brief Wheel speed a motor settles at for a percent
+     *
+     * @param wheel 0 for left, 1 for right
+     */
+    double steady_speed(double percent, int wheel) const;
+
+    // HostHardware
+    double TimeNow() override;
+    void Sleep(double seconds) override;
+    int EncoderCounts(int pin) override;
+    float AnalogValue(int pin) override;
+    float RPSHeading() override;
+    float RPSX() override;
+    float RPSY() override;
+    int RPSTime() override;
+    int RPSIceCream() override;
+    bool Touch(int *x, int *y) override;
+    void EncoderReset(int pin) override;
+    void MotorPercent(int port, float percent) override;
+    void MotorStop(int port) override;
+    void ServoDegree(int port, float degree) override;
+    void EncoderStopArm(int targetCounts) override;
+    double EncoderStopLatency() override;
+
+private:
+    // Pose the RPS last reported
+    double rpsX, rpsY, rpsHeading, rpsUpdated;
+
+    void update_rps();
+    int stop_counts() const;
+    double stop_step(double dt) const;
+    void stop_check();
+};
+
+#endif
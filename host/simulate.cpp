@@ -0,0 +1,164 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*         Full course simulation            */
+/*                                           */
+/*  Runs main() from main.cpp on the         */
+/*  simulated robot, then converts the       */
+/*  timeline it wrote into a Chrome trace.   */
+/*  The robot drives on the course model     */
+/*  (course_model.h) unless --no-course.     */
+/*  Also prints how much drawing the run did */
+/*  and can save screenshots of the LCD.     */
+/*  With --drive, the wheels follow the      */
+/*  floor motors of a drive model file from  */
+/*  the SYSID_DRIVE mode (drive_model.h).    */
+/*  The course is picked without the start   */
+/*  menu (-c, the final one unless given),   */
+/*  so its timeout isn't in the run's time.  */
+/*  The self test is skipped too unless      */
+/*  --self-test.                             */
+/*                                           */
+/*  Usage: ./simulate [-o timeline.json]     */
+/*             [--no-course] [-s screen.ppm] */
+/*             [--screens seconds]           */
+/*             [--drive drive.txt] [-c num]  */
+/*             [--self-test]                 */
+/*********************************************/
+
+#include "lcd_frame.h"
+#include "sim_robot.h"
+#include "timeline_export.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// main() from main.cpp
+int course_main();
+
+// From main.cpp
+extern int menuCourse;
+extern bool selfTestAtStart;
+
+// Where main.cpp writes its timeline (TIMELINE_FILE)
+#define SIMULATE_TIMELINE_FILE "timeline.txt"
+#define SIMULATE_TRACK_WIDTH_FILE "track.txt" // TRACK_WIDTH_FILE
+#define SIMULATE_DEFAULT_COURSE 10 // FINAL_COMP
+
+/*******************************************************
+ * @brief Simulated robot that saves screen_NNN.ppm every so many robot seconds.
+ * Checked whenever the course code reads the time or sleeps.
+ */
+class ScreenshotRobot : public SimRobot {
+public:
+    double period = 0; // Seconds between screenshots, 0 for none
+    int screenshots = 0;
+
+    double TimeNow() override {
+        double now = SimRobot::TimeNow();
+        check();
+        return now;
+    }
+
+    void Sleep(double seconds) override {
+        SimRobot::Sleep(seconds);
+        check();
+    }
+
+private:
+    void check() {
+        if ((period > 0) && (time >= screenshots * period)) {
+            char path[32];
+            snprintf(path, sizeof(path), "screen_%03d.ppm", screenshots++);
+            lcd_write_ppm(path);
+        }
+    }
+};
+
+int main(int argc, char *argv[]) {
+    const char *jsonPath = "timeline.json";
+    const char *screenPath = 0;
+    bool useCourse = true;
+    double screenPeriod = 0;
+    const char *drivePath = 0;
+    int courseNumber = SIMULATE_DEFAULT_COURSE;
+    bool selfTest = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-o") && (i + 1 < argc)) {
+            jsonPath = argv[++i];
+        } else if (!strcmp(argv[i], "--no-course")) {
+            useCourse = false;
+        } else if (!strcmp(argv[i], "-s") && (i + 1 < argc)) {
+            screenPath = argv[++i];
+        } else if (!strcmp(argv[i], "--screens") && (i + 1 < argc)) {
+            screenPeriod = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--drive") && (i + 1 < argc)) {
+            drivePath = argv[++i];
+        } else if (!strcmp(argv[i], "-c") && (i + 1 < argc)) {
+            courseNumber = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--self-test")) {
+            selfTest = true;
+        } else {
+            fprintf(stderr,
+                    "usage: %s [-o timeline.json] [--no-course] [-s screen.ppm] [--screens seconds] [--drive drive.txt] [-c course] "
+                    "[--self-test]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    CourseModel course;
+    ScreenshotRobot robot;
+    robot.period = screenPeriod;
+    if (useCourse) {
+        robot.course = &course;
+    }
+
+    // The ramp's grade is still the course model's, so only the floor motors are used
+    if (drivePath) {
+        DriveModel drive;
+        if (!drive_model_load(drivePath, drive)) {
+            fprintf(stderr, "Can't read a drive model from %s\n", drivePath);
+            return 1;
+        }
+        for (int side = 0; side < DRIVE_SIDES; side++) {
+            for (int direction = 0; direction < DRIVE_DIRECTIONS; direction++) {
+                robot.params.motors[side][direction] = drive.motor[DRIVE_FLOOR][side][direction];
+            }
+        }
+        robot.params.useMotorModels = true;
+    }
+    host_set_hardware(&robot);
+
+    // Every run starts from ROBOT_WIDTH, not what the last one learned, so runs can be compared
+    remove(SIMULATE_TRACK_WIDTH_FILE);
+    menuCourse = courseNumber;
+    selfTestAtStart = selfTest;
+    course_main();
+    host_set_hardware(0);
+
+    printf("Simulated run took %.2f s, ended at (%.2f, %.2f) heading %.1f\n", robot.time, robot.x, robot.y, robot.heading);
+    if (useCourse) {
+        course.print(robot.courseState);
+    }
+
+    printf("\n");
+    lcd_print_stats(stdout, robot.time);
+    if (screenPath && !lcd_write_ppm(screenPath)) {
+        fprintf(stderr, "%s: can't write file\n", screenPath);
+        return 2;
+    }
+    if (robot.screenshots) {
+        printf("%d screenshots written to screen_*.ppm\n", robot.screenshots);
+    }
+    printf("\n");
+
+    TimelineFile timeline;
+    if (!timeline_read(SIMULATE_TIMELINE_FILE, timeline) || !timeline_write_chrome(jsonPath, timeline)) {
+        return 2;
+    }
+
+    printf("%zu timeline events written to %s\n", timeline.events.size(), jsonPath);
+    return 0;
+}
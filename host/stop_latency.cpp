@@ -0,0 +1,90 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*         Encoder stop measurement          */
+/*                                           */
+/*  Runs move_forward_inches() and           */
+/*  turn_right_degrees() from main.cpp on    */
+/*  the simulated robot at a range of motor  */
+/*  percents and prints how late the motors  */
+/*  were cut and how far past the target     */
+/*  each move went.                          */
+/*                                           */
+/*  Usage: ./stop_latency [-i inches]        */
+/*             [-d degrees]                  */
+/*********************************************/
+
+#include "sim_robot.h"
+#include "../units.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// From main.cpp
+void move_forward_inches(Percent percent, Inches inches, int line = __builtin_LINE());
+void turn_right_degrees(Percent percent, Degrees degrees, int line = __builtin_LINE());
+
+/************************************************/
+// Definitions
+#define STOP_DEFAULT_INCHES 12
+#define STOP_DEFAULT_DEGREES 90
+#define STOP_SETTLE_TIME 1.0 // Seconds the robot is left to roll to a stop before the counts are read
+
+static const int forwardPercents[] = { 20, 35, 45, 60, 80 };
+static const int turnPercents[] = { 20, 30, 45, 60 };
+
+/*******************************************************
+ * @brief Runs one move on a fresh robot and prints a row for it
+ *
+ * @param turn true for turn_right_degrees(), false for move_forward_inches()
+ * @param amount Inches or degrees
+ */
+static void run_move(bool turn, int percent, float amount) {
+    SimRobot robot;
+    host_set_hardware(&robot);
+
+    if (turn) {
+        turn_right_degrees(Percent(percent), Degrees(amount));
+    } else {
+        move_forward_inches(Percent(percent), Inches(amount));
+    }
+    robot.Sleep(STOP_SETTLE_TIME);
+    host_set_hardware(0);
+
+    int settled = (int)robot.encoderCounts[0] + (int)robot.encoderCounts[1];
+    double inchesPast = (settled - robot.stopTarget) / 2.0 / robot.params.countsPerInch;
+
+    printf("%-8s %7d %8d %10.3f %10d %12.3f %12.1f\n", turn ? "turn" : "forward", percent, robot.stopTarget, robot.stopCutCounts - robot.stopReachedCounts, settled - robot.stopTarget, inchesPast,
+           robot.EncoderStopLatency() * 1e6);
+}
+
+int main(int argc, char *argv[]) {
+    float inches = STOP_DEFAULT_INCHES;
+    float degrees = STOP_DEFAULT_DEGREES;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-i") && (i + 1 < argc)) {
+            inches = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-d") && (i + 1 < argc)) {
+            degrees = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [-i inches] [-d degrees]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    printf("move_forward_inches(percent, %.1f), turn_right_degrees(percent, %.1f)\n", inches, degrees);
+    printf("Counts are both encoders added together. \"cut over\" is how far they went between reaching the target\n"
+           "and the motors being cut, \"final\" is past the target once the robot stopped rolling.\n\n");
+    printf("%-8s %7s %8s %10s %10s %12s %12s\n", "move", "percent", "target", "cut over", "final over",
+           "final in", "latency us");
+
+    for (size_t i = 0; i < sizeof(forwardPercents) / sizeof(forwardPercents[0]); i++) {
+        run_move(false, forwardPercents[i], inches);
+    }
+    for (size_t i = 0; i < sizeof(turnPercents) / sizeof(turnPercents[0]); i++) {
+        run_move(true, turnPercents[i], degrees);
+    }
+
+    return 0;
+}
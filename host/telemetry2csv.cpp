@@ -0,0 +1,118 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*       Telemetry to spreadsheet (CSV)      */
+/*                                           */
+/*  Decodes the binary samples in a          */
+/*  telemetry.txt (telemetry.h) into one     */
+/*  CSV row each. Stage names come from the  */
+/*  costs.txt of the same run if given.      */
+/*                                           */
+/*  Usage: ./telemetry2csv telemetry.txt     */
+/*             [telemetry.csv] [costs.txt]   */
+/*********************************************/
+
+#include "../telemetry_format.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+
+static const char *sourceNames[TELEMETRY_SOURCES] = { "pid", "move_start", "move_stop", "rps" };
+
+/*******************************************************
+ * @brief Reads the stage names from a cost file (STAGE lines)
+ */
+static void read_stage_names(const char path[], std::map<int, std::string> &stages) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "%s: can't open file, stages will be numbers\n", path);
+        return;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        int index;
+        char name[160];
+        if (sscanf(line, "STAGE %d %159[^\n]", &index, name) == 2) {
+            stages[index] = name;
+        }
+    }
+    fclose(file);
+}
+
+int main(int argc, char *argv[]) {
+    if ((argc < 2) || (argc > 4)) {
+        fprintf(stderr, "usage: %s telemetry.txt [telemetry.csv] [costs.txt]\n", argv[0]);
+        return 2;
+    }
+
+    std::map<int, std::string> stages;
+    if (argc == 4) {
+        read_stage_names(argv[3], stages);
+    }
+
+    FILE *in = fopen(argv[1], "r");
+    if (!in) {
+        fprintf(stderr, "%s: can't open file\n", argv[1]);
+        return 2;
+    }
+
+    const char *outPath = (argc >= 3) ? argv[2] : "telemetry.csv";
+    FILE *out = fopen(outPath, "w");
+    if (!out) {
+        fprintf(stderr, "%s: can't write file\n", outPath);
+        fclose(in);
+        return 2;
+    }
+
+    fprintf(out, "time,source,stage,left_counts,right_counts,left_percent,right_percent,rps_x,rps_y,rps_heading,"
+                 "left_p,left_i,left_d,right_p,right_i,right_d\n");
+
+    int version = 0;
+    unsigned long written = 0, recorded = 0, rows = 0;
+    bool ended = false;
+    char line[256];
+    while (fgets(line, sizeof(line), in)) {
+        unsigned long words[TELEMETRY_WORDS];
+
+        if (sscanf(line, "TELEMETRY %d", &version) == 1) {
+            continue;
+        } else if (sscanf(line, "END %lu %lu", &written, &recorded) == 2) {
+            ended = true;
+        } else if (sscanf(line, "S %lx %lx %lx %lx %lx %lx %lx %lx", &words[0], &words[1], &words[2], &words[3], &words[4],
+                          &words[5], &words[6], &words[7]) == TELEMETRY_WORDS) {
+            uint32_t raw[TELEMETRY_WORDS];
+            for (int i = 0; i < TELEMETRY_WORDS; i++) {
+                raw[i] = (uint32_t)words[i];
+            }
+
+            TelemetrySample sample;
+            memcpy(&sample, raw, sizeof(sample));
+
+            std::string stage = stages.count(sample.stage) ? stages[sample.stage] : std::to_string(sample.stage);
+            fprintf(out, "%.4f,%s,\"%s\",%d,%d,%.2f,%.2f,%.2f,%.2f,%.1f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n", sample.time,
+                    (sample.source < TELEMETRY_SOURCES) ? sourceNames[sample.source] : "?", stage.c_str(), sample.counts[0],
+                    sample.counts[1], sample.percent[0] / 100.0, sample.percent[1] / 100.0, sample.rpsX / 100.0,
+                    sample.rpsY / 100.0, sample.rpsHeading / 10.0, sample.pid[0][0] / 100.0, sample.pid[0][1] / 100.0,
+                    sample.pid[0][2] / 100.0, sample.pid[1][0] / 100.0, sample.pid[1][1] / 100.0, sample.pid[1][2] / 100.0);
+            rows++;
+        }
+    }
+    fclose(in);
+    fclose(out);
+
+    if (version != TELEMETRY_VERSION) {
+        fprintf(stderr, "%s: not a version %d telemetry file\n", argv[1], TELEMETRY_VERSION);
+        return 2;
+    }
+
+    printf("%lu samples written to %s", rows, outPath);
+    if (!ended) {
+        printf(" (file was cut short)");
+    } else if (recorded > written) {
+        printf(" (the first %lu samples of the run were overwritten)", recorded - written);
+    }
+    printf("\n");
+    return 0;
+}
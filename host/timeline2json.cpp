@@ -0,0 +1,36 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*     Timeline to Chrome trace converter    */
+/*                                           */
+/*  Usage: ./timeline2json timeline.txt      */
+/*             [timeline.json]               */
+/*                                           */
+/*  Open the output in chrome://tracing or   */
+/*  ui.perfetto.dev.                         */
+/*********************************************/
+
+#include "timeline_export.h"
+
+#include <cstdio>
+#include <string>
+
+int main(int argc, char *argv[]) {
+    if ((argc < 2) || (argc > 3)) {
+        fprintf(stderr, "usage: %s timeline.txt [timeline.json]\n", argv[0]);
+        return 2;
+    }
+
+    TimelineFile timeline;
+    if (!timeline_read(argv[1], timeline)) {
+        return 2;
+    }
+
+    std::string outPath = (argc == 3) ? argv[2] : "timeline.json";
+    if (!timeline_write_chrome(outPath.c_str(), timeline)) {
+        return 2;
+    }
+
+    printf("%zu events written to %s%s\n", timeline.events.size(), outPath.c_str(),
+           timeline.overflowed ? " (robot buffer overflowed, run is cut short)" : "");
+    return 0;
+}
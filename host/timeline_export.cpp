@@ -0,0 +1,130 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*    Timeline file reading (host, impl)     */
+/*********************************************/
+
+#include "timeline_export.h"
+#include "../timeline_format.h"
+
+#include <cstdio>
+#include <cstring>
+
+// Track names, indexed by TimelineTrack
+static const char *trackNames[] = { "", "Robot", "Stages", "Servos" };
+#define TRACK_COUNT (TIMELINE_TRACK_SERVO + 1)
+
+bool timeline_read(const char *path, TimelineFile &timeline) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "%s: can't open file\n", path);
+        return false;
+    }
+
+    char line[256];
+    int version = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        TimelineRecord record;
+        char phase;
+        char name[160];
+        unsigned long micros;
+        long milliArg;
+        int count, overflowed;
+
+        if (sscanf(line, "TIMELINE %d", &version) == 1) {
+            continue;
+        } else if (sscanf(line, "END %d %d", &count, &overflowed) == 2) {
+            timeline.overflowed = overflowed;
+        } else if (sscanf(line, "%c %d %lu %ld %159[^\n]", &phase, &record.track, &micros, &milliArg, name) == 5) {
+            record.phase = phase;
+            record.time = micros / 1e6;
+            record.arg = milliArg / 1000.0;
+            record.name = name;
+            timeline.events.push_back(record);
+        }
+    }
+
+    fclose(file);
+
+    if (version != TIMELINE_VERSION) {
+        fprintf(stderr, "%s: not a version %d timeline\n", path, TIMELINE_VERSION);
+        return false;
+    }
+    return true;
+}
+
+/*******************************************************
+ * @brief Writes a string with JSON escapes
+ */
+static void write_json_string(FILE *file, const std::string &text) {
+    fputc('"', file);
+    for (size_t i = 0; i < text.size(); i++) {
+        if ((text[i] == '"') || (text[i] == '\\')) {
+            fputc('\\', file);
+        }
+        fputc(text[i], file);
+    }
+    fputc('"', file);
+}
+
+bool timeline_write_chrome(const char *path, const TimelineFile &timeline) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "%s: can't open file\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    // Names for each row
+    for (int track = 1; track < TRACK_COUNT; track++) {
+        fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", track, trackNames[track]);
+        fprintf(file, "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}},\n", track, track);
+    }
+
+    // Open begin events on each track so anything left open can be closed
+    std::vector<std::string> open[TRACK_COUNT];
+    double lastTime = 0;
+
+    for (size_t i = 0; i < timeline.events.size(); i++) {
+        const TimelineRecord &event = timeline.events[i];
+        int track = ((event.track > 0) && (event.track < TRACK_COUNT)) ? event.track : TIMELINE_TRACK_ROBOT;
+
+        fprintf(file, "{\"name\":");
+        write_json_string(file, event.name);
+        fprintf(file, ",\"ph\":\"%c\",\"ts\":%.0f,\"pid\":1,\"tid\":%d", event.phase, event.time * 1e6, track);
+        if (event.phase == 'i') {
+            fprintf(file, ",\"s\":\"t\"");
+        }
+        if (event.phase != 'E') {
+            fprintf(file, ",\"args\":{\"value\":%g}", event.arg);
+        }
+        fprintf(file, "},\n");
+
+        if (event.phase == 'B') {
+            open[track].push_back(event.name);
+        } else if ((event.phase == 'E') && !open[track].empty()) {
+            open[track].pop_back();
+        }
+
+        if (event.time > lastTime) {
+            lastTime = event.time;
+        }
+    }
+
+    for (int track = 1; track < TRACK_COUNT; track++) {
+        while (!open[track].empty()) {
+            fprintf(file, "{\"name\":");
+            write_json_string(file, open[track].back());
+            fprintf(file, ",\"ph\":\"E\",\"ts\":%.0f,\"pid\":1,\"tid\":%d},\n", lastTime * 1e6, track);
+            open[track].pop_back();
+        }
+    }
+
+    // Trailing object so every event line above can end with a comma
+    fprintf(file, "{\"name\":\"%s\",\"ph\":\"i\",\"ts\":%.0f,\"pid\":1,\"tid\":1,\"s\":\"g\"}\n]}\n",
+            timeline.overflowed ? "timeline buffer overflowed" : "end of run", lastTime * 1e6);
+
+    fclose(file);
+    return true;
+}
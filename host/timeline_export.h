@@ -0,0 +1,45 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*       Timeline file reading (host)        */
+/*                                           */
+/*  Reads timeline.txt written by            */
+/*  timeline_write() (on the robot or in the */
+/*  simulator) and converts it.              */
+/*********************************************/
+
+#ifndef TIMELINE_EXPORT_H
+#define TIMELINE_EXPORT_H
+
+#include <string>
+#include <vector>
+
+// One line of a timeline file
+struct TimelineRecord {
+    char phase; // 'B', 'E' or 'i'
+    int track; // TimelineTrack from timeline.h
+    double time; // Seconds
+    double arg;
+    std::string name;
+};
+
+struct TimelineFile {
+    std::vector<TimelineRecord> events;
+    bool overflowed = false;
+};
+
+/*******************************************************
+ * @brief Reads a timeline file
+ *
+ * @return bool true if the file could be read
+ */
+bool timeline_read(const char *path, TimelineFile &timeline);
+
+/*******************************************************
+ * @brief Writes a timeline in the Chrome trace JSON format. Events still open at
+ * the end (robot turned off, buffer full) are closed at the last timestamp.
+ *
+ * @return bool true if the file could be written
+ */
+bool timeline_write_chrome(const char *path, const TimelineFile &timeline);
+
+#endif
@@ -0,0 +1,103 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*                Idle waits                 */
+/*                                           */
+/*  Waits on a person or a sensor without    */
+/*  spinning: the input is read once per     */
+/*  poll period and the robot sleeps in      */
+/*  between, so waits at the start line      */
+/*  don't hammer the touch screen, the       */
+/*  sensors and the LCD thousands of times   */
+/*  a second. Every wait reads its input     */
+/*  once before it sleeps, so one that is    */
+/*  already done costs nothing.              */
+/*                                           */
+/*  The FEH library has no low power sleep,  */
+/*  so idle_sleep() is Sleep(). It is the    */
+/*  one place to change if it gets one.      */
+/*                                           */
+/*  MUST be included after timeline.h.       */
+/*********************************************/
+
+#ifndef IDLE_WAIT_H
+#define IDLE_WAIT_H
+
+/************************************************/
+// Definitions
+#define IDLE_POLL_PERIOD 0.05 // Seconds between polls while waiting on a person (20 Hz)
+#define IDLE_FOREVER -1 // Timeout for waits that don't give up
+
+/*******************************************************
+ * @brief Sleeps between polls
+ */
+inline void idle_sleep(double seconds) {
+    Sleep(seconds);
+}
+
+/*******************************************************
+ * @brief Whether a wait that started at startTime has run out of time
+ */
+inline bool idle_timed_out(double startTime, double timeout) {
+    return (timeout >= 0) && (TimeNow() - startTime >= timeout);
+}
+
+/*******************************************************
+ * @brief Waits until the screen is touched
+ *
+ * @param x, y Set to where it was touched
+ * @param timeout Seconds to wait, or IDLE_FOREVER
+ * @param period Seconds between polls
+ * @return bool true if it was touched, false if it timed out
+ */
+bool idle_wait_touch(int *x, int *y, double timeout = IDLE_FOREVER, double period = IDLE_POLL_PERIOD) {
+    double startTime = TimeNow();
+    while (!LCD.Touch(x, y)) {
+        if (idle_timed_out(startTime, timeout)) {
+            return false;
+        }
+        idle_sleep(period);
+    }
+    return true;
+}
+
+/*******************************************************
+ * @brief Waits until the screen isn't being touched
+ *
+ * @param period Seconds between polls
+ */
+void idle_wait_release(double period = IDLE_POLL_PERIOD) {
+    int x, y;
+    while (LCD.Touch(&x, &y)) {
+        idle_sleep(period);
+    }
+}
+
+/*******************************************************
+ * @brief Waits until an analog input reads under a threshold (the CdS cell
+ * sees a light)
+ *
+ * @param pin Input to read
+ * @param threshold Value it has to go under
+ * @param timeout Seconds to wait, or IDLE_FOREVER
+ * @param period Seconds between polls
+ * @param onPoll Called with each value read, before sleeping (0 for none)
+ * @return bool true if it went under, false if it timed out
+ */
+bool idle_wait_below(AnalogInputPin &pin, float threshold, double timeout, double period, void (*onPoll)(float value) = 0) {
+    double startTime = TimeNow();
+    while (true) {
+        float value = pin.Value();
+        if (onPoll) {
+            onPoll(value);
+        }
+        if (value < threshold) {
+            return true;
+        }
+        if (idle_timed_out(startTime, timeout)) {
+            return false;
+        }
+        idle_sleep(period);
+    }
+}
+
+#endif
@@ -19,32 +19,66 @@
 #include <FEHServo.h>
 #include <cmath> // abs() 
 
+// Records sensor reads and motor/servo commands to the SD card so runs can be replayed with host/replay.
+// Off unless the build defines RECORD_SENSOR_TRACE=1 (diagnostic runs), since the buffer takes 36 KB of RAM.
+#include "sensor_trace.h" // Must stay after the FEH headers
+#include "timeline.h" // Must stay after sensor_trace.h
+#include "units.h"
+
+// Number type for the PID and odometry math, see control_math.h
+#define CONTROL_MATH CONTROL_MATH_FLOAT
+#include "control_math.h"
+#include "probes.h" // Must stay after timeline.h
+
+// Drive encoders and motors the telemetry samples (same as the declarations below)
+#define TELEMETRY_LEFT_ENCODER FEHIO::P3_1
+#define TELEMETRY_RIGHT_ENCODER FEHIO::P3_2
+#define TELEMETRY_LEFT_MOTOR FEHMotor::Motor3
+#define TELEMETRY_RIGHT_MOTOR FEHMotor::Motor2
+#include "telemetry.h" // Must stay after timeline.h and control_math.h
+#include "encoder_stop.h" // Must stay after probes.h and telemetry.h
+#include "task.h" // Must stay after telemetry.h
+#include "mission.h"
+#include "arm.h"
+#include "servo_calibration.h"
+#include "track_width.h"
+#include "idle_wait.h" // Must stay after timeline.h
+#include "drive_model.h"
+
 /************************************************/
 // Definitions
-#define ROBOT_WIDTH 7.95 // Length of front/back side of OUR robot in inches
-#define PI 3.14159265
+#define ROBOT_WIDTH 7.95f // Length of front/back side of OUR robot in inches
+#define PI 3.14159265f
 #define BACKGROUND_COLOR WHITE // Background color of layout
 #define FONT_COLOR BLACK // Font color of layout
 
 // Movement/Dimension calculations
 #define DIST_AXIS_CDS 4.125 // Distance from the center of the wheel axis to the CdS cell. (5.375 - 1.25)
-#define COUNT_PER_INCH (318 / (2 * 3.14159265 * 1.25)) // Number of encoder counts per inch ((ENCODER_COUNTS_PER_REV / (2 * PI * WHEEL_RADIUS))) 
-#define INCH_PER_COUNT ((2 * 3.14159265 * 1.25) / 318) // ^ but opposite
+#define COUNT_PER_INCH (318 / (2 * 3.14159265f * 1.25f)) // Number of encoder counts per inch ((ENCODER_COUNTS_PER_REV / (2 * PI * WHEEL_RADIUS))). Single precision like the rest of the motion math.
+#define INCH_PER_COUNT ((2 * 3.14159265f * 1.25f) / 318) // ^ but opposite
 
 // Precise movement calibrations
 #define BACKWARDS_CALIBRATOR 2.4 // Percent difference needed to make backward motors move the same as forward motors at 20%. Initially 2.15
 #define RIGHT_MOTOR_CALIBRATOR 1 
 
-// Servo min/max values
+// Servo min/max values. Used until the CALIBRATE_SERVOS sweep saves SERVO_CALIBRATION_FILE.
 #define BASE_SERVO_MIN 500
 #define BASE_SERVO_MAX 2290
 #define ON_ARM_SERVO_MIN 500
 #define ON_ARM_SERVO_MAX 2400
 
+// Servo calibration sweep
+#define CALIBRATE_PULSE_STEP 10 // Microseconds the sweep moves the pulse each step
+#define CALIBRATE_STEP_TIME 0.05 // Seconds between steps, slow enough for the horn to keep up
+#define CALIBRATE_STOP_MARGIN 20 // Microseconds backed off from where the horn stopped, so it doesn't stall against the stop
+#define CALIBRATE_SPEED_TRIES 3 // Full sweeps timed for the speed
+#define CALIBRATE_SETTLE_TIME 1.0 // Seconds to wait at the start of each timed sweep
+#define CALIBRATE_TOUCH_PERIOD 0.005 // Seconds between touch polls while timing a sweep
+
 // Speeds the robot uses
-#define FORWARD_SPEED 45
-#define TURN_SPEED 30
-#define RAMP_SPEED 50
+#define FORWARD_SPEED 45_pct
+#define TURN_SPEED 30_pct
+#define RAMP_SPEED 50_pct
 
 // RPS pulse values
 #define RPS_DELAY_TIME 0.35 // Time that the RPS takes to check again before correcting
@@ -53,10 +87,114 @@
 #define RPS_TURN_PULSE_TIME 0.08 // Time that the wheels pulse for to correct heading. Originally 0.05.
 #define RPS_TURN_THRESHOLD 0.5 // Degrees that the heading can differ from before calling it a day
 
-#define RPS_TRANSLATIONAL_PULSE_PERCENT 20 // Percent at which motors will pulse to correct translational movement
-#define RPS_TRANSLATIONAL_PULSE_TIME 0.1 // Time that the wheels pulse for to correct translational coords
+#define RPS_TRANSLATIONAL_PULSE_PERCENT 20_pct // Percent at which motors will pulse to correct translational movement
+#define RPS_TRANSLATIONAL_PULSE_TIME 0.1_s // Time that the wheels pulse for to correct translational coords
 #define RPS_TRANSLATIONAL_THRESHOLD 0.25 // Coord units that the robot can be in range of
 
+/************************************************/
+// Unit conversions. Constant arguments fold at compile time.
+
+// Encoder counts for driving a distance
+constexpr Counts inches_to_counts(Inches inches) {
+    return Counts(COUNT_PER_INCH * inches.value);
+}
+
+// Encoder counts (on each wheel) for turning in place
+constexpr Counts degrees_to_counts(Degrees degrees, float width = ROBOT_WIDTH) {
+    return Counts(COUNT_PER_INCH * ((degrees.value * PI) / 180.0f) * (width / 2));
+}
+
+/************************************************/
+// Tool frames. Where each tool sits relative to the wheel axis center, which is
+// the point RPS reports and the robot turns about.
+struct ToolFrame {
+    const char *name;
+    Inches forward; // Ahead of the wheel axis
+    Inches left; // Left of the center line
+};
+
+constexpr ToolFrame TOOL_AXIS = { "axis", 0_in, 0_in };
+constexpr ToolFrame TOOL_CDS = { "CdS cell", Inches(DIST_AXIS_CDS), 0_in };
+constexpr ToolFrame TOOL_ARM_TIP = { "arm tip", 6.5_in, 0_in }; // Base servo arm down
+
+#define TOOL_LATERAL_TOLERANCE 1.0 // Inches a tool can be off to the side and still get there with one straight move (about the jukebox light)
+
+// Arm model (see arm.h). Each joint's travel comes from its servo's pulse widths.
+// initiate_servos() puts the calibrated pulse widths and speeds in.
+ArmModel armModel = { { BASE_SERVO_MIN, BASE_SERVO_MAX, ARM_BASE_ZERO, ARM_SERVO_SPEED },
+                      { ON_ARM_SERVO_MIN, ON_ARM_SERVO_MAX, ARM_ON_ARM_ZERO, ARM_SERVO_SPEED } };
+
+constexpr ArmJoints ARM_STOWED = { 85, 8 }; // Where initiate_servos() puts the arm
+constexpr ArmJoints FLIP_BURGER_UNDER = { 0, 8 }; // Base arm down under the hot plate handle
+
+// Distance scale. RPS inches per encoder inch, learned from straight moves.
+#define SURFACE_FLOOR 0
+#define SURFACE_RAMP 1
+#define MOTION_FORWARD 1
+#define MOTION_BACKWARD -1
+#define MOTION_TURN 0
+#define MOTION_NUDGE 2 // RPS heading pulse
+#define DISTANCE_SCALE_MIN_INCHES 3.0 // Shorter moves are mostly RPS noise
+#define DISTANCE_SCALE_LIMIT 0.2 // Samples further than this from 1 were pushing against something, dropped
+#define DISTANCE_SCALE_GAIN 0.25 // Weight of a new sample once a few are in
+#define DISTANCE_SCALE_RAMP_X0 11.0 // Ramp on the course, RPS coordinates
+#define DISTANCE_SCALE_RAMP_Y0 20.5
+#define DISTANCE_SCALE_RAMP_X1 20.75
+#define DISTANCE_SCALE_RAMP_Y1 34.0
+
+// Track width. What the wheels act like they are apart, learned from turns.
+#define TURN_LEFT 1 // Counterclockwise, the way RPS headings go up
+#define TURN_RIGHT -1
+#define TRACK_WIDTH_FAST_PERCENT 35_pct // Turns at least this fast scrub more, kept apart
+#define TRACK_WIDTH_MIN_DEGREES 30.0 // Smaller turns are mostly RPS noise
+#define TRACK_WIDTH_LIMIT 0.25 // Samples further than this from ROBOT_WIDTH (as a fraction) were stuck on something, dropped
+#define TRACK_WIDTH_GAIN 0.25 // Weight of a new sample once a few are in
+
+// Start pose. Where the opening moves were written for: the wheel axis on the
+// start light, from the top level reference (27.0, 5.9 on the practice course).
+#define START_X_OFFSET 11.55
+#define START_Y_OFFSET -46.35
+#define START_HEADING 135.0
+#define START_MOVE_TOLERANCE 0.5 // Fraction the opening move can change by before the start pose is not trusted
+#define START_LEG_TOLERANCE 4.0 // Inches the move after the opening turn can change by
+
+// Start light
+#define START_LIGHT_THRESHOLD 0.5 // CdS values under this are the light on
+#define START_LIGHT_POLL_PERIOD 0.01 // Seconds between reads of the CdS cell, the most the start can be late by
+#define START_LIGHT_SHOW_CHANGE 0.05 // CdS value is only redrawn when it moves this much
+
+// Self test. Each motor runs forward then back by itself, pivoting the robot
+// about the other wheel, while the arm swings off ARM_STOWED and back. About
+// 3 s with the wait for RPS, under 5 s in all.
+#define SELF_TEST_AT_START 1 // Runs the self test before the start light on courses that use RPS
+#define SELF_TEST_PERCENT 25_pct
+#define SELF_TEST_PULSE_TIME 0.4 // Seconds each motor runs each way
+#define SELF_TEST_RATE_TIME 0.2 // Seconds at the end of a pulse the rate is timed over, after it spins up
+#define SELF_TEST_MIN_RATE 100.0 // Counts per second that count as turning (about 250 at SELF_TEST_PERCENT)
+#define SELF_TEST_MIN_TURN 3.0 // Degrees a pulse has to pivot the robot the right way (about 20 expected)
+#define SELF_TEST_SERVO_SWING 20.0 // Degrees each servo moves off ARM_STOWED
+
+// Drive system identification (SYSID_DRIVE). Both motors get the same command,
+// so the robot drives straight, and each encoder is fitted by itself. Every
+// forward step is followed by the same step backward, and the chirp is driven
+// back by its counts, so the robot ends about where it started. Needs about
+// 12 in clear ahead.
+constexpr float SYSID_STEP_PERCENTS[] = { 15, 25, 35, 45 };
+#define SYSID_STEP_COUNT (int)(sizeof(SYSID_STEP_PERCENTS) / sizeof(SYSID_STEP_PERCENTS[0]))
+#define SYSID_STEP_TIME 0.5 // Seconds each step runs
+#define SYSID_FIT_FROM 0.25 // Seconds into a step before the wheel counts as up to speed (a few time constants)
+#define SYSID_SETTLE_TIME 0.3 // Seconds stopped after each command
+#define SYSID_SAMPLE_PERIOD 0.005 // Seconds between encoder samples (200 Hz)
+#define SYSID_MAX_SAMPLES 400
+#define SYSID_CHIRP_PERCENT 25.0 // Middle of the chirp. It stays forward so the encoders' direction is known.
+#define SYSID_CHIRP_AMPLITUDE 10.0
+#define SYSID_CHIRP_START 0.5 // Hz
+#define SYSID_CHIRP_END 5.0
+#define SYSID_CHIRP_TIME 1.5 // Seconds
+
+// Tasks
+#define STATUS_TASK_PERIOD 0.1 // Seconds between rows of RPS data on the screen while tasks run
+
 /************************************************/
 // Global variables for RPS values
 
@@ -70,30 +208,67 @@ float RPS_270_Degrees = 270;
 float RPS_Top_Level_X_Reference = 15.45;
 float RPS_Top_Level_Y_Reference = 52.25;
 
+// *****************************************
+// Global variables for the distance scale
+
+// [surface][0 forward, 1 backward]. Open loop moves are divided by these.
+float distanceScale[2][2] = { { 1, 1 }, { 1, 1 } };
+int distanceScaleSamples[2][2] = { { 0, 0 }, { 0, 0 } };
+
+// Where the robot is, from an RPS fix taken while it was still
+bool distanceScaleKnown = false; // Cleared once it drives away
+float distanceScaleX, distanceScaleY;
+bool distanceScaleSettled = false; // The current motion started from still
+
+// Straight motions since the last still RPS fix
+bool distanceScaleChain = false;
+bool distanceScaleClosed = false; // A turn came after them, so the next straight motion drops them
+float distanceScaleStartX, distanceScaleStartY;
+int distanceScaleDirection; // MOTION_FORWARD or MOTION_BACKWARD of the first one
+float distanceScaleInches; // Encoder inches along it so far (backward pulses take away)
+int distanceScaleMotion = MOTION_TURN; // Motion the encoders are counting now
+int distanceScaleCounts = 0; // Both encoders added together when last read
+double distanceScaleStopTime = 0; // When the robot last stopped moving
+bool distanceScaleMoving = false;
+
+// *****************************************
+// Global variables for the track width
+
+// [surface][0 slow, 1 fast]. Turns use these instead of ROBOT_WIDTH. Saved in TRACK_WIDTH_FILE.
+TrackWidths trackWidths = { { { ROBOT_WIDTH, ROBOT_WIDTH }, { ROBOT_WIDTH, ROBOT_WIDTH } }, { { 0, 0 }, { 0, 0 } } };
+
+// Turns since the last still RPS fix
+bool trackWidthChain = false;
+float trackWidthStartHeading;
+int trackWidthSurface;
+int trackWidthSpeed; // Of the first turn, the RPS pulses after it are slower
+float trackWidthInches; // Inches each wheel went counterclockwise (clockwise takes away)
+int trackWidthTurn = TURN_LEFT; // Way the current turn goes
+int trackWidthCounts = 0; // Both encoders added together when it started
+
+// *****************************************
+// Global variables for the start plan. Filled in by prepare_start() while
+// waiting for the start light, so the timed run doesn't have to.
+
+int startIceCream = -1; // RPS.GetIceCream(), -1 until RPS has sent it
+float startX = -1, startY = -1, startHeading = -1; // Last RPS pose before the light, -1 if RPS couldn't see the robot
+Inches startLegAdjust = 0_in; // Added to the move after the opening turn by move_from_start()
+bool startServosReady = false; // Servos are at ARM_STOWED for the first steps
+
 // *****************************************
 // Global variables for PID
 
-// PID Right Motor
-double PID_Linear_SpeedR, PID_New_CountsR, PID_Last_CountsR, PID_New_TimeR, PID_Last_TimeR, PID_New_Speed_ErrorR, PID_Last_Speed_ErrorR, PID_Error_SumR;
+// PID Right Motor (P, I and D constants)
+PIDWheel<control_t> PID_Right(0.75, 0.05, 0.25);
 float PID_NEW_MOTOR_POWERR, PID_OLD_MOTOR_POWERR;
-double PTermR, ITermR, DTermR;
-
-double PConstR = 0.75;
-double IConstR = 0.05; 
-double DConstR = 0.25;
 
 // PID Left Motor
-double PID_Linear_SpeedL, PID_New_CountsL, PID_Last_CountsL, PID_New_TimeL, PID_Last_TimeL, PID_New_Speed_ErrorL, PID_Last_Speed_ErrorL, PID_Error_SumL;
+PIDWheel<control_t> PID_Left(0.75, 0.05, 0.25);
 float PID_NEW_MOTOR_POWERL, PID_OLD_MOTOR_POWERL;
-double PTermL, ITermL, DTermL;
-
-double PConstL = 0.75;
-double IConstL = 0.05; 
-double DConstL = 0.25;
 
 // Both
 double PID_TIME;
-double PID_DISTANCE_PER_COUNT = ((2 * 3.14159265 * 1.25) / 318);
+control_t PID_DISTANCE_PER_COUNT = INCH_PER_COUNT;
 
 #define SLEEP_PID 0.15
 
@@ -109,33 +284,138 @@ enum {
             PERF_COURSE_3 = 7, 
             PERF_COURSE_4 = 8, 
             IND_COMP = 9, 
-            FINAL_COMP = 10
+            FINAL_COMP = 10,
+            SYSID_DRIVE = 11
          };
 
+// What start_menu() lists, in the order it shows them (down each column, left to right)
+struct MenuCourse {
+    int courseNumber;
+    const char *name; // 7 characters at most
+};
+
+constexpr MenuCourse MENU_COURSES[] = {
+    { TEST_COURSE_1, "Test 1" }, { TEST_COURSE_2, "Test 2" }, { TEST_COURSE_3, "Test 3" },
+    { CALIBRATE_SERVOS, "Servos" }, { PERF_COURSE_1, "Perf 1" }, { PERF_COURSE_2, "Perf 2" },
+    { PERF_COURSE_3, "Perf 3" }, { PERF_COURSE_4, "Perf 4" }, { IND_COMP, "Indiv" },
+    { FINAL_COMP, "Final" }, { SYSID_DRIVE, "Sysid" },
+};
+
+#define MENU_COURSE_COUNT (int)(sizeof(MENU_COURSES) / sizeof(MENU_COURSES[0]))
+#define MENU_DEFAULT_COURSE FINAL_COMP // Runs when nobody picks one
+#define MENU_TIMEOUT 10.0 // Seconds before the default course runs
+#define MENU_TOP 40 // Pixel row the buttons start at
+#define MENU_BUTTON_HEIGHT 50 // Pixels
+#define MENU_BUTTON_WIDTH 106
+#define MENU_COLUMNS 3
+#define MENU_ROWS 4 // Buttons in each column
+
+int menuCourse = -1; // Course main() runs without showing the menu, -1 to show it. Set by host tools (simulate).
+bool selfTestAtStart = SELF_TEST_AT_START; // Cleared by host tools (simulate) so the run's times leave it out
+
+/************************************************/
+// One encoder move (straight or turn), shared by the blocking moves and DriveTask
+struct DriveMove {
+    float leftPercent, rightPercent; // Motor commands
+    Percent percent; // What the caller asked for
+    bool straight;
+    Inches inches; // Straight moves
+    int turn; // TURN_LEFT or TURN_RIGHT, for turns
+    Degrees degrees;
+    const char *text; // What the move is doing, for the screen
+    int column;
+    Counts expectedCounts; // Filled in by drive_move_start()
+};
+
+/************************************************/
+// Self test results for one drive motor
+struct MotorTest {
+    float forwardRate, backwardRate; // Encoder counts per second
+    float turned; // Degrees left RPS saw the forward pulse pivot the robot, 0 without RPS
+    bool rpsSawIt; // RPS had a heading before and after the forward pulse
+    bool passed;
+};
+
+/************************************************/
+// Drive sysid samples, one run of sysid_record() at a time
+struct SysidSample {
+    float time; // Seconds since the command started
+    int counts[DRIVE_SIDES]; // Left, right
+    float percent; // Command from this sample to the next
+};
+
+SysidSample sysidSamples[SYSID_MAX_SAMPLES];
+
 /************************************************/
 // Function Prototypes (For reference, these don't actually do anything)
-void update_RPS_Heading_values(double timeToCheck, bool checking_heading, bool checking_x, bool checking_y); 
+void update_RPS_Heading_values(double timeToCheck, bool checking_heading, bool checking_x, bool checking_y, int line = TIMELINE_CALL_SITE); 
 // ^ Updates RPS values across the course
-int read_start_light(double timeToCheck); // Waits for the start light with a timeout
-void move_forward_inches(int percent, float inches); // Moves forward number of inches
-void move_forward_seconds(float percent, float seconds); // Moves forward for a number of seconds
-void turn_right_degrees(int percent, float degrees); // Turns right a specified number of degrees
-void turn_left_degrees(int percent, float degrees); // Turns left a specified amount of degrees
-void RPS_correct_heading(float heading, double timeToCheck); // Corrects the heading of the robot using RPS
-void RPS_check_x(float x_coord, double timeToCheck); // Corrects the x-coord of the robot using RPS
-void RPS_check_y(float y_coord, double timeToCheck); // Corrects the y-coord of the robot using RPS
+void prepare_start(); // Reads and sets up what the run needs, called while waiting for the start light
+int planned_ice_cream(); // Flavor for the run, from the start plan if it has one
+float turn_between(float from, float to); // Degrees to turn left from one heading to another (negative for right)
+void move_from_start(Percent percent, Inches inches, Degrees turn, int line = TIMELINE_CALL_SITE); // Opening move and turn, from where the robot really started
+void show_start_light(float value); // Shows the CdS value and does the pre-start work, once per start light poll
+int read_start_light(double timeToCheck, int line = TIMELINE_CALL_SITE); // Waits for the start light with a timeout
+DriveMove drive_forward_move(Percent percent, Inches inches); // Straight encoder move, like move_forward_inches()
+DriveMove drive_turn_move(int turn, Percent percent, Degrees degrees); // Turn in place, like turn_right_degrees()
+void drive_move_start(DriveMove &move); // Scales a move, resets the encoders and starts the motors
+void drive_move_finish(const DriveMove &move); // Learns from a stopped move and shows its counts
+void move_forward_inches(Percent percent, Inches inches, int line = TIMELINE_CALL_SITE); // Moves forward number of inches
+void move_forward_seconds(Percent percent, Seconds seconds, int line = TIMELINE_CALL_SITE); // Moves forward for a number of seconds
+void turn_right_degrees(Percent percent, Degrees degrees, int line = TIMELINE_CALL_SITE); // Turns right a specified number of degrees
+void turn_left_degrees(Percent percent, Degrees degrees, int line = TIMELINE_CALL_SITE); // Turns left a specified amount of degrees
+void RPS_correct_heading(float heading, double timeToCheck, int line = TIMELINE_CALL_SITE); // Corrects the heading of the robot using RPS
+void RPS_check_x(float x_coord, double timeToCheck, int line = TIMELINE_CALL_SITE); // Corrects the x-coord of the robot using RPS
+void RPS_check_y(float y_coord, double timeToCheck, int line = TIMELINE_CALL_SITE); // Corrects the y-coord of the robot using RPS
+void tool_position(const ToolFrame &tool, float x, float y, float heading, float &toolX, float &toolY); // Where a tool is for a robot pose
+void move_tool_to(const ToolFrame &tool, float x, float y, int line = TIMELINE_CALL_SITE); // Moves a tool to a point with one move when it can
+void RPS_check_tool(const ToolFrame &tool, float x, float y, double timeToCheck, int line = TIMELINE_CALL_SITE); // Corrects a tool's position using RPS
+int distance_scale_surface_at(float x, float y); // Which surface a point on the course is
+int distance_scale_surface_along(float x0, float y0, float x1, float y1); // Which surface a straight path is on
+bool distance_scale_fix(); // Reads where the robot is if it has been still long enough for RPS
+int straight_direction(Percent percent); // MOTION_FORWARD or MOTION_BACKWARD for a motor percent
+void distance_scale_count(); // Adds the encoder counts since the last read to the straight motions
+void distance_scale_check(); // Takes a distance sample if one is waiting and RPS has caught up
+void distance_scale_motion_start(int motion, bool resetsCounts); // Call before any motion
+void distance_scale_motion_stop(); // Call once the motors are stopped
+Inches distance_scale_apply(Percent percent, Inches inches); // Encoder inches to drive for an open loop move
+int track_width_speed(Percent percent); // Which speed a turn's width is kept under
+float track_width_for(Percent percent); // Width to turn with here at a motor percent
+void track_width_check(); // Takes a track width sample if one is waiting and RPS has caught up
+void track_width_turn_start(int turn, Percent percent, Degrees degrees, bool resetsCounts); // Call before a turn or heading pulse
+void track_width_count(); // Adds the encoder counts since the last read to the turns
 void ResetPIDVariables(); // Resets PID variables
-float RightPIDAdjustment(double expectedSpeed); // Corrects right motor based on speed, counts, and expected speed
-float LeftPIDAdjustment(double expectedSpeed); // Corrects left motor based on speed, counts, and expected speed
-void move_forward_PID(float in_per_sec, float inches); // Uses PID to move forward a specific amount of inches
+float RightPIDAdjustment(control_t expectedSpeed); // Corrects right motor based on speed, counts, and expected speed
+float LeftPIDAdjustment(control_t expectedSpeed); // Corrects left motor based on speed, counts, and expected speed
+void move_forward_PID(InchesPerSecond speed, Inches inches, int line = TIMELINE_CALL_SITE); // Uses PID to move forward a specific amount of inches
 void initiate_servos(); // Initiates servos
-int detect_color(int timeToDetect); // Detects the color of the jukebox with timeout
-void press_jukebox_buttons(); // Presses the jukebox buttons
-void flip_burger(); // Flips the hot plate and burger
-void flip_ice_cream_lever(); // Flips the correct ice cream lever
+void set_servo_pulse(FEHServo &servo, int pulse); // Sends a servo a raw pulse width
+int sweep_servo_pulse(FEHServo &servo, int pulse, int step); // Steps a servo's pulse until the screen is touched
+void calibrate_servo(FEHServo &servo, ServoCalibration &calibration); // Finds a servo's min/max and times its speed
+int detect_color(int timeToDetect, int line = TIMELINE_CALL_SITE); // Detects the color of the jukebox with timeout
+void press_jukebox_buttons(int line = TIMELINE_CALL_SITE); // Presses the jukebox buttons
+void flip_burger(int line = TIMELINE_CALL_SITE); // Flips the hot plate and burger
+void flip_burger_async(int line = TIMELINE_CALL_SITE); // Flips the hot plate and burger as tasks, with RPS data on the screen
+void flip_ice_cream_lever(int line = TIMELINE_CALL_SITE); // Flips the correct ice cream lever
 void write_status(const char status[]); // Clears room for a printed string w/o clearing entire display
+void write_move_start(const char text[], int column); // Clears the move data space and says what the move is doing
+void write_move_data(Counts expectedCounts, Percent percent); // Shows the counts an encoder move wanted and read
+void write_encoder_stop(); // Shows how the last encoder move stopped
 void show_RPS_data(); // Shows basic RPS data for the robot
 void run_course(int courseNumber); // Runs the specified course
+const char *course_name(int courseNumber); // Name start_menu() shows for a course
+bool course_needs_rps(int courseNumber); // Whether a course uses RPS and waits for the start light
+int start_menu(int defaultCourse, double timeout); // Touch menu of every course, runs the default after a timeout
+float self_test_pulse(FEHMotor &motor, DigitalEncoder &encoder, float percent, int *counts); // Runs one motor for a pulse and times its encoder
+MotorTest self_test_motor(FEHMotor &motor, DigitalEncoder &encoder, int turn); // Pulses one motor forward and back and checks it
+void show_motor_test(const char name[], const MotorTest &test, int row); // Writes one motor's self test results
+bool self_test(int line = TIMELINE_CALL_SITE); // Checks the drivetrain, servos and RPS before the start light
+int sysid_record(float percent, float amplitude, double seconds); // Drives both motors with a step or chirp and samples the encoders
+void sysid_fit_step(int count, int side, float &speed, float &timeConstant); // Fits one wheel's speed and time constant to a step
+void sysid_fit_line(const float percents[], const float speeds[], int count, MotorModel &model); // Fits gain and deadband to step speeds
+float sysid_chirp_error(int count, int side, const MotorModel &model); // RMS inches a chirp was off a model
+void sysid_return(int counts); // Drives straight back a number of counts
+void sysid_surface(int surface, DriveModel &model); // Fits both motors on the surface the robot is on
 
 /************************************************/
 // Declarations for encoders/motors
@@ -153,6 +433,246 @@ FEHServo on_arm_servo(FEHServo::Servo7);
 // Declaration for CdS cell sensorsad 
 AnalogInputPin CdS_cell(FEHIO::P0_7);
 
+/************************************************/
+// Mission steps (see mission.h). Each one is a call the course makes, with the line it was written on.
+
+// Drives forward (negative percent for backward) a number of inches, move_forward_inches()
+struct DriveStep {
+    static const int needs = MISSION_NEEDS_NOTHING;
+    Percent percent;
+    Inches inches;
+    int line;
+    void run() const { move_forward_inches(percent, inches, line); }
+};
+
+constexpr DriveStep step_drive(Percent percent, Inches inches, int line = TIMELINE_CALL_SITE) {
+    return DriveStep{ Percent(mission_range(percent.value, -100, 100, "motor percent must be -100 to 100")), inches, line };
+}
+
+// Drives forward for a number of seconds, move_forward_seconds()
+struct DriveSecondsStep {
+    static const int needs = MISSION_NEEDS_NOTHING;
+    Percent percent;
+    Seconds seconds;
+    int line;
+    void run() const { move_forward_seconds(percent, seconds, line); }
+};
+
+constexpr DriveSecondsStep step_drive_seconds(Percent percent, Seconds seconds, int line = TIMELINE_CALL_SITE) {
+    return DriveSecondsStep{ Percent(mission_range(percent.value, -100, 100, "motor percent must be -100 to 100")),
+                             Seconds(mission_range(seconds.value, 0, 60, "seconds must be 0 to 60")), line };
+}
+
+// Drives forward at a speed in inches per second, move_forward_PID()
+struct DrivePIDStep {
+    static const int needs = MISSION_NEEDS_NOTHING;
+    InchesPerSecond speed;
+    Inches inches;
+    int line;
+    void run() const { move_forward_PID(speed, inches, line); }
+};
+
+constexpr DrivePIDStep step_drive_PID(InchesPerSecond speed, Inches inches, int line = TIMELINE_CALL_SITE) {
+    return DrivePIDStep{ InchesPerSecond(mission_range(speed.value, 0, 15, "speed must be 0 to 15 inches per second")), inches, line };
+}
+
+// Turns right a number of degrees, turn_right_degrees()
+struct TurnRightStep {
+    static const int needs = MISSION_NEEDS_NOTHING;
+    Percent percent;
+    Degrees degrees;
+    int line;
+    void run() const { turn_right_degrees(percent, degrees, line); }
+};
+
+constexpr TurnRightStep step_turn_right(Percent percent, Degrees degrees, int line = TIMELINE_CALL_SITE) {
+    return TurnRightStep{ Percent(mission_range(percent.value, -100, 100, "motor percent must be -100 to 100")),
+                          Degrees(mission_range(degrees.value, 0, 360, "degrees must be 0 to 360")), line };
+}
+
+// Turns left a number of degrees, turn_left_degrees()
+struct TurnLeftStep {
+    static const int needs = MISSION_NEEDS_NOTHING;
+    Percent percent;
+    Degrees degrees;
+    int line;
+    void run() const { turn_left_degrees(percent, degrees, line); }
+};
+
+constexpr TurnLeftStep step_turn_left(Percent percent, Degrees degrees, int line = TIMELINE_CALL_SITE) {
+    return TurnLeftStep{ Percent(mission_range(percent.value, -100, 100, "motor percent must be -100 to 100")),
+                         Degrees(mission_range(degrees.value, 0, 360, "degrees must be 0 to 360")), line };
+}
+
+// Corrects the heading to one of the headings read by update_RPS_Heading_values(), RPS_correct_heading()
+struct RPSHeadingStep {
+    static const int needs = MISSION_NEEDS_RPS | MISSION_NEEDS_RPS_VALUES;
+    const float *heading;
+    double seconds;
+    int line;
+    void run() const { RPS_correct_heading(*heading, seconds, line); }
+};
+
+constexpr RPSHeadingStep step_rps_heading(const float *heading, double seconds, int line = TIMELINE_CALL_SITE) {
+    return RPSHeadingStep{ heading, mission_range(seconds, 0, 60, "seconds must be 0 to 60"), line };
+}
+
+// Corrects the heading to a fixed number of degrees, RPS_correct_heading()
+struct RPSFixedHeadingStep {
+    static const int needs = MISSION_NEEDS_RPS;
+    float degrees;
+    double seconds;
+    int line;
+    void run() const { RPS_correct_heading(degrees, seconds, line); }
+};
+
+constexpr RPSFixedHeadingStep step_rps_heading_fixed(float degrees, double seconds, int line = TIMELINE_CALL_SITE) {
+    return RPSFixedHeadingStep{ mission_range(degrees, 0, 360, "degrees must be 0 to 360"),
+                                mission_range(seconds, 0, 60, "seconds must be 0 to 60"), line };
+}
+
+// Opening move and turn from the start pose read before the light, move_from_start()
+struct StartStep {
+    static const int needs = MISSION_NEEDS_RPS_VALUES;
+    Percent percent;
+    Inches inches;
+    Degrees turn;
+    int line;
+    void run() const { move_from_start(percent, inches, turn, line); }
+};
+
+constexpr StartStep step_from_start(Percent percent, Inches inches, Degrees turn, int line = TIMELINE_CALL_SITE) {
+    return StartStep{ Percent(mission_range(percent.value, -100, 100, "motor percent must be -100 to 100")), inches,
+                      Degrees(mission_range(turn.value, -180, 180, "turn must be -180 to 180")), line };
+}
+
+// The move after step_from_start(), lengthened or shortened to end where it would have from the start pose
+struct StartLegStep {
+    static const int needs = MISSION_NEEDS_NOTHING;
+    Percent percent;
+    Inches inches;
+    int line;
+    void run() const { move_forward_inches(percent, inches + startLegAdjust, line); }
+};
+
+constexpr StartLegStep step_drive_from_start(Percent percent, Inches inches, int line = TIMELINE_CALL_SITE) {
+    return StartLegStep{ Percent(mission_range(percent.value, -100, 100, "motor percent must be -100 to 100")), inches, line };
+}
+
+// Corrects x to an offset from the top level reference, RPS_check_x()
+struct RPSCheckXStep {
+    static const int needs = MISSION_NEEDS_RPS | MISSION_NEEDS_RPS_VALUES;
+    double offset;
+    double seconds;
+    int line;
+    void run() const { RPS_check_x(RPS_Top_Level_X_Reference + offset, seconds, line); }
+};
+
+constexpr RPSCheckXStep step_rps_x(double offset, double seconds, int line = TIMELINE_CALL_SITE) {
+    return RPSCheckXStep{ offset, mission_range(seconds, 0, 60, "seconds must be 0 to 60"), line };
+}
+
+// Corrects y to an offset from the top level reference, RPS_check_y()
+struct RPSCheckYStep {
+    static const int needs = MISSION_NEEDS_RPS | MISSION_NEEDS_RPS_VALUES;
+    double offset;
+    double seconds;
+    int line;
+    void run() const { RPS_check_y(RPS_Top_Level_Y_Reference + offset, seconds, line); }
+};
+
+constexpr RPSCheckYStep step_rps_y(double offset, double seconds, int line = TIMELINE_CALL_SITE) {
+    return RPSCheckYStep{ offset, mission_range(seconds, 0, 60, "seconds must be 0 to 60"), line };
+}
+
+// Puts a tool at offsets from the top level reference, move_tool_to()
+struct ToolStep {
+    static const int needs = MISSION_NEEDS_RPS | MISSION_NEEDS_RPS_VALUES;
+    const ToolFrame *tool;
+    double xOffset, yOffset;
+    int line;
+    void run() const { move_tool_to(*tool, RPS_Top_Level_X_Reference + xOffset, RPS_Top_Level_Y_Reference + yOffset, line); }
+};
+
+constexpr ToolStep step_tool_to(const ToolFrame *tool, double xOffset, double yOffset, int line = TIMELINE_CALL_SITE) {
+    return ToolStep{ tool, xOffset, yOffset, line };
+}
+
+// Corrects a tool to offsets from the top level reference, RPS_check_tool()
+struct RPSCheckToolStep {
+    static const int needs = MISSION_NEEDS_RPS | MISSION_NEEDS_RPS_VALUES;
+    const ToolFrame *tool;
+    double xOffset, yOffset;
+    double seconds;
+    int line;
+    void run() const {
+        RPS_check_tool(*tool, RPS_Top_Level_X_Reference + xOffset, RPS_Top_Level_Y_Reference + yOffset, seconds, line);
+    }
+};
+
+constexpr RPSCheckToolStep step_rps_tool(const ToolFrame *tool, double xOffset, double yOffset, double seconds,
+                                         int line = TIMELINE_CALL_SITE) {
+    return RPSCheckToolStep{ tool, xOffset, yOffset, mission_range(seconds, 0, 60, "seconds must be 0 to 60"), line };
+}
+
+// Sets a servo
+struct ServoStep {
+    static const int needs = MISSION_NEEDS_NOTHING;
+    FEHServo *servo;
+    float degree;
+    void run() const { servo->SetDegree(degree); }
+};
+
+constexpr ServoStep step_servo(FEHServo *servo, float degree) {
+    return ServoStep{ servo, mission_range(degree, 0, 180, "servo degree must be 0 to 180") };
+}
+
+// Waits
+struct SleepStep {
+    static const int needs = MISSION_NEEDS_NOTHING;
+    double seconds;
+    int line;
+    void run() const { Sleep(seconds, line); }
+};
+
+constexpr SleepStep step_sleep(double seconds, int line = TIMELINE_CALL_SITE) {
+    return SleepStep{ mission_range(seconds, 0, 60, "seconds must be 0 to 60"), line };
+}
+
+// Writes the status line, write_status()
+struct StatusStep {
+    static const int needs = MISSION_NEEDS_NOTHING;
+    const char *status;
+    void run() const { write_status(status); }
+};
+
+constexpr StatusStep step_status(const char status[]) {
+    return StatusStep{ status };
+}
+
+// Starts a course stage, timeline_stage()
+struct StageStep {
+    static const int needs = MISSION_NEEDS_NOTHING;
+    const char *name;
+    void run() const { timeline_stage(name); }
+};
+
+constexpr StageStep step_stage(const char name[]) {
+    return StageStep{ name };
+}
+
+// Calls a routine like flip_burger() that needs RPS
+struct CallStep {
+    static const int needs = MISSION_NEEDS_RPS;
+    void (*routine)(int line);
+    int line;
+    void run() const { routine(line); }
+};
+
+constexpr CallStep step_call(void (*routine)(int line), int line = TIMELINE_CALL_SITE) {
+    return CallStep{ routine, line };
+}
+
 /*******************************************************
  * @brief Updates RPS values by placing the robot in 90 degrees and in specific x/y coordinates on top platform (15.45, 52.25)
  * 
@@ -160,9 +680,12 @@ AnalogInputPin CdS_cell(FEHIO::P0_7);
  * @param checking_heading true if checking heading values (90 degrees), false if not
  * @param checking_x true if checking top x coordinate (15,45), false if not
  * @param checking_y true if checking top y coordinate (52.25), false if not 
+ * @param line Line it was called from (filled in automatically, used by the cost report)
  */
-void update_RPS_Heading_values(double timeToCheck, bool checking_heading, bool checking_x, bool checking_y) {
+void update_RPS_Heading_values(double timeToCheck, bool checking_heading, bool checking_x, bool checking_y, int line) {
     
+    TimelineScope timeline("update_RPS_Heading_values", 0, COST_OTHER, line);
+
     int xGarb420, yGarb420;
     float tempHeading, tempX, tempY;
 
@@ -295,7 +818,7 @@ void update_RPS_Heading_values(double timeToCheck, bool checking_heading, bool c
         LCD.ClearBuffer();
 
         // Waits until touch
-        while(!LCD.Touch(&xGarb420, &yGarb420));
+        idle_wait_touch(&xGarb420, &yGarb420);
     }
 
     // Clears the screen
@@ -304,81 +827,273 @@ void update_RPS_Heading_values(double timeToCheck, bool checking_heading, bool c
 }
 
 /*******************************************************
- * @brief Waits until the start light to run the course
+ * @brief One pass of the work done before the start light. Reads the flavor
+ * until RPS has it, keeps the start pose up to date in case the robot is
+ * moved, and puts the servos where the run starts them. Quick enough to call
+ * between reads of the CdS cell.
+ */
+void prepare_start() {
+    int lastIceCream = startIceCream;
+    float lastHeading = startHeading;
+
+    if ((startIceCream < 0) || (startIceCream > 2)) {
+        startIceCream = RPS.GetIceCream();
+    }
+
+    float x = RPS.X();
+    float y = RPS.Y();
+    float heading = RPS.Heading();
+    if ((x > 0) && (y > 0) && (heading >= 0)) {
+        startX = x;
+        startY = y;
+        startHeading = heading;
+    }
+
+    // Settles the servos now so they aren't still moving when the light comes on
+    if (!startServosReady) {
+        base_servo.SetDegree(ARM_STOWED.base);
+        on_arm_servo.SetDegree(ARM_STOWED.onArm);
+        startServosReady = true;
+    }
+
+    // Only redraws what changed
+    if (startIceCream != lastIceCream) {
+        LCD.WriteRC("Ice cream: ", 8, 2);
+        LCD.WriteRC(startIceCream, 8, 20);
+    }
+    if (startHeading != lastHeading) {
+        LCD.WriteRC("Start heading: ", 9, 2);
+        LCD.WriteRC(startHeading, 9, 20);
+    }
+}
+
+/*******************************************************
+ * @brief Flavor for the run. Uses the one read before the start light, and
+ * only asks RPS during the run if it never came (or for runs that skip the
+ * light).
+ *
+ * @return int 0 vanilla, 1 twist, 2 chocolate
+ */
+int planned_ice_cream() {
+    if ((startIceCream < 0) || (startIceCream > 2)) {
+        startIceCream = RPS.GetIceCream();
+    }
+    return startIceCream;
+}
+
+/*******************************************************
+ * @brief Degrees to turn left from one heading to another, -180 to 180
+ * (negative to turn right)
+ */
+float turn_between(float from, float to) {
+    float turn = to - from;
+    while (turn > 180) {
+        turn -= 360;
+    }
+    while (turn <= -180) {
+        turn += 360;
+    }
+    return turn;
+}
+
+/*******************************************************
+ * @brief The opening move of a course, then a turn. The moves were written
+ * for a robot at the START_ pose. From the pose prepare_start() read before
+ * the light, this drives along the heading the robot really has until it is
+ * on the line the moves would have turned onto, then turns onto that line.
+ * How far along the line it came out goes in startLegAdjust for the next move
+ * (step_drive_from_start()). A small turn first would overshoot more than it
+ * fixes. Without a start pose, or one too far off, it makes the moves as
+ * written.
+ *
+ * @param percent Motor percent for the move
+ * @param inches Move as written, from the START_ pose
+ * @param turn Turn after it as written (negative for right)
+ * @param line Line it was called from (filled in automatically, used by the cost report)
+ */
+void move_from_start(Percent percent, Inches inches, Degrees turn, int line) {
+    TimelineScope timeline("move_from_start", inches.value, COST_MOTION, line);
+
+    // Corner the moves reach from the START_ pose, and the line they turn onto
+    float startRad = START_HEADING * PI / 180.0f;
+    float endRad = (START_HEADING + turn.value) * PI / 180.0f;
+    float cornerX = RPS_Top_Level_X_Reference + START_X_OFFSET + inches.value * cos(startRad);
+    float cornerY = RPS_Top_Level_Y_Reference + START_Y_OFFSET + inches.value * sin(startRad);
+
+    Inches distance = inches;
+    float lastTurn = turn.value;
+    startLegAdjust = 0_in;
+    if (startHeading >= 0) {
+        float headingRad = startHeading * PI / 180.0f;
+        float errorX = cornerX - startX;
+        float errorY = cornerY - startY;
+
+        // Distance along the real heading to the line, and where on the line that is past the corner
+        float crossing = (cos(headingRad) * sin(endRad)) - (sin(headingRad) * cos(endRad));
+        float along = ((errorX * sin(endRad)) - (errorY * cos(endRad))) / crossing;
+        float past = ((startX + along * cos(headingRad) - cornerX) * cos(endRad)) +
+                     ((startY + along * sin(headingRad) - cornerY) * sin(endRad));
+
+        if ((fabs(along - inches.value) <= START_MOVE_TOLERANCE * inches.value) && (fabs(past) <= START_LEG_TOLERANCE)) {
+            distance = Inches(along);
+            lastTurn = turn_between(startHeading, START_HEADING + turn.value);
+            startLegAdjust = Inches(-past);
+        }
+    }
+
+    move_forward_inches(percent, distance);
+
+    if (lastTurn >= 0) {
+        turn_left_degrees(TURN_SPEED, Degrees(lastTurn));
+    } else {
+        turn_right_degrees(TURN_SPEED, Degrees(-lastTurn));
+    }
+}
+
+
+/*******************************************************
+ * @brief Called on each poll of the start light. Redraws the CdS value only
+ * when it has moved, and does the pre-start work.
+ *
+ * @param value CdS value just read
+ */
+void show_start_light(float value) {
+    static float shown = -1;
+
+    prepare_start();
+
+    if (fabs(value - shown) >= START_LIGHT_SHOW_CHANGE) {
+        LCD.WriteRC("CdS Value: ", 7, 2);
+        LCD.WriteRC(value, 7, 20);
+        shown = value;
+    }
+}
+
+/*******************************************************
+ * @brief Waits until the start light to run the course. The wait is also
+ * when prepare_start() does its work, so it is out of the timed run. The
+ * CdS cell is read every START_LIGHT_POLL_PERIOD, with the robot asleep in
+ * between.
  * 
  * @param timeToCheck time allotted to check for start light before timeout
+ * @param line Line it was called from (filled in automatically, used by the cost report)
  * @return int The status of the light
  *         1 -> ON
  *         0 -> OFF
  */
-int read_start_light(double timeToCheck) {
-    LCD.Clear();
-
-    double startTime = TimeNow();
+int read_start_light(double timeToCheck, int line) {
+    TimelineScope timeline("read_start_light", 0, COST_SENSOR_WAIT, line);
 
-    int lightOn = 0;
+    LCD.Clear();
 
     write_status("Waiting for light");
 
     // Waits until light is detected, or until time allotted is up (timeout)
-    while ((startTime - TimeNow() < timeToCheck) && !lightOn) {
-        // Writes out CdS value to the screen
-        LCD.WriteRC("CdS Value: ", 7, 2);
-        LCD.WriteRC(CdS_cell.Value(), 7, 20);
-
-        // Checks if any light is detected.
-        if (CdS_cell.Value() < 0.5) {
-            lightOn = 1;
-            write_status("GO!");
-        }
+    int lightOn = idle_wait_below(CdS_cell, START_LIGHT_THRESHOLD, timeToCheck, START_LIGHT_POLL_PERIOD, show_start_light) ? 1 : 0;
+    if (lightOn) {
+        write_status("GO!");
     }
 
     return lightOn;
 }
 
 /*******************************************************
- * @brief Moves CENTER OF ROBOT forward a number of inches using encoders
- * 
- * @param percent - Percent for the motors to run at. Negative for reverse.
- * @param inches - Inches to move forward .
+ * @brief Straight encoder move. Both motors run at the same percent.
+ *
+ * @param percent Percent that the motors will drive at (negative for backward)
+ * @param inches Inches to drive
  */
-void move_forward_inches(int percent, float inches) {
-    // Calculates desired counts based on the radius of the wheels and the robot
-    float expectedCounts = COUNT_PER_INCH * inches;
+DriveMove drive_forward_move(Percent percent, Inches inches) {
+    DriveMove move;
+    move.leftPercent = percent.value;
+    move.rightPercent = percent.value;
+    move.percent = percent;
+    move.straight = true;
+    move.inches = inches;
+    move.text = "Moving forward...";
+    move.column = 1;
+    return move;
+}
 
-    // Clears space for movement data and status
-    LCD.SetFontColor(BACKGROUND_COLOR);
-    LCD.FillRectangle(0,100,319,239);
-    LCD.SetFontColor(FONT_COLOR);
-    LCD.DrawHorizontalLine(100, 0, 319);
+/*******************************************************
+ * @brief Turn in place. The wheel going backward gets BACKWARDS_CALIBRATOR more.
+ *
+ * @param turn TURN_LEFT or TURN_RIGHT
+ * @param percent Percent for the motors to run at
+ * @param degrees Degrees to rotate
+ */
+DriveMove drive_turn_move(int turn, Percent percent, Degrees degrees) {
+    DriveMove move;
+    if (turn == TURN_RIGHT) {
+        move.leftPercent = percent.value;
+        move.rightPercent = -percent.value - BACKWARDS_CALIBRATOR;
+        move.text = "Turning Right...";
+    } else {
+        move.leftPercent = -percent.value - BACKWARDS_CALIBRATOR;
+        move.rightPercent = percent.value;
+        move.text = "Turning Left...";
+    }
+    move.percent = percent;
+    move.straight = false;
+    move.turn = turn;
+    move.degrees = degrees;
+    move.column = 2;
+    return move;
+}
 
-    // Writes out status to the screen
-    LCD.WriteRC("Moving forward...", 7, 1);
+/*******************************************************
+ * @brief Starts an encoder move: clears the screen for its data, scales it
+ * for the surface (distance scale or track width), resets the encoders and
+ * starts the motors. The caller then stops it at move.expectedCounts.
+ */
+void drive_move_start(DriveMove &move) {
+    // Clears space for movement data and writes out status to the screen
+    write_move_start(move.text, move.column);
+
+    // Learns from the last move, then scales this one for the surface it is on (as the turns have found it)
+    if (move.straight) {
+        distance_scale_motion_start(straight_direction(move.percent), true);
+        move.expectedCounts = inches_to_counts(distance_scale_apply(move.percent, move.inches));
+    } else {
+        distance_scale_motion_start(MOTION_TURN, true);
+        track_width_turn_start(move.turn, move.percent, move.degrees, true);
+        move.expectedCounts = degrees_to_counts(move.degrees, track_width_for(move.percent));
+    }
 
     // Resets encoder counts
     right_encoder.ResetCounts();
     left_encoder.ResetCounts();
 
-    // Sets both motors to same percentage, but accounts for one motor moving backwards
-    right_motor.SetPercent(percent);
-    left_motor.SetPercent(percent);
-
-    // Keeps running until average motor counts are in proper range
-    while((left_encoder.Counts() + right_encoder.Counts()) / 2. < expectedCounts);
+    right_motor.SetPercent(move.rightPercent);
+    left_motor.SetPercent(move.leftPercent);
+}
 
-    //Turn off motors
-    right_motor.Stop();
-    left_motor.Stop();
+/*******************************************************
+ * @brief Ends an encoder move once its motors are stopped
+ */
+void drive_move_finish(const DriveMove &move) {
+    distance_scale_motion_stop();
 
     //Print out data
-    LCD.WriteRC("Theoretical Counts: ", 9, 1);
-    LCD.WriteRC(expectedCounts, 9, 20);
-    LCD.WriteRC("Motor Percent: ", 10, 1);
-    LCD.WriteRC(percent, 10, 20);
-    LCD.WriteRC("Actual LE Counts: ", 11, 1);
-    LCD.WriteRC(left_encoder.Counts(), 11, 20);
-    LCD.WriteRC("Actual RE Counts: ", 12, 1);
-    LCD.WriteRC(right_encoder.Counts(), 12, 20);
+    write_move_data(move.expectedCounts, move.percent);
+}
+
+/*******************************************************
+ * @brief Moves CENTER OF ROBOT forward a number of inches using encoders
+ * 
+ * @param percent - Percent for the motors to run at. Negative for reverse.
+ * @param inches - Inches to move forward .
+ * @param line Line it was called from (filled in automatically, used by the cost report)
+ */
+void move_forward_inches(Percent percent, Inches inches, int line) {
+    TimelineScope timeline("move_forward_inches", inches.value, COST_MOTION, line);
+
+    DriveMove move = drive_forward_move(percent, inches);
+    drive_move_start(move);
+
+    // Keeps running until average motor counts are in proper range, then turns off motors
+    encoder_stop_wait(left_encoder, right_encoder, left_motor, right_motor, move.expectedCounts);
+    drive_move_finish(move);
 }
 
 /******************************************************* 
@@ -386,22 +1101,27 @@ void move_forward_inches(int percent, float inches) {
  * 
  * @param percent Percent that the motors will drive at
  * @param seconds Time that the motors will drive for
+ * @param line Line it was called from (filled in automatically, used by the cost report)
  */
-void move_forward_seconds(float percent, float seconds) {
+void move_forward_seconds(Percent percent, Seconds seconds, int line) {
+    TimelineScope timeline("move_forward_seconds", seconds.value, COST_MOTION, line);
 
-    if (percent < 0) {
-        percent -= BACKWARDS_CALIBRATOR;
+    distance_scale_motion_start(straight_direction(percent), false);
+
+    if (percent < 0_pct) {
+        percent.value -= BACKWARDS_CALIBRATOR;
     }
     
     // Set both motors to passed percentage
-    right_motor.SetPercent(percent);
-    left_motor.SetPercent(percent);
+    right_motor.SetPercent(percent.value);
+    left_motor.SetPercent(percent.value);
 
-    Sleep(seconds);
+    Sleep(seconds.value);
 
     // Turns off motors after elapsed time
     right_motor.Stop();
     left_motor.Stop();
+    distance_scale_motion_stop();
 }
 
 /*******************************************************
@@ -409,45 +1129,17 @@ void move_forward_seconds(float percent, float seconds) {
  * 
  * @param percent - Percent for the motors to run at. Negative for reverse.
  * @param degrees - Degrees to rotate.
+ * @param line Line it was called from (filled in automatically, used by the cost report)
  */
-void turn_right_degrees(int percent, float degrees) {
-
-    // Calculates desired counts based on the radius of the wheels and the robot
-    float expectedCounts = COUNT_PER_INCH * ((degrees * PI) / 180.0) * (ROBOT_WIDTH / 2);
+void turn_right_degrees(Percent percent, Degrees degrees, int line) {
+    TimelineScope timeline("turn_right_degrees", degrees.value, COST_MOTION, line);
 
-    // Clears space for movement data and status
-    LCD.SetFontColor(BACKGROUND_COLOR);
-    LCD.FillRectangle(0,100,319,239);
-    LCD.SetFontColor(FONT_COLOR);
-    LCD.DrawHorizontalLine(100, 0, 319);
-
-    // Writes out status to the screen
-    LCD.WriteRC("Turning Right...", 7, 2);
-
-    // Resets encoder counts
-    right_encoder.ResetCounts();
-    left_encoder.ResetCounts();
-
-    // Sets both motors to specific percentage
-    right_motor.SetPercent(-percent - BACKWARDS_CALIBRATOR);
-    left_motor.SetPercent(percent);
-
-    // Keeps running until average motor counts are in proper range
-    while((left_encoder.Counts() + right_encoder.Counts()) / 2. < expectedCounts);
-
-    //Turn off motors
-    right_motor.Stop();
-    left_motor.Stop();
+    DriveMove move = drive_turn_move(TURN_RIGHT, percent, degrees);
+    drive_move_start(move);
 
-    //Print out data
-    LCD.WriteRC("Theoretical Counts: ", 9, 1);
-    LCD.WriteRC(expectedCounts, 9, 20);
-    LCD.WriteRC("Motor Percent: ", 10, 1);
-    LCD.WriteRC(percent, 10, 20);
-    LCD.WriteRC("Actual LE Counts: ", 11, 1);
-    LCD.WriteRC(left_encoder.Counts(), 11, 20);
-    LCD.WriteRC("Actual RE Counts: ", 12, 1);
-    LCD.WriteRC(right_encoder.Counts(), 12, 20);
+    // Keeps running until average motor counts are in proper range, then turns off motors
+    encoder_stop_wait(left_encoder, right_encoder, left_motor, right_motor, move.expectedCounts);
+    drive_move_finish(move);
 }
 
 /*******************************************************
@@ -455,45 +1147,17 @@ void turn_right_degrees(int percent, float degrees) {
  * 
  * @param percent - Percent for the motors to run at. Negative for reverse.
  * @param degrees - Degrees to rotate.
+ * @param line Line it was called from (filled in automatically, used by the cost report)
  */
-void turn_left_degrees(int percent, float degrees) {
-
-    // Calculates desired counts based on the radius of the wheels and the robot
-    float expectedCounts = COUNT_PER_INCH * ((degrees * PI) / 180.0) * (ROBOT_WIDTH / 2);
-
-    // Clears space for movement data and status
-    LCD.SetFontColor(BACKGROUND_COLOR);
-    LCD.FillRectangle(0,100,319,239);
-    LCD.SetFontColor(FONT_COLOR);
-    LCD.DrawHorizontalLine(100, 0, 319);
-
-    // Writes out status to the screen
-    LCD.WriteRC("Turning Left...", 7, 2);
-
-    // Resets encoder counts
-    right_encoder.ResetCounts();
-    left_encoder.ResetCounts();
-
-    // Sets both motors to specific percentage
-    right_motor.SetPercent(percent);
-    left_motor.SetPercent(-percent - BACKWARDS_CALIBRATOR);
+void turn_left_degrees(Percent percent, Degrees degrees, int line) {
+    TimelineScope timeline("turn_left_degrees", degrees.value, COST_MOTION, line);
 
-    // Keeps running until average motor counts are in proper range
-    while((left_encoder.Counts() + right_encoder.Counts()) / 2. < expectedCounts);
+    DriveMove move = drive_turn_move(TURN_LEFT, percent, degrees);
+    drive_move_start(move);
 
-    //Turn off motors
-    right_motor.Stop();
-    left_motor.Stop();
-    
-    //Print out data
-    LCD.WriteRC("Theoretical Counts: ", 9, 1);
-    LCD.WriteRC(expectedCounts, 9, 20);
-    LCD.WriteRC("Motor Percent: ", 10, 1);
-    LCD.WriteRC(percent, 10, 20);
-    LCD.WriteRC("Actual LE Counts: ", 11, 1);
-    LCD.WriteRC(left_encoder.Counts(), 11, 20);
-    LCD.WriteRC("Actual RE Counts: ", 12, 1);
-    LCD.WriteRC(right_encoder.Counts(), 12, 20);
+    // Keeps running until average motor counts are in proper range, then turns off motors
+    encoder_stop_wait(left_encoder, right_encoder, left_motor, right_motor, move.expectedCounts);
+    drive_move_finish(move);
 }
 
 /*******************************************************
@@ -501,8 +1165,11 @@ void turn_left_degrees(int percent, float degrees) {
  * 
  * @param heading Heading to correct to in degrees
  * @param secondsToCheck Time allotted before timeout
+ * @param line Line it was called from (filled in automatically, used by the cost report)
  */
-void RPS_correct_heading(float heading, double secondsToCheck) {
+void RPS_correct_heading(float heading, double secondsToCheck, int line) {
+    TimelineScope timeline("RPS_correct_heading", heading, COST_RPS, line);
+
     /*
      * Determines the direction to turn to get to the desired heading faster
      * 1 -> CW
@@ -529,17 +1196,23 @@ void RPS_correct_heading(float heading, double secondsToCheck) {
     while(((RPS.Heading() >= 0) && (difference > RPS_TURN_THRESHOLD)) && (TimeNow() - startTime < secondsToCheck))
     {
         // Checks which way to turn to turn the least
-        if (RPS.Heading() < heading) {
-            direction = 1;
-        } else {
-            direction = -1;
-        }
+        {
+            ProbeScope probe(PROBE_RPS_HEADING);
+
+            if (RPS.Heading() < heading) {
+                direction = 1;
+            } else {
+                direction = -1;
+            }
 
-        if (abs(RPS.Heading() - heading) > 180) {
-            direction = -direction;
+            if (abs(RPS.Heading() - heading) > 180) {
+                direction = -direction;
+            }
         }
 
         // Pulses towards the ideal position
+        distance_scale_motion_start(MOTION_NUDGE, false);
+        track_width_turn_start((direction == 1) ? TURN_LEFT : TURN_RIGHT, Percent(RPS_TURN_PULSE_PERCENT), 0_deg, false);
         if (direction == 1) {
 
             // PULSES COUNTERCLOCKWISE
@@ -569,6 +1242,7 @@ void RPS_correct_heading(float heading, double secondsToCheck) {
             left_motor.Stop();
 
         }
+        distance_scale_motion_stop();
 
         if (TimeNow() - startTime > secondsToCheck) {
             break;
@@ -587,7 +1261,11 @@ void RPS_correct_heading(float heading, double secondsToCheck) {
         }
 
         show_RPS_data();
+        telemetry_sample(TELEMETRY_RPS);
     }
+
+    distance_scale_check();
+    track_width_check();
 }
 
 /*******************************************************
@@ -596,8 +1274,10 @@ void RPS_correct_heading(float heading, double secondsToCheck) {
  * 
  * @param x_coord Desired x-coord of the robot
  * @param secondsToCheck Time to check before timeout
+ * @param line Line it was called from (filled in automatically, used by the cost report)
  */
-void RPS_check_x(float x_coord, double secondsToCheck) {
+void RPS_check_x(float x_coord, double secondsToCheck, int line) {
+    TimelineScope timeline("RPS_check_x", x_coord, COST_RPS, line);
 
     // Directions the robot needs to be facing to correct x-coord
     enum { EAST, WEST };
@@ -633,7 +1313,7 @@ void RPS_check_x(float x_coord, double secondsToCheck) {
 
     if (orientationRecorded) {
         // Determine the direction of the motors based on the direction the robot is facing
-        int power = RPS_TRANSLATIONAL_PULSE_PERCENT;
+        Percent power = RPS_TRANSLATIONAL_PULSE_PERCENT;
         if(direction == WEST){
             power = -RPS_TRANSLATIONAL_PULSE_PERCENT;
         }
@@ -661,12 +1341,16 @@ void RPS_check_x(float x_coord, double secondsToCheck) {
             Sleep(RPS_DELAY_TIME);
 
             show_RPS_data();
+            telemetry_sample(TELEMETRY_RPS);
 
         }
     }
     else {
         write_status("ERROR. RPS NOT READING.");
     }
+
+    // RPS has caught up after the last pulse, so the straight motions before it can be a sample
+    distance_scale_check();
     
 }
 
@@ -676,8 +1360,10 @@ void RPS_check_x(float x_coord, double secondsToCheck) {
  * 
  * @param y_coord Desired y-coord of the robot
  * @param secondsToCheck Time to check before timeout
+ * @param line Line it was called from (filled in automatically, used by the cost report)
  */
-void RPS_check_y(float y_coord, double secondsToCheck) {
+void RPS_check_y(float y_coord, double secondsToCheck, int line) {
+    TimelineScope timeline("RPS_check_y", y_coord, COST_RPS, line);
 
     // Directions the robot needs to be facing to correct y-coord
     enum { NORTH, SOUTH };
@@ -713,7 +1399,7 @@ void RPS_check_y(float y_coord, double secondsToCheck) {
 
     if (orientationRecorded) {
         // Determine the direction of the motors based on the direction the robot is facing
-        int power = RPS_TRANSLATIONAL_PULSE_PERCENT;
+        Percent power = RPS_TRANSLATIONAL_PULSE_PERCENT;
         if(direction == SOUTH){
             power = -RPS_TRANSLATIONAL_PULSE_PERCENT;
         }
@@ -741,203 +1427,707 @@ void RPS_check_y(float y_coord, double secondsToCheck) {
             Sleep(RPS_DELAY_TIME);
 
             show_RPS_data();
+            telemetry_sample(TELEMETRY_RPS);
         }
     }
     else {
         write_status("ERROR. RPS NOT READING.");
     }
-}
 
-/*******************************************************************/
-// PID STUFF
+    // RPS has caught up after the last pulse, so the straight motions before it can be a sample
+    distance_scale_check();
+}
 
 /*******************************************************
- * @brief Resets all PID global variables to initial values.
+ * @brief Where a tool is on the course for a robot pose
  * 
+ * @param tool Tool frame
+ * @param x X of the wheel axis center
+ * @param y Y of the wheel axis center
+ * @param heading Heading in degrees (0 faces +x, counterclockwise)
+ * @param toolX X of the tool (out)
+ * @param toolY Y of the tool (out)
  */
-void ResetPIDVariables() {
-    
-    // Resets all variables to inital state
-    PID_Linear_SpeedR = 0;
-    PID_New_CountsR = 0;
-    PID_Last_CountsR = 0;
-    PID_New_TimeR = 0;
-    PID_Last_TimeR = 0;
-    PID_New_Speed_ErrorR = 0;
-    PID_Last_Speed_ErrorR = 0;
-    PID_OLD_MOTOR_POWERR = 0;
-    PID_NEW_MOTOR_POWERR = 0;
-    PID_Linear_SpeedR = 0;
-    PTermR = 0;
-    ITermR = 0;
-    DTermR = 0;
-
-    PID_Linear_SpeedL = 0;
-    PID_New_CountsL = 0;
-    PID_Last_CountsL = 0;
-    PID_New_TimeL = 0;
-    PID_Last_TimeL = 0;
-    PID_New_Speed_ErrorL = 0;
-    PID_Last_Speed_ErrorL = 0;
-    PID_OLD_MOTOR_POWERL = 0;
-    PID_NEW_MOTOR_POWERL = 0;
-    PID_Linear_SpeedL = 0;
-    PTermL = 0;
-    ITermL = 0;
-    DTermL = 0;
-    
-    // Records initial time
-    PID_TIME = TimeNow();
-
-    // Resets encoders
-    left_encoder.ResetCounts();
-    right_encoder.ResetCounts();
+void tool_position(const ToolFrame &tool, float x, float y, float heading, float &toolX, float &toolY) {
+    float headingRad = heading * PI / 180.0f;
+    float c = cos(headingRad);
+    float s = sin(headingRad);
 
-    Sleep(0.15);
+    toolX = x + (tool.forward.value * c) - (tool.left.value * s);
+    toolY = y + (tool.forward.value * s) + (tool.left.value * c);
 }
 
 /*******************************************************
- * @brief Makes adjustments to right motor based on expected speed, counts, and current motor speed.
+ * @brief Moves the robot so a tool ends up at (x, y), keeping the heading
+ * the robot has now. When the target is straight ahead of or behind the tool
+ * it is one move along the heading. Otherwise the robot turns towards where
+ * the wheel axis has to go (or away from it, to reverse there), drives there
+ * and turns back. RPS is read once it has caught up with the last motion.
  * 
- * @param expectedSpeed Expected speed for motor in inches per second
- * @return float Correction value used to change motor in move functions
- */
-float RightPIDAdjustment(double expectedSpeed) {
+ * @param tool Tool frame to put on the target
+ * @param x Target x
+ * @param y Target y
+ * @param line Line it was called from (filled in automatically, used by the cost report)
+ * 
+ * @pre RPS must be initialized.
+ */
+void move_tool_to(const ToolFrame &tool, float x, float y, int line) {
+    TimelineScope timeline("move_tool_to", tool.forward.value, COST_MOTION, line);
 
-    // Finds change in counts since last time
-    PID_Last_CountsR = PID_New_CountsR;
-    PID_New_CountsR = right_encoder.Counts();
-    
-    // Finds change in time since last time
-    PID_Last_TimeR = PID_New_TimeR;
-    PID_New_TimeR = TimeNow();
+    // RPS still shows where the robot was before the last motion for a while
+    double sinceStop = TimeNow() - distanceScaleStopTime;
+    if (sinceStop < RPS_DELAY_TIME) {
+        Sleep(RPS_DELAY_TIME - sinceStop);
+    }
 
-    // Finds actual velocity
-    PID_Linear_SpeedR = (PID_DISTANCE_PER_COUNT * ((PID_New_CountsR - PID_Last_CountsR) / (PID_New_TimeR - PID_Last_TimeR)));
+    float heading = RPS.Heading();
+    float axisX = RPS.X();
+    float axisY = RPS.Y();
+    if (heading < 0) {
+        write_status("ERROR. RPS NOT READING.");
+        return;
+    }
 
-    // Finds error
-    PID_New_Speed_ErrorR = expectedSpeed - PID_Linear_SpeedR;
+    float toolX, toolY;
+    tool_position(tool, axisX, axisY, heading, toolX, toolY);
 
-    // Adds error to error sum
-    PID_Error_SumR += PID_New_Speed_ErrorR;
+    // How far the tool is from the target, along the heading and to the left of it
+    float headingRad = heading * PI / 180.0f;
+    float errorX = x - toolX;
+    float errorY = y - toolY;
+    float along = (errorX * cos(headingRad)) + (errorY * sin(headingRad));
+    float lateral = (errorY * cos(headingRad)) - (errorX * sin(headingRad));
 
-    // Calculates PTerm
-    PTermR = PID_New_Speed_ErrorR * PConstR;
+    if (fabs(lateral) <= TOOL_LATERAL_TOLERANCE) {
+        if (along >= 0) {
+            move_forward_inches(FORWARD_SPEED, Inches(along));
+        } else {
+            move_forward_inches(-FORWARD_SPEED, Inches(-along));
+        }
+        return;
+    }
 
-    // Calculates ITerm
-    ITermR = PID_Error_SumR * IConstR;
+    // Off to the side, so the wheel axis moves by the same amount as the tool
+    float distance = sqrt((errorX * errorX) + (errorY * errorY));
+    float turn = atan2(errorY, errorX) * 180.0f / PI - heading;
+    while (turn > 180) {
+        turn -= 360;
+    }
+    while (turn <= -180) {
+        turn += 360;
+    }
 
-    // Calculates DTerm
-    DTermR = (PID_New_Speed_ErrorR - PID_Last_Speed_ErrorR) * DConstR;
+    // A target behind the robot is reached in reverse, so the turn stays under 90 degrees
+    Percent percent = FORWARD_SPEED;
+    if (turn > 90) {
+        turn -= 180;
+        percent = -FORWARD_SPEED;
+    } else if (turn < -90) {
+        turn += 180;
+        percent = -FORWARD_SPEED;
+    }
 
-    // Saves past error
-    PID_Last_Speed_ErrorR = PID_New_Speed_ErrorR;
+    if (turn >= 0) {
+        turn_left_degrees(TURN_SPEED, Degrees(turn));
+        move_forward_inches(percent, Inches(distance));
+        turn_right_degrees(TURN_SPEED, Degrees(turn));
+    } else {
+        turn_right_degrees(TURN_SPEED, Degrees(-turn));
+        move_forward_inches(percent, Inches(distance));
+        turn_left_degrees(TURN_SPEED, Degrees(-turn));
+    }
+}
 
-    return (PID_OLD_MOTOR_POWERR + PTermR + ITermR + DTermR);
+/*******************************************************
+ * @brief Corrects the position of a tool with RPS. Corrects x when the robot
+ * faces along x (RPS_check_x()) and y when it faces along y (RPS_check_y()).
+ * 
+ * @param tool Tool frame to correct
+ * @param x Target x of the tool
+ * @param y Target y of the tool
+ * @param secondsToCheck Time to check before timeout
+ * @param line Line it was called from (filled in automatically, used by the cost report)
+ * 
+ * @pre RPS must be initialized.
+ */
+void RPS_check_tool(const ToolFrame &tool, float x, float y, double secondsToCheck, int line) {
+    double sinceStop = TimeNow() - distanceScaleStopTime;
+    if (sinceStop < RPS_DELAY_TIME) {
+        Sleep(RPS_DELAY_TIME - sinceStop);
+    }
+
+    float heading = RPS.Heading();
+    if (heading < 0) {
+        write_status("ERROR. RPS NOT READING.");
+        return;
+    }
+
+    // Where the wheel axis has to be for the tool to be on the target, at the current heading
+    float axisX, axisY;
+    ToolFrame back = { tool.name, -tool.forward, -tool.left };
+    tool_position(back, x, y, heading, axisX, axisY);
+
+    float headingRad = heading * PI / 180.0f;
+    if (fabs(cos(headingRad)) >= fabs(sin(headingRad))) {
+        RPS_check_x(axisX, secondsToCheck, line);
+    } else {
+        RPS_check_y(axisY, secondsToCheck, line);
+    }
 }
 
+/************************************************/
+// Distance scale. Straight motions (a move and the RPS pulses after it) that
+// start and end with the robot still and a good RPS fix compare the encoder
+// inches to the RPS inches, and keep a running scale for each surface and
+// direction. Turns in between are fine, they don't move the RPS point. move_forward_inches() divides by it, so later open loop moves
+// need fewer RPS corrections.
+
 /*******************************************************
- * @brief Makes adjustments to left motor based on expected speed, counts, and current motor speed.
+ * @brief Which surface a point on the course is
+ *
+ * @return int SURFACE_RAMP on the ramp, SURFACE_FLOOR anywhere else
+ */
+int distance_scale_surface_at(float x, float y) {
+    if ((x >= DISTANCE_SCALE_RAMP_X0) && (x <= DISTANCE_SCALE_RAMP_X1) &&
+        (y >= DISTANCE_SCALE_RAMP_Y0) && (y <= DISTANCE_SCALE_RAMP_Y1)) {
+        return SURFACE_RAMP;
+    }
+    return SURFACE_FLOOR;
+}
+
+/*******************************************************
+ * @brief Which surface a straight path is on. A path up the ramp starts and
+ * ends off it, so the middle is checked too.
+ *
+ * @return int SURFACE_RAMP if any of it is on the ramp
+ */
+int distance_scale_surface_along(float x0, float y0, float x1, float y1) {
+    if ((distance_scale_surface_at(x0, y0) == SURFACE_RAMP) ||
+        (distance_scale_surface_at((x0 + x1) / 2, (y0 + y1) / 2) == SURFACE_RAMP) ||
+        (distance_scale_surface_at(x1, y1) == SURFACE_RAMP)) {
+        return SURFACE_RAMP;
+    }
+    return SURFACE_FLOOR;
+}
+
+/*******************************************************
+ * @brief Which way a straight motion at a motor percent goes
+ */
+int straight_direction(Percent percent) {
+    return (percent < 0_pct) ? MOTION_BACKWARD : MOTION_FORWARD;
+}
+
+/*******************************************************
+ * @brief Reads where the robot is, if it has been still long enough for RPS
+ * to catch up and RPS can see it
+ *
+ * @return bool true if distanceScaleX/Y were just read
+ */
+bool distance_scale_fix() {
+    if (distanceScaleMoving || (TimeNow() - distanceScaleStopTime < RPS_DELAY_TIME)) {
+        return false;
+    }
+
+    float x = RPS.X();
+    float y = RPS.Y();
+    if ((x <= 0) || (y <= 0)) {
+        return false;
+    }
+
+    distanceScaleX = x;
+    distanceScaleY = y;
+    distanceScaleKnown = true;
+    return true;
+}
+
+/*******************************************************
+ * @brief Adds the encoder counts since the last read to the straight motions,
+ * taking them away for a motion the other way and skipping turns. The encoders
+ * count up either way.
+ */
+void distance_scale_count() {
+    int counts = left_encoder.Counts() + right_encoder.Counts();
+    int sign = 0;
+    if (distanceScaleMotion == distanceScaleDirection) {
+        sign = 1;
+    } else if (distanceScaleMotion == -distanceScaleDirection) {
+        sign = -1;
+    }
+    distanceScaleInches += sign * (counts - distanceScaleCounts) * INCH_PER_COUNT / 2;
+    distanceScaleCounts = counts;
+}
+
+/*******************************************************
+ * @brief If straight motions are waiting and RPS has caught up with the
+ * robot, their encoder inches and RPS inches become a sample. Called before
+ * every motion and after the RPS checks.
+ */
+void distance_scale_check() {
+    if (!distanceScaleChain || !distance_scale_fix()) {
+        return;
+    }
+    distance_scale_count();
+    distanceScaleChain = false;
+    distanceScaleClosed = false;
+
+    if (distanceScaleInches < DISTANCE_SCALE_MIN_INCHES) {
+        return;
+    }
+
+    float dx = distanceScaleX - distanceScaleStartX;
+    float dy = distanceScaleY - distanceScaleStartY;
+    float sample = sqrt((dx * dx) + (dy * dy)) / distanceScaleInches;
+    if (fabs(sample - 1) > DISTANCE_SCALE_LIMIT) {
+        return;
+    }
+
+    // Averages evenly with the starting 1 until there are a few samples, then weights new ones more
+    int surface = distance_scale_surface_along(distanceScaleStartX, distanceScaleStartY, distanceScaleX, distanceScaleY);
+    int direction = (distanceScaleDirection == MOTION_BACKWARD) ? 1 : 0;
+    int &samples = distanceScaleSamples[surface][direction];
+    samples++;
+    float gain = 1.0f / (samples + 1);
+    if (gain < DISTANCE_SCALE_GAIN) {
+        gain = DISTANCE_SCALE_GAIN;
+    }
+
+    float &scale = distanceScale[surface][direction];
+    scale += gain * (sample - scale);
+}
+
+/*******************************************************
+ * @brief Call before any motion, before the encoders are reset. The robot
+ * turns about the point RPS reports, so a turn doesn't move it: the straight
+ * motions before a turn still become a sample once RPS catches up, unless
+ * another straight motion starts first. A straight motion from still with a
+ * good RPS fix starts new ones.
+ *
+ * @param motion MOTION_FORWARD, MOTION_BACKWARD, MOTION_TURN or MOTION_NUDGE
+ * @param resetsCounts Whether the motion resets the encoders
+ */
+void distance_scale_motion_start(int motion, bool resetsCounts) {
+    distance_scale_check();
+
+    if (distanceScaleChain) {
+        distance_scale_count();
+    }
+
+    bool straight = (motion == MOTION_FORWARD) || (motion == MOTION_BACKWARD);
+
+    // A turn sample can't have a straight motion in it
+    track_width_check();
+    if (straight) {
+        trackWidthChain = false;
+    }
+
+    if (!straight) {
+        distanceScaleClosed = distanceScaleChain;
+    } else if (distanceScaleClosed) {
+        distanceScaleChain = false;
+        distanceScaleClosed = false;
+    }
+
+    // Remembers where a straight motion from still starts
+    distanceScaleSettled = distance_scale_fix();
+    if (straight && !distanceScaleChain && distanceScaleSettled) {
+        distanceScaleStartX = distanceScaleX;
+        distanceScaleStartY = distanceScaleY;
+        distanceScaleDirection = motion;
+        distanceScaleInches = 0;
+        distanceScaleChain = true;
+    }
+
+    if (resetsCounts) {
+        distanceScaleCounts = 0;
+    } else if (distanceScaleChain) {
+        distanceScaleCounts = left_encoder.Counts() + right_encoder.Counts();
+    }
+    distanceScaleMotion = motion;
+    distanceScaleMoving = true;
+}
+
+/*******************************************************
+ * @brief Call once the motors are stopped
+ */
+void distance_scale_motion_stop() {
+    distanceScaleMoving = false;
+    distanceScaleStopTime = TimeNow();
+
+    // Turns don't move the RPS point, straight motions do
+    if ((distanceScaleMotion == MOTION_FORWARD) || (distanceScaleMotion == MOTION_BACKWARD)) {
+        distanceScaleKnown = false;
+    }
+}
+
+/*******************************************************
+ * @brief Encoder inches to drive for a move of some real inches. Call after
+ * distance_scale_motion_start(). The surface comes from where the robot was
+ * last seen still, along its heading when that is fresh too.
+ *
+ * @param percent Motor percent of the move (the sign is the direction)
+ * @param inches Real inches to go
+ * @return Inches Inches for the encoders
+ */
+Inches distance_scale_apply(Percent percent, Inches inches) {
+    int direction = (percent < 0_pct) ? 1 : 0;
+
+    int surface = SURFACE_FLOOR;
+    if (distanceScaleKnown) {
+        surface = distance_scale_surface_at(distanceScaleX, distanceScaleY);
+
+        float heading = distanceScaleSettled ? RPS.Heading() : -1;
+        if (heading >= 0) {
+            float distance = direction ? -inches.value : inches.value;
+            float headingRad = heading * PI / 180.0f;
+            surface = distance_scale_surface_along(distanceScaleX, distanceScaleY, distanceScaleX + distance * cos(headingRad),
+                                                   distanceScaleY + distance * sin(headingRad));
+        }
+    }
+
+    return inches / distanceScale[surface][direction];
+}
+
+/*******************************************************
+ * @brief Which speed a turn's width is kept under
+ *
+ * @return int 0 for slow turns, 1 for fast ones
+ */
+int track_width_speed(Percent percent) {
+    return (fabs(percent.value) >= TRACK_WIDTH_FAST_PERCENT.value) ? 1 : 0;
+}
+
+/*******************************************************
+ * @brief Width to turn with, for the surface the robot was last seen on
+ * (turns don't move the RPS point) and the turn's motor percent
+ */
+float track_width_for(Percent percent) {
+    int surface = SURFACE_FLOOR;
+    if (distanceScaleKnown) {
+        surface = distance_scale_surface_at(distanceScaleX, distanceScaleY);
+    }
+    return trackWidths.width[surface][track_width_speed(percent)];
+}
+
+/*******************************************************
+ * @brief Adds the encoder counts since the last read to the turns. Read at
+ * the next turn or at the still fix, so the coast after the motors stop is
+ * in it. The encoders count up either way, so the way comes from the turn.
+ */
+void track_width_count() {
+    int counts = left_encoder.Counts() + right_encoder.Counts();
+    trackWidthInches += trackWidthTurn * (counts - trackWidthCounts) * INCH_PER_COUNT / 2;
+    trackWidthCounts = counts;
+}
+
+/*******************************************************
+ * @brief If turns are waiting and RPS has caught up with the robot, the
+ * heading they made and the inches the wheels went become a sample. A turn
+ * is usually followed by RPS_correct_heading(), which reads RPS before it
+ * settles, so its pulses are part of the sample and it ends at the still fix
+ * after the last one.
+ */
+void track_width_check() {
+    if (!trackWidthChain || !distance_scale_fix()) {
+        return;
+    }
+
+    float heading = RPS.Heading();
+    if (heading < 0) {
+        return;
+    }
+    track_width_count();
+    trackWidthChain = false;
+
+    // Picks the full turns (RPS only sees 0 to 360) that the encoders agree with
+    float &width = trackWidths.width[trackWidthSurface][trackWidthSpeed];
+    float expected = (2 * trackWidthInches / width) * 180.0f / PI;
+    float turned = heading - trackWidthStartHeading;
+    turned += 360.0f * round((expected - turned) / 360.0f);
+    if (fabs(turned) < TRACK_WIDTH_MIN_DEGREES) {
+        return;
+    }
+
+    float sample = 2 * trackWidthInches / (turned * PI / 180.0f);
+    if (fabs(sample / ROBOT_WIDTH - 1) > TRACK_WIDTH_LIMIT) {
+        return;
+    }
+
+    // Averages evenly with the starting width until there are a few samples, then weights new ones more
+    int &samples = trackWidths.samples[trackWidthSurface][trackWidthSpeed];
+    samples++;
+    float gain = 1.0f / (samples + 1);
+    if (gain < TRACK_WIDTH_GAIN) {
+        gain = TRACK_WIDTH_GAIN;
+    }
+    width += gain * (sample - width);
+}
+
+/*******************************************************
+ * @brief Call before a turn or heading pulse, after
+ * distance_scale_motion_start() and before the encoders are reset. A turn of
+ * at least TRACK_WIDTH_MIN_DEGREES from still with a good RPS fix starts new
+ * turns for a sample. Smaller ones only add to turns already started. Turning
+ * back before the last turn has settled drops them.
+ *
+ * @param turn TURN_LEFT or TURN_RIGHT
+ * @param percent Motor percent of the turn
+ * @param degrees Degrees it is meant to turn (0 if not known)
+ * @param resetsCounts Whether the turn resets the encoders
+ */
+void track_width_turn_start(int turn, Percent percent, Degrees degrees, bool resetsCounts) {
+    if (trackWidthChain) {
+        track_width_count();
+
+        // Turning back while the last turn still coasts, the encoders can't tell the two apart
+        if ((turn != trackWidthTurn) && (TimeNow() - distanceScaleStopTime < RPS_DELAY_TIME)) {
+            trackWidthChain = false;
+        }
+    }
+
+    if (!trackWidthChain && (degrees.value >= TRACK_WIDTH_MIN_DEGREES) && distanceScaleSettled && (RPS.Heading() >= 0)) {
+        trackWidthStartHeading = RPS.Heading();
+        trackWidthSurface = distance_scale_surface_at(distanceScaleX, distanceScaleY);
+        trackWidthSpeed = track_width_speed(percent);
+        trackWidthInches = 0;
+        trackWidthChain = true;
+    }
+
+    trackWidthTurn = turn;
+    trackWidthCounts = resetsCounts ? 0 : (left_encoder.Counts() + right_encoder.Counts());
+}
+
+
+/*******************************************************************/
+// PID STUFF
+
+/*******************************************************
+ * @brief Resets all PID global variables to initial values.
  * 
- * @param expectedSpeed Expected speed for motor in inches per second
- * @return float Correction value used to change motor in move functions
  */
-float LeftPIDAdjustment(double expectedSpeed) {
-    
-    // Finds change in counts since last time
-    PID_Last_CountsL = PID_New_CountsL;
-    PID_New_CountsL = left_encoder.Counts();
+void ResetPIDVariables() {
     
-    // Finds change in time since last time
-    PID_Last_TimeL = PID_New_TimeL;
-    PID_New_TimeL = TimeNow();
+    // Records initial time
+    PID_TIME = TimeNow();
 
-    // Finds actual velocity
-    PID_Linear_SpeedL = (PID_DISTANCE_PER_COUNT * ((PID_New_CountsL - PID_Last_CountsL) / (PID_New_TimeL - PID_Last_TimeL)));
+    // Resets all variables to inital state
+    pid_reset(PID_Right, PID_TIME);
+    PID_OLD_MOTOR_POWERR = 0;
+    PID_NEW_MOTOR_POWERR = 0;
 
-    // Finds error
-    PID_New_Speed_ErrorL = expectedSpeed - PID_Linear_SpeedL;
+    pid_reset(PID_Left, PID_TIME);
+    PID_OLD_MOTOR_POWERL = 0;
+    PID_NEW_MOTOR_POWERL = 0;
 
-    // Adds error to error sum
-    PID_Error_SumL += PID_New_Speed_ErrorL;
+    // Resets encoders
+    left_encoder.ResetCounts();
+    right_encoder.ResetCounts();
 
-    // Calculates PTerm
-    PTermL = PID_New_Speed_ErrorL * PConstL;
+    Sleep(0.15);
+}
 
-    // Calculates ITerm
-    ITermL = PID_Error_SumL * IConstL;
+/*******************************************************
+ * @brief Makes adjustments to right motor based on expected speed, counts, and current motor speed.
+ * 
+ * @param expectedSpeed Expected speed for motor in inches per second
+ * @return float Correction value used to change motor in move functions
+ */
+float RightPIDAdjustment(control_t expectedSpeed) {
+    ProbeScope probe(PROBE_PID_RIGHT);
 
-    // Calculates DTerm
-    DTermL = (PID_New_Speed_ErrorL - PID_Last_Speed_ErrorL) * DConstL;
+    // Counts first, then the time they were read at
+    int counts = right_encoder.Counts();
+    double now = TimeNow();
 
-    // Saves past error
-    PID_Last_Speed_ErrorL = PID_New_Speed_ErrorL;
+    return pid_adjust(PID_Right, PID_DISTANCE_PER_COUNT, counts, now, expectedSpeed, PID_OLD_MOTOR_POWERR);
+}
 
-    return (PID_OLD_MOTOR_POWERL + PTermL + ITermL + DTermL);
+/*******************************************************
+ * @brief Makes adjustments to left motor based on expected speed, counts, and current motor speed.
+ * 
+ * @param expectedSpeed Expected speed for motor in inches per second
+ * @return float Correction value used to change motor in move functions
+ */
+float LeftPIDAdjustment(control_t expectedSpeed) {
+    ProbeScope probe(PROBE_PID_LEFT);
+
+    // Counts first, then the time they were read at
+    int counts = left_encoder.Counts();
+    double now = TimeNow();
+
+    return pid_adjust(PID_Left, PID_DISTANCE_PER_COUNT, counts, now, expectedSpeed, PID_OLD_MOTOR_POWERL);
 }
 
 /*******************************************************
  * @brief Uses PID to move forward a number of inches at a specific speed in inches per second.
  * 
- * @param in_per_sec Speed to move forward at in inches per second
+ * @param speed Speed to move forward at
  * @param inches Inches to move forward
+ * @param line Line it was called from (filled in automatically, used by the cost report)
  */
-void move_forward_PID(float in_per_sec, float inches) {
+void move_forward_PID(InchesPerSecond speed, Inches inches, int line) {
+    TimelineScope timeline("move_forward_PID", inches.value, COST_MOTION, line);
+
+    distance_scale_motion_start(MOTION_FORWARD, true);
 
     ResetPIDVariables();
 
     // Moves forward until average counts are above inches
-    while ((((left_encoder.Counts() + right_encoder.Counts()) / 2) * PID_DISTANCE_PER_COUNT) < inches) {
-        
-        // Calculates corrections to make
-        PID_NEW_MOTOR_POWERR = RightPIDAdjustment(in_per_sec);
-        PID_NEW_MOTOR_POWERL = LeftPIDAdjustment(in_per_sec);
-        
-        // Applies corrections
-        right_motor.SetPercent(PID_NEW_MOTOR_POWERR);
-        left_motor.SetPercent(PID_NEW_MOTOR_POWERL);
+    while ((((left_encoder.Counts() + right_encoder.Counts()) / 2) * PID_DISTANCE_PER_COUNT) < inches.value) {
+        {
+            ProbeScope probe(PROBE_PID_LOOP);
+
+            // Calculates corrections to make
+            PID_NEW_MOTOR_POWERR = RightPIDAdjustment(speed.value);
+            PID_NEW_MOTOR_POWERL = LeftPIDAdjustment(speed.value);
+
+            // Applies corrections
+            right_motor.SetPercent(PID_NEW_MOTOR_POWERR);
+            left_motor.SetPercent(PID_NEW_MOTOR_POWERL);
+
+            // Records old motor values for future corrections
+            PID_OLD_MOTOR_POWERR = PID_NEW_MOTOR_POWERR;
+            PID_OLD_MOTOR_POWERL = PID_NEW_MOTOR_POWERL;
 
-        // Records old motor values for future corrections
-        PID_OLD_MOTOR_POWERR = PID_NEW_MOTOR_POWERR;
-        PID_OLD_MOTOR_POWERL = PID_NEW_MOTOR_POWERL;
+            telemetry_sample_pid(PID_Left, PID_Right);
+        }
 
         Sleep(SLEEP_PID);
     }
 
     right_motor.Stop();
     left_motor.Stop();
+    distance_scale_motion_stop();
     
 }
 
 /*******************************************************
  * @brief Initiates both servos, sets min/max values and 
- * turns it to starting rotation.
+ * turns it to starting rotation. Uses the calibration file if
+ * there is one, the #define values if not.
  */
 void initiate_servos() {
+
+    // Loads the last calibration sweep
+    ServoCalibration base = { BASE_SERVO_MIN, BASE_SERVO_MAX, ARM_SERVO_SPEED };
+    ServoCalibration onArm = { ON_ARM_SERVO_MIN, ON_ARM_SERVO_MAX, ARM_SERVO_SPEED };
+    servo_calibration_load(SERVO_CALIBRATION_FILE, base, onArm);
     
     // Calibrates base servo
-    base_servo.SetMin(BASE_SERVO_MIN);
-    base_servo.SetMax(BASE_SERVO_MAX);
+    base_servo.SetMin(base.minPulse);
+    base_servo.SetMax(base.maxPulse);
 
     // Calibrate on-arm servo
-    on_arm_servo.SetMin(ON_ARM_SERVO_MIN);
-    on_arm_servo.SetMax(ON_ARM_SERVO_MAX);
+    on_arm_servo.SetMin(onArm.minPulse);
+    on_arm_servo.SetMax(onArm.maxPulse);
+
+    // The arm plans use the same travel and speed
+    armModel.base.minPulse = base.minPulse;
+    armModel.base.maxPulse = base.maxPulse;
+    armModel.base.speed = base.speed;
+    armModel.onArm.minPulse = onArm.minPulse;
+    armModel.onArm.maxPulse = onArm.maxPulse;
+    armModel.onArm.speed = onArm.speed;
 
     // Sets base servo to initial degree
     base_servo.SetDegree(85.);
     on_arm_servo.SetDegree(8.);
 }
 
+/*******************************************************
+ * @brief Sends a servo a pulse width directly, anywhere from SERVO_PULSE_LOWEST
+ * to SERVO_PULSE_HIGHEST. Leaves the servo's min/max set to that range.
+ */
+void set_servo_pulse(FEHServo &servo, int pulse) {
+    servo.SetMin(SERVO_PULSE_LOWEST);
+    servo.SetMax(SERVO_PULSE_HIGHEST);
+    servo.SetDegree((pulse - SERVO_PULSE_LOWEST) * 180.0f / (SERVO_PULSE_HIGHEST - SERVO_PULSE_LOWEST));
+}
+
+/*******************************************************
+ * @brief Steps a servo's pulse until the screen is touched or the pulse
+ * range runs out
+ *
+ * @param pulse Pulse to start from
+ * @param step Microseconds per step (negative to go down)
+ * @return int Pulse when it stopped
+ */
+int sweep_servo_pulse(FEHServo &servo, int pulse, int step) {
+    int x, y;
+
+    // Lets go of the last touch first
+    idle_wait_release();
+
+    while ((pulse + step >= SERVO_PULSE_LOWEST) && (pulse + step <= SERVO_PULSE_HIGHEST)) {
+        pulse += step;
+        set_servo_pulse(servo, pulse);
+        Sleep(CALIBRATE_STEP_TIME);
+
+        if (LCD.Touch(&x, &y)) {
+            break;
+        }
+    }
+    return pulse;
+}
+
+/*******************************************************
+ * @brief Replaces TouchCalibrate(). Sweeps the servo down and then up from the
+ * middle, touching the screen when the horn stops following (it reached its
+ * end), and keeps those pulses as min/max. Then times full 0 to 180 sweeps,
+ * touching when the horn stops, for the speed. The touches come a little
+ * late, so the speed is a little low and arm plans err on the long side.
+ *
+ * @param calibration Set to the servo's min/max and speed
+ */
+void calibrate_servo(FEHServo &servo, ServoCalibration &calibration) {
+    int x, y;
+    int middle = (SERVO_PULSE_LOWEST + SERVO_PULSE_HIGHEST) / 2;
+
+    // Min
+    set_servo_pulse(servo, middle);
+    Sleep(CALIBRATE_SETTLE_TIME);
+    write_status("Touch at stop (min)");
+    calibration.minPulse = sweep_servo_pulse(servo, middle, -CALIBRATE_PULSE_STEP) + CALIBRATE_STOP_MARGIN;
+
+    // Max
+    set_servo_pulse(servo, middle);
+    Sleep(CALIBRATE_SETTLE_TIME);
+    write_status("Touch at stop (max)");
+    calibration.maxPulse = sweep_servo_pulse(servo, middle, CALIBRATE_PULSE_STEP) - CALIBRATE_STOP_MARGIN;
+
+    // Speed over the whole travel
+    servo.SetMin(calibration.minPulse);
+    servo.SetMax(calibration.maxPulse);
+
+    double totalTime = 0;
+    for (int i = 0; i < CALIBRATE_SPEED_TRIES; i++) {
+        servo.SetDegree(0);
+        Sleep(CALIBRATE_SETTLE_TIME);
+        write_status("Touch at stop (speed)");
+
+        idle_wait_release();
+        double startTime = TimeNow();
+        servo.SetDegree(180);
+        idle_wait_touch(&x, &y, IDLE_FOREVER, CALIBRATE_TOUCH_PERIOD);
+        totalTime += TimeNow() - startTime;
+    }
+
+    float travel = (calibration.maxPulse - calibration.minPulse) * ARM_DEGREES_PER_US;
+    calibration.speed = travel / (totalTime / CALIBRATE_SPEED_TRIES);
+}
+
 /*******************************************************
  * @brief Detects the color using the CdS cell
  *
  * @param timeToDetect time the robot takes to detect if it doesn't see the color right away
+ * @param line Line it was called from (filled in automatically, used by the cost report)
  * 
  * @return int color Color detected.
  *          0 -> Red
  *          1 -> Blue
  */
-int detect_color(int timeToDetect) {
+int detect_color(int timeToDetect, int line) {
+    TimelineScope timeline("detect_color", 0, COST_SENSOR_WAIT, line);
+
     LCD.Clear();
 
     // Color to be returned
@@ -1014,9 +2204,13 @@ int detect_color(int timeToDetect) {
 
 /*******************************************************
  * @brief Presses jukebox buttons based on color.
+ * 
+ * @param line Line it was called from (filled in automatically, used by the cost report)
  */
-void press_jukebox_buttons() {
+void press_jukebox_buttons(int line) {
     
+    TimelineScope timeline("press_jukebox_buttons", 0, COST_OTHER, line);
+
     /*
      * Detects the color of the jukebox
      * 
@@ -1025,13 +2219,13 @@ void press_jukebox_buttons() {
      */ 
     int color = detect_color(4);
     Sleep(0.5);
-    move_forward_inches(-FORWARD_SPEED, 2); // Makes room for arm
+    move_forward_inches(-FORWARD_SPEED, 2_in); // Makes room for arm
 
     // Space for turn is the amount of space to move forward after aligning with buttons
-    float spaceForTurn = 2; // Initially 2.75
+    Inches spaceForTurn = 2_in; // Initially 2.75
 
     // Time to move forward to press buttons
-    float secondsFromButtons = 0.9;
+    Seconds secondsFromButtons = 0.9_s;
 
     // Responds to the jukebox light appropriately
     if (color == 0) { // On right path (red light)
@@ -1040,10 +2234,10 @@ void press_jukebox_buttons() {
         on_arm_servo.SetDegree(8);
 
         // Goes down red button path
-        turn_right_degrees(TURN_SPEED, 35);
+        turn_right_degrees(TURN_SPEED, 35_deg);
         
         move_forward_inches(FORWARD_SPEED, spaceForTurn);
-        turn_left_degrees(TURN_SPEED, 35);
+        turn_left_degrees(TURN_SPEED, 35_deg);
 
         // Moves base servo down to press
         base_servo.SetDegree(4);
@@ -1051,18 +2245,18 @@ void press_jukebox_buttons() {
 
         RPS_correct_heading(RPS_270_Degrees, 4);
 
-        move_forward_seconds(20, secondsFromButtons + 0.75); // Moves forward until buttons
+        move_forward_seconds(20_pct, secondsFromButtons + 0.75_s); // Moves forward until buttons
 
-        move_forward_seconds(-20, secondsFromButtons); // Reverses from buttons
+        move_forward_seconds(-20_pct, secondsFromButtons); // Reverses from buttons
 
         // Moves up base servo 
         base_servo.SetDegree(85);
 
         // Returns to CdS cell over light
-        turn_right_degrees(TURN_SPEED, 35);
+        turn_right_degrees(TURN_SPEED, 35_deg);
 
         move_forward_inches(-FORWARD_SPEED, spaceForTurn);
-        turn_left_degrees(TURN_SPEED, 35);
+        turn_left_degrees(TURN_SPEED, 35_deg);
         
 
     } else if (color == 1) { // On left path (blue light)
@@ -1071,129 +2265,358 @@ void press_jukebox_buttons() {
         on_arm_servo.SetDegree(0);
 
         // Goes down blue button path
-        turn_left_degrees(TURN_SPEED, 35);
+        turn_left_degrees(TURN_SPEED, 35_deg);
 
         move_forward_inches(FORWARD_SPEED, spaceForTurn);
-        turn_right_degrees(TURN_SPEED, 35);
+        turn_right_degrees(TURN_SPEED, 35_deg);
 
         // Moves base servo down to press
         base_servo.SetDegree(4);
 
         RPS_correct_heading(RPS_270_Degrees, 2);
 
-        move_forward_seconds(20, secondsFromButtons + 0.75); // Moves forward until buttons
+        move_forward_seconds(20_pct, secondsFromButtons + 0.75_s); // Moves forward until buttons
 
-        move_forward_seconds(-20, secondsFromButtons); // Reverses from buttons
+        move_forward_seconds(-20_pct, secondsFromButtons); // Reverses from buttons
 
         // Moves up base servo 
         base_servo.SetDegree(85);
         on_arm_servo.SetDegree(180);
 
         // Returns to CdS cell over light
-        turn_left_degrees(TURN_SPEED, 35);
+        turn_left_degrees(TURN_SPEED, 35_deg);
 
         move_forward_inches(-FORWARD_SPEED, spaceForTurn);
-        turn_right_degrees(TURN_SPEED, 35);
+        turn_right_degrees(TURN_SPEED, 35_deg);
 
     } else {
         LCD.Write("ERROR: COLOR NOT READ SUCCESFULLY");
     }
 }
 
+/************************************************/
+// Tasks (see task.h)
+
 /*******************************************************
- * @brief Algorithm for flipping the hot plate when robot 
- * is at y=55. Facing directly at it.
- * 
+ * @brief Drives forward or turns a number of encoder counts without blocking.
+ * Pick the move with forward(), turn_right() or turn_left(), then TASK_AWAIT() it.
  */
-void flip_burger() {
+class DriveTask : public Task {
+public:
+    /*******************************************************
+     * @brief Same move as move_forward_inches()
+     */
+    void forward(Percent percent, Inches inches) {
+        move = drive_forward_move(percent, inches);
+        name = "drive_forward";
+        arg = inches.value;
+    }
+
+    /*******************************************************
+     * @brief Same move as turn_right_degrees()
+     */
+    void turn_right(Percent percent, Degrees degrees) {
+        move = drive_turn_move(TURN_RIGHT, percent, degrees);
+        name = "drive_turn_right";
+        arg = degrees.value;
+    }
+
+    /*******************************************************
+     * @brief Same move as turn_left_degrees()
+     */
+    void turn_left(Percent percent, Degrees degrees) {
+        move = drive_turn_move(TURN_LEFT, percent, degrees);
+        name = "drive_turn_left";
+        arg = degrees.value;
+    }
 
-    write_status("Flipping hot plate");
+    void step() {
+        TASK_BEGIN();
 
-    //***********
-    // Initial flip
+        timeline_event('B', TIMELINE_TRACK_ROBOT, name, arg);
 
-    // Sets initial arm positions
-    base_servo.SetDegree(85);
-    on_arm_servo.SetDegree(8);
+        // Starts like the blocking moves, then waits for the counts without blocking
+        drive_move_start(move);
+        target = encoder_stop_arm(move.expectedCounts);
+        sum = 0;
+        lastCheck = timeline_time();
 
-    Sleep(0.5);
+        // Other tasks run between checks of the counts (one at most if the executor prioritizes this)
+        TASK_WAIT_UNTIL(reached());
+
+        // Turn off motors
+        right_motor.Stop();
+        left_motor.Stop();
+
+        encoder_stop_done(target, sum, latency);
+        drive_move_finish(move);
+        timeline_event('E', TIMELINE_TRACK_ROBOT, name, 0);
+
+        TASK_END();
+    }
+
+private:
+    DriveMove move;
+    const char *name;
+    float arg;
+
+    int target, sum;
+    double lastCheck; // For the stop latency only, so it doesn't go through the sensor trace
+    float latency;
+
+    /*******************************************************
+     * @brief Reads the counts each time the task is stepped
+     *
+     * @return bool true once they add up to the target
+     */
+    bool reached() {
+        int lastSum = sum;
+        sum = left_encoder.Counts() + right_encoder.Counts();
+        double now = timeline_time();
+
+        // The target was reached somewhere since the last check
+        if (sum >= target) {
+            float fraction = (sum > lastSum) ? (float)(target - lastSum) / (sum - lastSum) : 1;
+            latency = (1 - fraction) * (now - lastCheck);
+            return true;
+        }
+
+        lastCheck = now;
+        return false;
+    }
+};
+
+/*******************************************************
+ * @brief Moves both arm servos along a plan from arm_plan(), a step every
+ * ARM_STEP_TIME so they leave and arrive together. Set the plan with plan(),
+ * then spawn or TASK_AWAIT() it.
+ */
+class ArmTask : public Task {
+public:
+    /*******************************************************
+     * @brief Plans a move between two poses
+     *
+     * @return bool false if there is no clear way (the task then does nothing)
+     */
+    bool plan(ArmJoints from, ArmJoints to) {
+        return arm_plan(armModel, from, to, &path);
+    }
+
+    void step() {
+        TASK_BEGIN();
+
+        start = taskNow;
+        while (path.count) {
+            pose = arm_plan_at(path, taskNow - start);
+            base_servo.SetDegree(pose.base);
+            on_arm_servo.SetDegree(pose.onArm);
+
+            if (taskNow - start >= path.total) {
+                break;
+            }
+            TASK_SLEEP(ARM_STEP_TIME);
+        }
+
+        TASK_END();
+    }
+
+private:
+    ArmPlan path;
+    double start;
+    ArmJoints pose;
+};
+
+/*******************************************************
+ * @brief Flips the hot plate when the robot is at y=55, facing directly at it.
+ * flip_burger() runs it by itself, flip_burger_async() next to a StatusTask.
+ */
+class FlipBurgerTask : public Task {
+public:
+    void step() {
+        TASK_BEGIN();
+
+        write_status("Flipping hot plate");
+
+        //***********
+        // Initial flip
+
+        // Sets initial arm positions
+        base_servo.SetDegree(ARM_STOWED.base);
+        on_arm_servo.SetDegree(ARM_STOWED.onArm);
+
+        TASK_SLEEP(0.5);
+
+        // Lowers base servo and moves it under hot plate
+        arm.plan(ARM_STOWED, FLIP_BURGER_UNDER);
+        TASK_AWAIT(arm);
+        drive.forward(FORWARD_SPEED, 1.15_in); // Initially 1.35
+        TASK_AWAIT(drive);
+
+        TASK_SLEEP(0.5);
+
+        // Raises arm and moves forward consecutively
+        base_servo.SetDegree(20); // First lift
+        TASK_SLEEP(0.25);
+        drive.forward(FORWARD_SPEED, 2_in);
+        TASK_AWAIT(drive);
+        TASK_SLEEP(1.0);
+
+        base_servo.SetDegree(45); // Second lift
+        drive.forward(FORWARD_SPEED, 1.25_in);
+        TASK_AWAIT(drive);
+
+        drive.turn_right(TURN_SPEED, 30_deg); // Turns right to help flip burger
+        TASK_AWAIT(drive);
+        TASK_SLEEP(0.5);
+
+        on_arm_servo.SetDegree(145); // Second arm finishes push
+
+        TASK_SLEEP(1.0);
+
+        //***********
+        // Return flip
+
+        write_status("Flipping other side");
+
+        // Resets position
+        on_arm_servo.SetDegree(8.); // Resets on arm servo position
+        drive.turn_left(TURN_SPEED, 30_deg); // Readjusts angle
+        TASK_AWAIT(drive);
+
+        // Flips around to hit burger plate
+        on_arm_servo.SetDegree(50);
+        base_servo.SetDegree(55);
+        drive.forward(-FORWARD_SPEED, 1_in); // Accounted for in last move forward call here
+        TASK_AWAIT(drive);
+        drive.turn_left(40_pct, 360_deg);
+        TASK_AWAIT(drive);
+        on_arm_servo.SetDegree(180);
+
+        TASK_SLEEP(0.5);
+
+        // Correct heading. y=60.5 in front of first flip. Blocks the other tasks.
+        RPS_correct_heading(RPS_90_Degrees, 2);
+
+        // Moves up base servo
+        base_servo.SetDegree(85);
 
-    // Lowers base servo and moves it under hot plate
-    base_servo.SetDegree(0);
-    Sleep(1.0);
-    move_forward_inches(FORWARD_SPEED, 1.15); // Initially 1.35
-    
-    Sleep(0.5);
+        // Moves backwards to 56.45
+        drive.forward(-FORWARD_SPEED, 2.05_in); // Initially 4.05
+        TASK_AWAIT(drive);
 
-    // Raises arm and moves forward consecutively
-    base_servo.SetDegree(20); // First lift
-    Sleep(0.25);
-    move_forward_inches(FORWARD_SPEED, 2);
-    Sleep(1.0);
+        TASK_END();
+    }
 
-    base_servo.SetDegree(45); // Second lift
-    move_forward_inches(FORWARD_SPEED, 1.25);
+private:
+    DriveTask drive;
+    ArmTask arm;
+};
 
-    turn_right_degrees(TURN_SPEED, 30); // Turns right to help flip burger
-    Sleep(0.5);
+/*******************************************************
+ * @brief Keeps the RPS heading and position on the screen, one row every STATUS_TASK_PERIOD.
+ * Uses rows 2 to 4, above the line the moves write their data under. Never finishes.
+ *
+ * @pre RPS must be initialized.
+ */
+class StatusTask : public Task {
+public:
+    void step() {
+        TASK_BEGIN();
+
+        for (row = 0;; row = (row + 1) % 3) {
+            if (row == 0) {
+                LCD.WriteRC("Heading: ", 2, 1);
+                LCD.WriteRC(RPS.Heading(), 2, 10);
+            } else if (row == 1) {
+                LCD.WriteRC("X Value: ", 3, 1);
+                LCD.WriteRC(RPS.X(), 3, 10);
+            } else {
+                LCD.WriteRC("Y Value: ", 4, 1);
+                LCD.WriteRC(RPS.Y(), 4, 10);
+            }
 
-    on_arm_servo.SetDegree(145); // Second arm finishes push
+            TASK_SLEEP(STATUS_TASK_PERIOD);
+        }
 
-    Sleep(1.0);
+        TASK_END();
+    }
 
-    //***********
-    // Return flip
+private:
+    int row;
+};
 
-    write_status("Flipping other side");
+/*******************************************************
+ * @brief Algorithm for flipping the hot plate when robot 
+ * is at y=55. Facing directly at it. Runs a FlipBurgerTask by itself.
+ * 
+ * @param line Line it was called from (filled in automatically, used by the cost report)
+ * 
+ */
+void flip_burger(int line) {
+    TimelineScope timeline("flip_burger", 0, COST_OTHER, line);
 
-    // Resets position
-    on_arm_servo.SetDegree(8.); // Resets on arm servo position
-    turn_left_degrees(TURN_SPEED, 30); // Readjusts angle
+    TaskExecutor executor;
+    FlipBurgerTask flip;
+    executor.run(flip, line);
+}
 
-    // Flips around to hit burger plate
-    on_arm_servo.SetDegree(50);
-    base_servo.SetDegree(55);
-    move_forward_inches(-FORWARD_SPEED, 1); // Accounted for in last move forward call here
-    turn_left_degrees(40, 360);
-    on_arm_servo.SetDegree(180);
+/*******************************************************
+ * @brief Flips the hot plate like flip_burger(), with the RPS data kept on
+ * the screen while it does. Same starting and ending place.
+ * 
+ * @param line Line it was called from (filled in automatically, used by the cost report)
+ * 
+ * @pre RPS must be initialized.
+ */
+void flip_burger_async(int line) {
+    TimelineScope timeline("flip_burger_async", 0, COST_OTHER, line);
 
-    Sleep(0.5);
+    // Clears space for the RPS data, down to the line above the move data
+    LCD.SetFontColor(BACKGROUND_COLOR);
+    LCD.FillRectangle(0, 34, 319, 66);
+    LCD.SetFontColor(FONT_COLOR);
+    LCD.DrawHorizontalLine(100, 0, 319);
 
-    // Correct heading. y=60.5 in front of first flip
-    RPS_correct_heading(RPS_90_Degrees, 2);
-    
-    // Moves up base servo
-    base_servo.SetDegree(85);
+    TaskExecutor executor;
+    FlipBurgerTask flip;
+    StatusTask status;
 
-    // Moves backwards to 56.45
-    move_forward_inches(-FORWARD_SPEED, 2.05); // Initially 4.05
+    executor.spawn(status);
+    executor.prioritize(flip); // Its drives check their counts around every status row
+    executor.run(flip);
 }
 
 /*******************************************************
  * @brief Flips the correct ice cream lever. 
  * 
+ * @param line Line it was called from (filled in automatically, used by the cost report)
+ * 
  * @pre RPS must be initialized.
  */
-void flip_ice_cream_lever() {
+void flip_ice_cream_lever(int line) {
+    TimelineScope timeline("flip_ice_cream_lever", 0, COST_OTHER, line);
 
     // Distance to move forward towards ice cream lever
-    float distToLever = 5.5; // Initially 5.25
+    Inches distToLever = 5.5_in; // Initially 5.25
 
     // Distance between levers
-    float distBtwLevers = 4;
+    Inches distBtwLevers = 4_in;
 
     // Time to sleep after pressing levers
     float leverTimeSleep = 6.6;
+
+    // Read before the start light
+    int iceCream = planned_ice_cream();
     
-    if (RPS.GetIceCream() == 0) { // VANILLA
+    if (iceCream == 0) { // VANILLA
 
         // Moves on_arm_servo up to avoid interference from sides
         on_arm_servo.SetDegree(90);
 
         write_status("Navigating to vanilla lever ");
-        turn_left_degrees(TURN_SPEED, 90);
+        turn_left_degrees(TURN_SPEED, 90_deg);
         move_forward_inches(FORWARD_SPEED, distBtwLevers);
-        turn_right_degrees(TURN_SPEED, 90);
+        turn_right_degrees(TURN_SPEED, 90_deg);
 
         write_status("Pushing lever down");
         base_servo.SetDegree(85);
@@ -1214,14 +2637,14 @@ void flip_ice_cream_lever() {
         base_servo.SetDegree(50);
         move_forward_inches(-FORWARD_SPEED, distToLever);
 
-        turn_left_degrees(TURN_SPEED, 45);
-        move_forward_inches(FORWARD_SPEED, 1);
-        turn_left_degrees(TURN_SPEED, 45);
+        turn_left_degrees(TURN_SPEED, 45_deg);
+        move_forward_inches(FORWARD_SPEED, 1_in);
+        turn_left_degrees(TURN_SPEED, 45_deg);
         move_forward_inches(-FORWARD_SPEED, distBtwLevers);
-        turn_right_degrees(TURN_SPEED, 90);
+        turn_right_degrees(TURN_SPEED, 90_deg);
         
 
-    } else if (RPS.GetIceCream() == 1) { // TWIST
+    } else if (iceCream == 1) { // TWIST
 
         // Moves on_arm_servo up to avoid interference from sides
         on_arm_servo.SetDegree(90);
@@ -1244,19 +2667,19 @@ void flip_ice_cream_lever() {
         move_forward_inches(-FORWARD_SPEED, distToLever);
 
         // Moves to align with ramp
-        turn_left_degrees(TURN_SPEED, 45);
-        move_forward_inches(FORWARD_SPEED, 1);
-        turn_right_degrees(TURN_SPEED, 45);
+        turn_left_degrees(TURN_SPEED, 45_deg);
+        move_forward_inches(FORWARD_SPEED, 1_in);
+        turn_right_degrees(TURN_SPEED, 45_deg);
 
-    } else if (RPS.GetIceCream() == 2) { // CHOCOLATE
+    } else if (iceCream == 2) { // CHOCOLATE
 
         // Moves on_arm_servo up to avoid interference from sides
         on_arm_servo.SetDegree(90);
 
         write_status("Navigating to chocolate lever ");
-        turn_left_degrees(TURN_SPEED, 90);
+        turn_left_degrees(TURN_SPEED, 90_deg);
         move_forward_inches(-FORWARD_SPEED, distBtwLevers);
-        turn_right_degrees(TURN_SPEED, 90);
+        turn_right_degrees(TURN_SPEED, 90_deg);
 
         write_status("Pushing lever down");
         base_servo.SetDegree(85);
@@ -1265,7 +2688,7 @@ void flip_ice_cream_lever() {
         Sleep(leverTimeSleep);
 
         // Reverses from lever
-        move_forward_inches(-20, distToLever);
+        move_forward_inches(-20_pct, distToLever);
 
         write_status("Pushing lever up");
 
@@ -1277,11 +2700,11 @@ void flip_ice_cream_lever() {
         base_servo.SetDegree(50);
         move_forward_inches(-FORWARD_SPEED, distToLever);
 
-        turn_left_degrees(TURN_SPEED, 45);
-        move_forward_inches(FORWARD_SPEED, 1);
-        turn_left_degrees(TURN_SPEED, 45);
+        turn_left_degrees(TURN_SPEED, 45_deg);
+        move_forward_inches(FORWARD_SPEED, 1_in);
+        turn_left_degrees(TURN_SPEED, 45_deg);
         move_forward_inches(FORWARD_SPEED, distBtwLevers);
-        turn_right_degrees(TURN_SPEED, 90);
+        turn_right_degrees(TURN_SPEED, 90_deg);
 
     } else {
         write_status("ERROR. ICE CREAM LEVER NOT SPECIFIED.");
@@ -1306,12 +2729,58 @@ void write_status(const char status[]) {
     LCD.WriteRC(status, 1, 2);
 }
 
+/*******************************************************
+ * @brief Clears the space under the line for a move's data and says what the
+ * move is doing
+ *
+ * @param text What the move is doing
+ * @param column Column to write it at
+ */
+void write_move_start(const char text[], int column) {
+    LCD.SetFontColor(BACKGROUND_COLOR);
+    LCD.FillRectangle(0,100,319,239);
+    LCD.SetFontColor(FONT_COLOR);
+    LCD.DrawHorizontalLine(100, 0, 319);
+
+    LCD.WriteRC(text, 7, column);
+}
+
+/*******************************************************
+ * @brief Shows the counts an encoder move wanted and read once it stopped
+ *
+ * @param expectedCounts Average counts the move stopped at
+ * @param percent Percent the motors ran at
+ */
+void write_move_data(Counts expectedCounts, Percent percent) {
+    LCD.WriteRC("Theoretical Counts: ", 9, 1);
+    LCD.WriteRC(expectedCounts.value, 9, 20);
+    LCD.WriteRC("Motor Percent: ", 10, 1);
+    LCD.WriteRC((int)percent.value, 10, 20);
+    LCD.WriteRC("Actual LE Counts: ", 11, 1);
+    LCD.WriteRC(left_encoder.Counts(), 11, 20);
+    LCD.WriteRC("Actual RE Counts: ", 12, 1);
+    LCD.WriteRC(right_encoder.Counts(), 12, 20);
+    write_encoder_stop();
+}
+
+/*******************************************************
+ * @brief Shows how far past its target the last encoder move read, and puts
+ * the stop latency on the timeline
+ */
+void write_encoder_stop() {
+    LCD.WriteRC("Stop Overshoot: ", 13, 1);
+    LCD.WriteRC(encoderStopLast.atStop - encoderStopLast.target, 13, 20);
+
+    timeline_event('i', TIMELINE_TRACK_ROBOT, "stop latency (us)", encoderStopLast.latency * 1e6f);
+}
+
 /*******************************************************
  * @brief Shows the current RPS data.
  * 
  * @pre RPS must be initialized.
  */
 void show_RPS_data() {
+    ProbeScope probe(PROBE_SHOW_RPS);
 
     // Clears space for movement data and status
     LCD.SetFontColor(BACKGROUND_COLOR);
@@ -1338,12 +2807,197 @@ void show_RPS_data() {
     LCD.WriteRC(RPS.CurrentRegionLetter(), 11, 10);
 }
 
+/************************************************/
+// Missions for the competition courses (see mission.h)
+
+// Parts both competitions share
+
+// From the start light to over the CdS cell, facing the wall
+constexpr auto jukeboxStart = mission(
+    step_stage("Jukebox"),
+    step_status("Moving towards jukebox"),
+    step_from_start(FORWARD_SPEED, Inches(9 + DIST_AXIS_CDS), 45_deg), // Heads from button to center, then turns towards jukebox. Direct: 7.5 inches
+    step_servo(&on_arm_servo, 90), // Moves on_arm_servo out of the way
+    step_drive_from_start(FORWARD_SPEED, Inches(11.5 - 1.0607)) // Over CdS cell
+);
+
+// From the CdS cell over the jukebox light to lined up with the ramp
+constexpr auto jukeboxButtons = mission(
+    step_status("Pressing jukebox buttons"),
+    step_call(press_jukebox_buttons), // Returns to CdS cell over jukebox light
+    step_servo(&on_arm_servo, 180), // Sets on_arm_servo into initial position
+    step_drive(FORWARD_SPEED, Inches(DIST_AXIS_CDS)), // Moves back forward to axis over jukebox light
+
+    step_status("Moving towards ramp"),
+    step_turn_left(TURN_SPEED, 90_deg), // Moves to center (aligns with ramp)
+    step_drive(FORWARD_SPEED, 9.25_in), // Initially 9
+    step_turn_left(TURN_SPEED, 90_deg)
+);
+
+// From in front of the sink to facing right past it, with the tray dropped
+constexpr auto sinkTray = mission(
+    step_turn_left(TURN_SPEED, 90_deg), // Aligns and backs up to edge of sink (~8 inches away)
+    step_drive_seconds(-40_pct, 1_s),
+
+    step_status("Dropping tray"),
+    step_servo(&base_servo, 85.),
+    step_servo(&base_servo, 105.),
+    step_sleep(0.5), // Lets tray fall
+    step_servo(&base_servo, 85.),
+
+    step_status("Moving away from sink"),
+    step_drive(FORWARD_SPEED, 7.75_in), // Drives away from sink
+    step_turn_right(TURN_SPEED, 90_deg) // Towards that one spot on top (facing rightwards)
+);
+
+// From in front of the ticket to facing the front of the course
+constexpr auto hotPlateStart = mission(
+    step_stage("Hot Plate"),
+    step_status("Moving towards hot plate"),
+    step_servo(&on_arm_servo, 8), // Resets arm positions
+    step_servo(&base_servo, 85),
+    step_turn_right(TURN_SPEED, 90_deg) // Moves towards the front
+);
+
+// From y=56.45, x=15.45 facing the levers to backing out of the dead zone
+constexpr auto finalButtonStart = mission(
+    step_stage("Final button"),
+    step_status("Moving towards final button"),
+    step_turn_right(TURN_SPEED, 45_deg), // Turns to reverse down ramp
+    step_drive(-FORWARD_SPEED, 4.20_in) // Reverses back out of dead zone to check heading
+);
+
+// Individual Competition
+constexpr auto indCompMission = mission(
+    jukeboxStart,
+    step_rps_x(-7.8, 2), // Initially 8.8 left of top x reference
+    step_turn_left(TURN_SPEED, 90_deg), // Face jukebox
+    step_tool_to(&TOOL_CDS, -7.8, -38.125), // CdS cell over jukebox light, room for arm
+    step_rps_tool(&TOOL_CDS, -7.8, -38.125, 2), // Axis 34 below top y reference 18.3. Initially 33.7
+    jukeboxButtons,
+
+    // Moves up ramp to that place on top of the ramp (52.25, 15.45)
+    step_stage("Ramp"),
+    step_status("Moving up ramp"),
+    step_rps_heading(&RPS_90_Degrees, 2), // Checks that it is positioned straight
+    step_drive(RAMP_SPEED, Inches(30.26 + DIST_AXIS_CDS)),
+    step_turn_right(TURN_SPEED, 90_deg), // Initially 180 degrees to correct for RPS check
+    step_rps_x(4.65, 2),
+
+    step_stage("Sink"),
+    step_drive(-FORWARD_SPEED, 9.25_in), // Reverses towards sink
+    sinkTray,
+    step_drive(FORWARD_SPEED, 9.25_in), // To that one spot on top
+
+    step_stage("Ticket"),
+    step_status("Moving towards ticket"),
+    step_turn_left(30_pct, 180_deg), // Faces left to reverse towards ticket
+    step_drive(-FORWARD_SPEED, 13.25_in), // Initially 13.65
+    step_rps_x(13.25, 2),
+    step_turn_left(TURN_SPEED, 90_deg), // Facing ticket
+    step_status("Sliding ticket"), // From y=52.25
+    step_servo(&on_arm_servo, 43), // Initially 45
+    step_servo(&base_servo, 0),
+    step_rps_y(-4.65, 2), // 52.25 - 4.65
+    step_drive(20_pct, 4.75_in), // Inserts arm into ticket slot, initially 0.25
+    step_servo(&on_arm_servo, 180), // Reverses away from ticket
+    step_drive(-20_pct, 4.75_in),
+
+    hotPlateStart,
+    step_drive(FORWARD_SPEED, 6_in), // Initially 5.85
+    step_rps_x(7.65, 4), // Initially 7.8
+    step_turn_right(TURN_SPEED, 90_deg),
+    step_drive(FORWARD_SPEED, 2.75_in), // From y=52.25 to y=55
+    step_rps_y(2.75, 4),
+    step_call(flip_burger), // Finishes at y=56.45 in front of first plate
+    step_rps_y(4, 2), // Initially 55.95, initially plus 3.7
+    step_turn_left(TURN_SPEED, 90_deg),
+    step_rps_x(7.4, 2), // In front of initial plate, 4.05 inches from front, heading=0. Initially 21.7
+
+    // Needs to be at y=56.45 and x=15.45 (LEFT) (Can't check x though at y=56.45 since DEAD ZONE)
+    step_stage("Ice cream lever"),
+    step_status("Moving towards ice cream"),
+    step_drive(20_pct, 5_in), // Moves to x=15.45, initially 5.75
+    step_turn_right(TURN_SPEED, 45_deg), // Faces towards levers
+    step_call(flip_ice_cream_lever), // Finishes where it started
+
+    finalButtonStart,
+    step_rps_heading(&RPS_90_Degrees, 4),
+    step_drive(-FORWARD_SPEED, 30.26_in), // Moves down ramp
+    step_turn_left(TURN_SPEED, 45_deg), // Heads towards final button
+    step_drive(-FORWARD_SPEED, 20_in)
+);
+
+// Final Competition
+constexpr auto finalCompMission = mission(
+    jukeboxStart,
+    step_rps_x(-8.2, 1), // Initially 8.8 left of top x reference
+    step_turn_left(TURN_SPEED, 90_deg), // Face jukebox
+    step_tool_to(&TOOL_CDS, -8.2, -37.875), // CdS cell over jukebox light, room for arm
+    step_rps_tool(&TOOL_CDS, -8.2, -37.875, 2), // Axis 33.75 below top y reference 18.3. Initially 33.7
+    jukeboxButtons,
+
+    // Moves up ramp to that place on top of the ramp (52.25, 15.45)
+    step_stage("Ramp"),
+    step_status("Moving up ramp"),
+    step_rps_heading(&RPS_90_Degrees, 2), // Checks that it is positioned straight
+    step_drive_PID(5_ips, Inches(30.26 + DIST_AXIS_CDS)), // Was move_forward_inches(RAMP_SPEED, ...)
+    step_turn_right(TURN_SPEED, 90_deg), // Initially 180 degrees to correct for RPS check
+    step_rps_x(4.65, 8),
+
+    step_stage("Sink"),
+    step_drive(-FORWARD_SPEED, 8.5_in), // Reverses towards sink
+    sinkTray,
+    step_drive(FORWARD_SPEED, 8.5_in), // To that one spot on top
+
+    step_stage("Ticket"),
+    step_status("Moving towards ticket"),
+    step_turn_left(30_pct, 180_deg), // Faces left to reverse towards ticket
+    step_drive(-FORWARD_SPEED, 13_in), // Initially 13.65
+    step_rps_x(13, 6),
+    step_turn_left(TURN_SPEED, 90_deg), // Facing ticket
+    step_status("Sliding ticket"), // From y=52.25
+    step_servo(&on_arm_servo, 45),
+    step_servo(&base_servo, 0),
+    step_rps_y(-4.65, 8), // 52.25 - 4.65
+    step_drive(20_pct, 5.25_in), // Inserts arm into ticket slot, initially 0.25
+    step_servo(&on_arm_servo, 180), // Reverses away from ticket
+    step_sleep(0.25),
+    step_drive(-20_pct, 5.25_in),
+
+    hotPlateStart,
+    step_drive(FORWARD_SPEED, 6.5_in), // Initially 6.25
+    step_rps_x(7.05, 2), // Initially 7.15
+    step_turn_right(TURN_SPEED, 90_deg),
+    step_rps_heading_fixed(90, 3),
+    step_drive(FORWARD_SPEED, 2.75_in), // From y=52.25 to y=55
+    step_rps_y(2.75, 4),
+    step_call(flip_burger_async), // Finishes at y=56.45 in front of first plate
+    step_rps_y(4, 4), // Initially 55.95, initially plus 3.7
+    step_turn_left(TURN_SPEED, 90_deg),
+    step_rps_x(7.4, 4), // In front of initial plate, 4.05 inches from front, heading=0. Initially 21.7
+
+    // Needs to be at y=56.45 and x=15.45 (LEFT) (Can't check x though at y=56.45 since DEAD ZONE)
+    step_stage("Ice cream lever"),
+    step_status("Moving towards ice cream"),
+    step_drive(20_pct, 4.5_in), // Moves to x=15.45, initially 5
+    step_turn_right(TURN_SPEED, 45_deg), // Faces towards levers
+    step_call(flip_ice_cream_lever), // Finishes where it started
+
+    finalButtonStart,
+    step_rps_heading(&RPS_90_Degrees, 3),
+    step_drive(-RAMP_SPEED, 30.26_in), // Moves down ramp
+    step_turn_left(TURN_SPEED, 45_deg), // Heads towards final button
+    step_drive(-50_pct, 30_in)
+);
+
 /*******************************************************
  * @brief Runs the specified course.
  * 
  * @param courseNumber Course number to runs
  */
 void run_course(int courseNumber) {
+    TimelineScope timeline("run_course", courseNumber);
 
     // Used for timeouts for some functions
     float startTime = TimeNow();
@@ -1371,10 +3025,10 @@ void run_course(int courseNumber) {
         Sleep(1.0);
         while(true) {
             write_status("Press to turn left.");
-            while(!LCD.Touch(&xGarb, &yGarb));
-            turn_left_degrees(TURN_SPEED, 90);
-            while(!LCD.Touch(&xGarb, &yGarb));
-            turn_right_degrees(TURN_SPEED, 90);
+            idle_wait_touch(&xGarb, &yGarb);
+            turn_left_degrees(TURN_SPEED, 90_deg);
+            idle_wait_touch(&xGarb, &yGarb);
+            turn_right_degrees(TURN_SPEED, 90_deg);
         }
         write_status("Complete.");
         break;
@@ -1389,10 +3043,10 @@ void run_course(int courseNumber) {
         Sleep(1.0);
         write_status("Press to move forward");
         
-        while(!LCD.Touch(&xTrash2, &yTrash2));
+        idle_wait_touch(&xTrash2, &yTrash2);
         while(true) {
-            move_forward_inches(FORWARD_SPEED, 9999);
-            while(!LCD.Touch(&xTrash2, &yTrash2));
+            move_forward_inches(FORWARD_SPEED, 9999_in);
+            idle_wait_touch(&xTrash2, &yTrash2);
         }
 
         break;
@@ -1416,7 +3070,7 @@ void run_course(int courseNumber) {
         
         while (true) {
 
-            while(!LCD.Touch(&xTrash, &yTrash));
+            idle_wait_touch(&xTrash, &yTrash);
 
                 LCD.SetFontColor(BACKGROUND_COLOR);
                 LCD.FillRectangle(0, 0, 159, 39);
@@ -1467,14 +3121,73 @@ void run_course(int courseNumber) {
         int xTrash420, yTrash69;
 
         // Waits for touch. If touch is on left then base_servo is calibrated, and vice versa
-        while(!LCD.Touch(&xTrash420, &yTrash69));
+        idle_wait_touch(&xTrash420, &yTrash69);
 
         LCD.DrawVerticalLine(160, 20, 239);
 
-        if (xTrash420 < 160) {
-            base_servo.TouchCalibrate();
-        } else if (xTrash420 > 160) {
-            on_arm_servo.TouchCalibrate();
+        {
+            // Keeps the other servo's numbers from the last sweep
+            ServoCalibration base = { BASE_SERVO_MIN, BASE_SERVO_MAX, ARM_SERVO_SPEED };
+            ServoCalibration onArm = { ON_ARM_SERVO_MIN, ON_ARM_SERVO_MAX, ARM_SERVO_SPEED };
+            servo_calibration_load(SERVO_CALIBRATION_FILE, base, onArm);
+
+            ServoCalibration &calibration = (xTrash420 < 160) ? base : onArm;
+            calibrate_servo((xTrash420 < 160) ? base_servo : on_arm_servo, calibration);
+            servo_calibration_save(SERVO_CALIBRATION_FILE, base, onArm);
+
+            write_status("Saved servo calibration");
+            LCD.WriteRC("Min:", 2, 1);
+            LCD.WriteRC(calibration.minPulse, 2, 10);
+            LCD.WriteRC("Max:", 3, 1);
+            LCD.WriteRC(calibration.maxPulse, 3, 10);
+            LCD.WriteRC("Deg/s:", 4, 1);
+            LCD.WriteRC(calibration.speed, 4, 10);
+        }
+
+        break;
+
+    case SYSID_DRIVE:
+        write_status("Drive sysid");
+        Sleep(1.0);
+
+        {
+            DriveModel model;
+            const char *prompts[DRIVE_SURFACES] = { "Floor, touch to go", "Ramp facing up, touch" };
+            const char *names[DRIVE_SIDES][DRIVE_DIRECTIONS] = { { "L fwd", "L back" }, { "R fwd", "R back" } };
+
+            for (int surface = 0; surface < DRIVE_SURFACES; surface++) {
+                // Waits for the robot to be put down with 12 in clear ahead, then for the hand to be out of the way
+                write_status(prompts[surface]);
+                idle_wait_release();
+                int x, y;
+                idle_wait_touch(&x, &y);
+                write_status("Identifying...");
+                Sleep(1.0);
+
+                sysid_surface(surface, model);
+            }
+            drive_model_save(DRIVE_MODEL_FILE, model);
+
+            // Floor model, then the ramp's gains
+            LCD.Clear();
+            write_status("Saved drive model");
+            LCD.WriteRC("Floor  gain  dead  tau", 2, 0);
+            for (int side = 0; side < DRIVE_SIDES; side++) {
+                for (int direction = 0; direction < DRIVE_DIRECTIONS; direction++) {
+                    const MotorModel &motor = model.motor[SURFACE_FLOOR][side][direction];
+                    int row = 3 + side * DRIVE_DIRECTIONS + direction;
+                    LCD.WriteRC(names[side][direction], row, 0);
+                    LCD.WriteRC(motor.gain, row, 7);
+                    LCD.WriteRC(motor.deadband, row, 13);
+                    LCD.WriteRC(motor.timeConstant, row, 19);
+                }
+            }
+            LCD.WriteRC("Ramp fwd gain L/R", 8, 0);
+            LCD.WriteRC(model.motor[SURFACE_RAMP][DRIVE_LEFT][DRIVE_FORWARD].gain, 9, 0);
+            LCD.WriteRC(model.motor[SURFACE_RAMP][DRIVE_RIGHT][DRIVE_FORWARD].gain, 9, 7);
+            LCD.WriteRC("Chirp error L/R (in)", 10, 0);
+            LCD.WriteRC(model.chirpError[SURFACE_FLOOR][DRIVE_LEFT], 11, 0);
+            LCD.WriteRC(model.chirpError[SURFACE_FLOOR][DRIVE_RIGHT], 11, 7);
         }
 
         break;
@@ -1490,21 +3203,21 @@ void run_course(int courseNumber) {
         write_status("Moving towards jukebox");
 
         // Heads from button to center
-        move_forward_inches(20, 8.0 + DIST_AXIS_CDS); // Direct: 7.5 inches 
+        move_forward_inches(20_pct, Inches(8.0 + DIST_AXIS_CDS)); // Direct: 7.5 inches 
         Sleep(1.0);
 
         // Moves towards jukebox
-        turn_left_degrees(20, 43);
+        turn_left_degrees(20_pct, 43_deg);
         Sleep(1.0);
 
-        move_forward_inches(20, 12);
+        move_forward_inches(20_pct, 12_in);
         Sleep(1.0);
 
-        turn_left_degrees(20, 89);
+        turn_left_degrees(20_pct, 89_deg);
         Sleep(1.0);
 
         //Reverses to move CdS cell over jukebox light
-        move_forward_inches(-20, 0.75 + DIST_AXIS_CDS);
+        move_forward_inches(-20_pct, Inches(0.75 + DIST_AXIS_CDS));
     
        /***************************************************/
 
@@ -1516,40 +3229,40 @@ void run_course(int courseNumber) {
         /***************************************************/
 
         // Moves forward to move wheel axis over jukebox light
-        move_forward_inches(20, DIST_AXIS_CDS);
+        move_forward_inches(20_pct, Inches(DIST_AXIS_CDS));
 
         write_status("Moving towards ramp");
 
         // Moves to center (aligns with ramp)
-        turn_left_degrees(20, 85);
+        turn_left_degrees(20_pct, 85_deg);
         Sleep(1.0);
-        move_forward_inches(20, 9);
+        move_forward_inches(20_pct, 9_in);
         Sleep(1.0);
-        turn_left_degrees(20, 90);
+        turn_left_degrees(20_pct, 90_deg);
         Sleep(1.0);
         
         write_status("Moving up ramp");
 
         // Moves up ramp
-        move_forward_inches(35, 35); // 11 + 10 + 14
+        move_forward_inches(35_pct, 35_in); // 11 + 10 + 14
         Sleep(1.0);
 
         write_status("Moving down ramp");
         
         // Moves down ramp
-        move_forward_inches(-35, 35);
+        move_forward_inches(-35_pct, 35_in);
         Sleep(1.0);
 
         write_status("Towards final button");
 
         // Heads toward final button
-        turn_right_degrees(20, 90);
+        turn_right_degrees(20_pct, 90_deg);
         Sleep(1.0);
-        move_forward_inches(20, 2.9);
+        move_forward_inches(20_pct, 2.9_in);
         Sleep(1.0);
-        turn_right_degrees(20, 45);
+        turn_right_degrees(20_pct, 45_deg);
         Sleep(1.0);
-        move_forward_inches(20, 7.5);
+        move_forward_inches(20_pct, 7.5_in);
         Sleep(1.0);
 
         write_status("Woo?");
@@ -1564,17 +3277,17 @@ void run_course(int courseNumber) {
         Sleep(1.0);
 
         write_status("Aligning with ramp");
-        move_forward_inches(20, 11.55 + DIST_AXIS_CDS);
-        turn_right_degrees(20, 45);
+        move_forward_inches(20_pct, Inches(11.55 + DIST_AXIS_CDS));
+        turn_right_degrees(20_pct, 45_deg);
 
         write_status("Moving up ramp");
-        move_forward_inches(40, 31.75 + DIST_AXIS_CDS);
+        move_forward_inches(40_pct, Inches(31.75 + DIST_AXIS_CDS));
 
         write_status("Moving towards sink");
-        turn_right_degrees(20, 90);
-        move_forward_inches(-20, 10.5); // Reverses
-        turn_left_degrees(20, 90);
-        move_forward_inches(-20, 8);
+        turn_right_degrees(20_pct, 90_deg);
+        move_forward_inches(-20_pct, 10.5_in); // Reverses
+        turn_left_degrees(20_pct, 90_deg);
+        move_forward_inches(-20_pct, 8_in);
     
         write_status("Dropping tray");
 
@@ -1585,27 +3298,27 @@ void run_course(int courseNumber) {
         base_servo.SetDegree(85.);
 
         write_status("Moving away from sink");
-        move_forward_inches(20, 8);
-        turn_right_degrees(20, 90);
-        move_forward_inches(20, 10.5);
-        turn_left_degrees(20, 185);
+        move_forward_inches(20_pct, 8_in);
+        turn_right_degrees(20_pct, 90_deg);
+        move_forward_inches(20_pct, 10.5_in);
+        turn_left_degrees(20_pct, 185_deg);
 
         write_status("Moving towards ticket");
-        move_forward_inches(-20, 13.15);
-        turn_left_degrees(20, 90);
+        move_forward_inches(-20_pct, 13.15_in);
+        turn_left_degrees(20_pct, 90_deg);
 
         write_status("Sliding ticket");
         on_arm_servo.SetDegree(45);
         Sleep(1.0);
         base_servo.SetDegree(0);
 
-        move_forward_inches(20, 5.7);
+        move_forward_inches(20_pct, 5.7_in);
 
         on_arm_servo.SetDegree(180);
 
         Sleep(1.0);
 
-        move_forward_inches(-20, 23);
+        move_forward_inches(-20_pct, 23_in);
 
     
         break;
@@ -1616,23 +3329,23 @@ void run_course(int courseNumber) {
         Sleep(1.0);
 
         write_status("Aligning with ramp");
-        move_forward_inches(20, 11.55 + DIST_AXIS_CDS);
-        turn_right_degrees(20, 45);
+        move_forward_inches(20_pct, Inches(11.55 + DIST_AXIS_CDS));
+        turn_right_degrees(20_pct, 45_deg);
         RPS_correct_heading(90, 3);
 
         write_status("Moving up ramp");
-        move_forward_inches(40, 33.26 + DIST_AXIS_CDS); // Initially 35.26
+        move_forward_inches(40_pct, Inches(33.26 + DIST_AXIS_CDS)); // Initially 35.26
         RPS_check_y(55, 3); // On top of ramp y-coord
     
         write_status("Moving towards hot plate");
-        turn_right_degrees(20, 90);
+        turn_right_degrees(20_pct, 90_deg);
         RPS_correct_heading(0, 3);
         RPS_check_x(18.6, 3); // On top of ramp x-coord
     
         // PROBLEM AREA. MOVES PRECISELY IN FRONT OF BURGER PLATE
-        move_forward_inches(20, 8); // Initially 5.5
+        move_forward_inches(20_pct, 8_in); // Initially 5.5
         RPS_check_x(27.8, 3); // In front of burger plate x
-        turn_left_degrees(20, 90);
+        turn_left_degrees(20_pct, 90_deg);
         RPS_correct_heading(90, 3);
         RPS_check_y(55, 3);
 
@@ -1644,14 +3357,14 @@ void run_course(int courseNumber) {
         write_status("Moving towards ice cream lever");
         RPS_correct_heading(90, 3);
         RPS_check_y(55, 3);
-        turn_left_degrees(20, 90);
+        turn_left_degrees(20_pct, 90_deg);
         RPS_correct_heading(180, 3);
         RPS_check_x(29.1, 3);
-        move_forward_inches(20, 3); // Moves forward a bit to get in better RPS range
+        move_forward_inches(20_pct, 3_in); // Moves forward a bit to get in better RPS range
         RPS_correct_heading(180, 3);
-        move_forward_inches(20, 3.5 + DIST_AXIS_CDS); // Initially 12.9
+        move_forward_inches(20_pct, Inches(3.5 + DIST_AXIS_CDS)); // Initially 12.9
         RPS_correct_heading(180, 3);
-        turn_right_degrees(20, 45);
+        turn_right_degrees(20_pct, 45_deg);
         RPS_correct_heading(135, 3);
 
         // Flips ice cream lever, about 3 inches in front of it (including base servo arm)
@@ -1668,462 +3381,442 @@ void run_course(int courseNumber) {
         Sleep(1.0);
 
         write_status("Aligning with ramp");
-        move_forward_inches(FORWARD_SPEED, 11.75 + DIST_AXIS_CDS); // Initially 11.55, then 12.05
-        turn_right_degrees(TURN_SPEED, 45);
+        move_forward_inches(FORWARD_SPEED, Inches(11.75 + DIST_AXIS_CDS)); // Initially 11.55, then 12.05
+        turn_right_degrees(TURN_SPEED, 45_deg);
 
         write_status("Moving up ramp");
         // Subtracts three to avoid dead zone
-        move_forward_inches(40, 30.26 + DIST_AXIS_CDS); // Initially 35.26
+        move_forward_inches(40_pct, Inches(30.26 + DIST_AXIS_CDS)); // Initially 35.26
         RPS_check_y(52.25, 3); // On top of ramp y-coord, initially 55
 
-        turn_left_degrees(TURN_SPEED, 90);
+        turn_left_degrees(TURN_SPEED, 90_deg);
         RPS_check_x(15.45, 3); // Initially 15.1
 
-        turn_right_degrees(TURN_SPEED, 90);
-        move_forward_inches(FORWARD_SPEED, 4.20); // Initially 3.25
-        turn_left_degrees(TURN_SPEED, 45);
+        turn_right_degrees(TURN_SPEED, 90_deg);
+        move_forward_inches(FORWARD_SPEED, 4.20_in); // Initially 3.25
+        turn_left_degrees(TURN_SPEED, 45_deg);
 
         //Flips ice cream lever, about 3 inches in front of it (including base servo arm)
         flip_ice_cream_lever();
 
         write_status("Moving towards final button");
-        turn_right_degrees(TURN_SPEED, 45);
-        move_forward_inches(-20, 3);
+        turn_right_degrees(TURN_SPEED, 45_deg);
+        move_forward_inches(-20_pct, 3_in);
         RPS_correct_heading(90, 3);
-        move_forward_inches(-20, 31.46 + DIST_AXIS_CDS); // Initially 35.26
-        turn_left_degrees(TURN_SPEED, 45);
-        move_forward_inches(-FORWARD_SPEED, 20);
+        move_forward_inches(-20_pct, Inches(31.46 + DIST_AXIS_CDS)); // Initially 35.26
+        turn_left_degrees(TURN_SPEED, 45_deg);
+        move_forward_inches(-FORWARD_SPEED, 20_in);
 
         break;
 
     case IND_COMP: // Individual Competition
         write_status("Running Individual Competition");
-
-        /*********************************************************************/
-        // Jukebox
-
-            //************
-            write_status("Moving towards jukebox");
-
-            // Heads from button to center
-            move_forward_inches(FORWARD_SPEED, 9 + DIST_AXIS_CDS); // Direct: 7.5 inches 
-
-            // Moves towards jukebox
-            turn_left_degrees(TURN_SPEED, 45);
-
-            // Moves on_arm_servo out of the way
-            on_arm_servo.SetDegree(90); 
-
-            // Over CdS cell
-            move_forward_inches(FORWARD_SPEED, 11.5 - 1.0607);
-            RPS_check_x(RPS_Top_Level_X_Reference - 7.8, 2); // Initially 8.8 left of top x reference
-
-            // Face jukebox
-            turn_left_degrees(TURN_SPEED, 90);
-
-            //Reverses to move CdS cell over jukebox light and make room for arm
-            move_forward_inches(-FORWARD_SPEED, DIST_AXIS_CDS + 0.25 - 1.0607); // 0.5 wasn't initially there
-            RPS_check_y(RPS_Top_Level_Y_Reference - 34, 2); // 35 below top y reference 18.3. Initially 33.7
-
-            //************
-            write_status("Pressing jukebox buttons");
-            
-            // Presses jukebox buttons, returning to CdS cell over jukebox light
-            press_jukebox_buttons();
-
-            // Sets on_arm_servo into initial position
-            on_arm_servo.SetDegree(180);
-
-            // Moves back forward to axis over jukebox light
-            move_forward_inches(FORWARD_SPEED, DIST_AXIS_CDS);
-            
-            //************
-
-            write_status("Moving towards ramp");
-
-            // Moves to center (aligns with ramp)
-            turn_left_degrees(TURN_SPEED, 90);
-            move_forward_inches(FORWARD_SPEED, 9.25); // Initially 9
-            turn_left_degrees(TURN_SPEED, 90);
-
-        /*********************************************************************/
-        // Ramp
-
-            // Moves up ramp 9 inches from jukebox light
-            // OR 11.75 + DIST_AXIS_CDS from starting light
-            write_status("Moving up ramp");
-
-            // Checks that it is positioned straight
-            RPS_correct_heading(RPS_90_Degrees, 2);
-
-            // Subtracts three to avoid dead zone
-            // Gets to that place on top of the ramp (52.25, 15.45)
-            move_forward_inches(RAMP_SPEED, 30.26 + DIST_AXIS_CDS); // Initially 30.26 + DIST_AXIS_CDS. Took off because no longer moves forward after jukebox
-
-            // Checks x and y coordinate after going up
-            // RPS_check_y(RPS_Top_Level_Y_Reference, 2); 
-
-            // Checks x (may need to edit)
-            //turn_left_degrees(TURN_SPEED, 90); 
-            turn_right_degrees(TURN_SPEED, 90); // Initially 180 degrees to correct for RPS check
-            RPS_check_x(RPS_Top_Level_X_Reference + 4.65, 2);
-            
-
-
-        /*********************************************************************/
-        // Sink
-
-            // Reverses towards sink
-            move_forward_inches(-FORWARD_SPEED, 9.25); 
-
-            // Aligns and backs up to edge of sink (~8 inches away)
-            turn_left_degrees(TURN_SPEED, 90);
-            move_forward_seconds(-40, 1);
-            
-            write_status("Dropping tray");
-
-            // Moves servos to drop tray
-            base_servo.SetDegree(85.);
-            base_servo.SetDegree(105.);
-            Sleep(0.5); // Lets tray fall
-            base_servo.SetDegree(85.);
-
-            write_status("Moving away from sink");
-
-            // Drives away from sink
-            move_forward_inches(FORWARD_SPEED, 7.75);
-
-            // Moves towards that one spot on top (facing rightwards)
-            turn_right_degrees(TURN_SPEED, 90);
-            //RPS_correct_heading(RPS_0_Degrees, 2); // IN DEADZONE
-            move_forward_inches(FORWARD_SPEED, 9.25);
-
-
-        /*********************************************************************/
-        // Ticket
-
-            // From that one spot on top (facing right)
-            write_status("Moving towards ticket");
-
-            // Turns to face left (to be able to reverse towards ticket)
-            turn_left_degrees(30, 180);
-            //RPS_check_x(RPS_Top_Level_X_Reference, 2); // 15.45
-
-            // Reverses towards ticket
-            move_forward_inches(-FORWARD_SPEED, 13.25); // Initially 13.65
-            RPS_check_x(RPS_Top_Level_X_Reference + 13.25, 2);
-
-            // Facing ticket
-            turn_left_degrees(TURN_SPEED, 90);
-
-            // Slides ticket from y=52.25
-            write_status("Sliding ticket");
-            on_arm_servo.SetDegree(43); // Initially 45
-            base_servo.SetDegree(0);
-            RPS_check_y(RPS_Top_Level_Y_Reference - 4.65, 2); // 52.25 - 4.65
-
-            move_forward_inches(20, 4.75); // Inserts arm into ticket slot, initially 0.25
-
-            // Reverses away from ticket
-            on_arm_servo.SetDegree(180);
-            move_forward_inches(-20, 4.75);
-
-        /*********************************************************************/
-        // Hot Plate
-
-            // From in front of ticket
-            write_status("Moving towards hot plate");
-            
-            // Resets arm positions
-            on_arm_servo.SetDegree(8);
-            base_servo.SetDegree(85);
-
-            // Moves towards the front
-            turn_right_degrees(TURN_SPEED, 90);
-            move_forward_inches(FORWARD_SPEED, 6); // Initially 5.85
-            RPS_check_x(RPS_Top_Level_X_Reference + 7.65, 4); // Initially 7.8
-            turn_right_degrees(TURN_SPEED, 90);
-
-            // Currently at y=52.25, needs to be at y=55
-            move_forward_inches(FORWARD_SPEED, 2.75); // 2.75 initially
-            RPS_check_y(RPS_Top_Level_Y_Reference + 2.75, 4);
-
-            /* 
-                * Flips burger when y=55 and facing towards it
-                * Finishes at y=56.45 in front of first plate
-                */
-            flip_burger();
-
-            RPS_check_y(RPS_Top_Level_Y_Reference + 4, 2); // Initially 55.95, initially plus 3.7
-
-            turn_left_degrees(TURN_SPEED, 90);
-
-            // In front of initial plate, 4.05 inches from front, heading=0
-            RPS_check_x(RPS_Top_Level_X_Reference + 7.4, 2); // Initially 21.7
-            
-
-        /*********************************************************************/
-        // Ice cream lever
-
-            // From after flip_burger() (at y=55 in front of reverse plate (5.8 inches right from front))
-            // Needs to be at y=56.45 and x=15.45 (LEFT) (Can't check x though at y=56.45 since DEAD ZONE)
-            write_status("Moving towards ice cream");
-            
-            move_forward_inches(20, 5); // Moves to x=15.45, initially 5.75
-            //RPS_check_x(15.45); // IN DEADZONE
-
-            // Faces towards levers
-            turn_right_degrees(TURN_SPEED, 45);
-
-            /*
-            * Flips correct ice cream lever when y=56.45 (VERTICALLY) and x=15.45 (LEFT)
-            * Must be facing towards ice cream levers.
-            * Finishes where it started.
-            */
-            flip_ice_cream_lever();
-
-        /*********************************************************************/
-        // Final button
-
-            // From after flip_ice_cream_lever()
-            // y=56.45, x=15.45 FACING LEVERS
-            write_status("Moving towards final button");
-
-            // Turns to reverse down ramp
-            turn_right_degrees(TURN_SPEED, 45);
-
-            // Reverses back out of dead zone to check heading
-            move_forward_inches(-FORWARD_SPEED, 4.20);
-            RPS_correct_heading(RPS_90_Degrees, 4);
-
-            // Moves down ramp
-            move_forward_inches(-FORWARD_SPEED, 30.26);
-
-            // Heads towards final button
-            turn_left_degrees(TURN_SPEED, 45);
-            move_forward_inches(-FORWARD_SPEED, 20);
-
-
+        mission_run<MISSION_NEEDS_RPS | MISSION_NEEDS_RPS_VALUES>(indCompMission);
         break;
 
     case FINAL_COMP: // Final Competition
-
         write_status("Running Final Competition");
+        mission_run<MISSION_NEEDS_RPS | MISSION_NEEDS_RPS_VALUES>(finalCompMission);
+        break;
+    
+    default:
+        LCD.WriteRC("ERROR: NO COURSE SPECIFIED", 1, 0);
+        break;
+    }
 
-        /*********************************************************************/
-        // Jukebox
-
-            //************
-            write_status("Moving towards jukebox");
-
-            // Heads from button to center
-            move_forward_inches(FORWARD_SPEED, 9 + DIST_AXIS_CDS); // Direct: 7.5 inches 
-
-            // Moves towards jukebox
-            turn_left_degrees(TURN_SPEED, 45);
-
-            // Moves on_arm_servo out of the way
-            on_arm_servo.SetDegree(90); 
-
-            // Over CdS cell
-            move_forward_inches(FORWARD_SPEED, 11.5 - 1.0607);
-            RPS_check_x(RPS_Top_Level_X_Reference - 8.2, 1); // Initially 8.8 left of top x reference
+    // Closes the last stage on the timeline
+    timeline_stage_end();
+}
 
-            // Face jukebox
-            turn_left_degrees(TURN_SPEED, 90);
+/*******************************************************
+ * @brief Runs one motor by itself and times its encoder once it has spun up.
+ * The encoders count up either way, so the rate can't tell which way the
+ * wheel went.
+ *
+ * @param percent Motor percent (negative for backward)
+ * @param counts 0 to run for SELF_TEST_PULSE_TIME. Otherwise the counts to
+ * run for (up to twice as long), so a pulse can undo the one before it. Set
+ * to the counts when the motor was stopped.
+ * @return float Encoder counts per second
+ */
+float self_test_pulse(FEHMotor &motor, DigitalEncoder &encoder, float percent, int *counts) {
+    encoder.ResetCounts();
+    motor.SetPercent(percent);
+    double startTime = TimeNow();
+    Sleep(SELF_TEST_PULSE_TIME - SELF_TEST_RATE_TIME);
 
-            //Reverses to move CdS cell over jukebox light and make room for arm
-            move_forward_inches(-FORWARD_SPEED, DIST_AXIS_CDS + 0.25 - 1.0607); // 0.5 wasn't initially there
-            RPS_check_y(RPS_Top_Level_Y_Reference - 33.75, 2); // 35 below top y reference 18.3. Initially 33.7
+    int rateCounts = encoder.Counts();
+    double rateTime = TimeNow();
 
-            //************
-            write_status("Pressing jukebox buttons");
-            
-            // Presses jukebox buttons, returning to CdS cell over jukebox light
-            press_jukebox_buttons();
+    if (*counts <= 0) {
+        Sleep(SELF_TEST_RATE_TIME);
+    } else {
+        while ((encoder.Counts() < *counts) && (TimeNow() - startTime < 2 * SELF_TEST_PULSE_TIME));
+    }
+    motor.Stop();
 
-            // Sets on_arm_servo into initial position
-            on_arm_servo.SetDegree(180);
+    *counts = encoder.Counts();
+    return (*counts - rateCounts) / (TimeNow() - rateTime);
+}
 
-            // Moves back forward to axis over jukebox light
-            move_forward_inches(FORWARD_SPEED, DIST_AXIS_CDS);
-            
-            //************
+/*******************************************************
+ * @brief Pulses one motor forward and back the same counts, which pivots the
+ * robot about the other wheel and puts it back. The encoder has to count at SELF_TEST_MIN_RATE
+ * both ways, and RPS (when it has a heading) has to see the forward pulse
+ * turn the robot the way that motor should. That catches an unplugged or
+ * swapped encoder and a motor wired backward.
+ *
+ * @param turn TURN_LEFT or TURN_RIGHT, the way a forward pulse should pivot the robot
+ */
+MotorTest self_test_motor(FEHMotor &motor, DigitalEncoder &encoder, int turn) {
+    MotorTest test;
 
-            write_status("Moving towards ramp");
+    float before = RPS.Heading();
+    int counts = 0;
+    test.forwardRate = self_test_pulse(motor, encoder, SELF_TEST_PERCENT.value, &counts);
 
-            // Moves to center (aligns with ramp)
-            turn_left_degrees(TURN_SPEED, 90);
-            move_forward_inches(FORWARD_SPEED, 9.25); // Initially 9
-            turn_left_degrees(TURN_SPEED, 90);
+    Sleep(RPS_DELAY_TIME);
+    float after = RPS.Heading();
 
-        /*********************************************************************/
-        // Ramp
+    // Drives back as far as it drove forward, so both coast the same
+    test.backwardRate = self_test_pulse(motor, encoder, -SELF_TEST_PERCENT.value - BACKWARDS_CALIBRATOR, &counts);
 
-            // Moves up ramp 9 inches from jukebox light
-            // OR 11.75 + DIST_AXIS_CDS from starting light
-            write_status("Moving up ramp");
+    test.rpsSawIt = (before >= 0) && (after >= 0);
+    test.turned = test.rpsSawIt ? turn_between(before, after) : 0;
 
-            // Checks that it is positioned straight
-            RPS_correct_heading(RPS_90_Degrees, 2);
+    test.passed = (test.forwardRate >= SELF_TEST_MIN_RATE) && (test.backwardRate >= SELF_TEST_MIN_RATE) &&
+                  (!test.rpsSawIt || (test.turned * turn >= SELF_TEST_MIN_TURN));
+    return test;
+}
 
-            // Subtracts three to avoid dead zone
-            // Gets to that place on top of the ramp (52.25, 15.45)
-            // move_forward_inches(RAMP_SPEED, 30.26 + DIST_AXIS_CDS); // Initially 30.26 + DIST_AXIS_CDS. Took off because no longer moves forward after jukebox
-            move_forward_PID(5, 30.26 + DIST_AXIS_CDS);
+/*******************************************************
+ * @brief Writes one motor's self test results on a row
+ */
+void show_motor_test(const char name[], const MotorTest &test, int row) {
+    LCD.WriteRC(name, row, 0);
+    LCD.WriteRC((int)test.forwardRate, row, 2);
+    LCD.WriteRC((int)test.backwardRate, row, 7);
+    if (test.rpsSawIt) {
+        LCD.WriteRC((int)test.turned, row, 12);
+    }
+    LCD.WriteRC(test.passed ? "OK" : "FAIL", row, 17);
+}
 
-            // Checks x and y coordinate after going up
-            // RPS_check_y(RPS_Top_Level_Y_Reference, 2); 
+/*******************************************************
+ * @brief Pre-flight check, run with the robot in the start box before the
+ * light. Pulses each drive motor (see self_test_motor()), swings both arm
+ * servos off ARM_STOWED and back, and checks RPS has a fix. Shows the
+ * measured rates and turns, and waits for a touch when anything failed.
+ * The servos have no feedback, so they are only swung for someone to watch.
+ *
+ * @param line Line it was called from (filled in automatically, used by the cost report)
+ * @return bool true if everything passed
+ */
+bool self_test(int line) {
+    TimelineScope timeline("self_test", 0, COST_OTHER, line);
 
-            // Checks x (may need to edit)
-            //turn_left_degrees(TURN_SPEED, 90); 
-            turn_right_degrees(TURN_SPEED, 90); // Initially 180 degrees to correct for RPS check
-            RPS_check_x(RPS_Top_Level_X_Reference + 4.65, 8);
-            
+    LCD.Clear();
+    write_status("Self test");
 
+    bool rpsOK = (RPS.X() > 0) && (RPS.Y() > 0) && (RPS.Heading() >= 0);
 
-        /*********************************************************************/
-        // Sink
+    // The servos swing while the motors run
+    base_servo.SetDegree(ARM_STOWED.base - SELF_TEST_SERVO_SWING);
+    on_arm_servo.SetDegree(ARM_STOWED.onArm + SELF_TEST_SERVO_SWING);
 
-            // Reverses towards sink
-            move_forward_inches(-FORWARD_SPEED, 8.5); 
+    MotorTest left = self_test_motor(left_motor, left_encoder, TURN_RIGHT);
 
-            // Aligns and backs up to edge of sink (~8 inches away)
-            turn_left_degrees(TURN_SPEED, 90);
-            move_forward_seconds(-40, 1);
-            
-            write_status("Dropping tray");
+    base_servo.SetDegree(ARM_STOWED.base);
+    on_arm_servo.SetDegree(ARM_STOWED.onArm);
 
-            // Moves servos to drop tray
-            base_servo.SetDegree(85.);
-            base_servo.SetDegree(105.);
-            Sleep(0.5); // Lets tray fall
-            base_servo.SetDegree(85.);
+    MotorTest right = self_test_motor(right_motor, right_encoder, TURN_LEFT);
 
-            write_status("Moving away from sink");
+    // The pivots moved the RPS point. Lets RPS catch up so the start pose
+    // read next is where the robot really is.
+    distanceScaleKnown = false;
+    distanceScaleStopTime = TimeNow();
+    Sleep(RPS_DELAY_TIME);
 
-            // Drives away from sink
-            move_forward_inches(FORWARD_SPEED, 7.75);
+    bool passed = left.passed && right.passed && rpsOK;
 
-            // Moves towards that one spot on top (facing rightwards)
-            turn_right_degrees(TURN_SPEED, 90);
-            //RPS_correct_heading(RPS_0_Degrees, 2); // IN DEADZONE
-            move_forward_inches(FORWARD_SPEED, 8.5);
+    write_status(passed ? "Self test passed" : "Self test FAILED");
+    LCD.WriteRC("  fwd  back turn", 2, 0);
+    show_motor_test("L", left, 3);
+    show_motor_test("R", right, 4);
+    LCD.WriteRC("RPS:", 5, 0);
+    LCD.WriteRC(rpsOK ? "OK" : "no fix", 5, 5);
+    LCD.WriteRC("Servos: swung", 6, 0);
 
+    if (!passed) {
+        LCD.WriteRC("Touch to go on", 8, 0);
+        idle_wait_release();
+        int x, y;
+        idle_wait_touch(&x, &y);
+    }
+    return passed;
+}
 
-        /*********************************************************************/
-        // Ticket
+/*******************************************************
+ * @brief Drives both motors with the same command for a while and samples
+ * both encoders every SYSID_SAMPLE_PERIOD into sysidSamples, then stops and
+ * waits SYSID_SETTLE_TIME.
+ *
+ * @param percent Step percent, or the middle of the chirp (negative for backward)
+ * @param amplitude 0 for a step. Otherwise the chirp swings this many percent
+ * either way, sweeping from SYSID_CHIRP_START to SYSID_CHIRP_END Hz.
+ * @param seconds How long to drive
+ * @return int Samples taken
+ */
+int sysid_record(float percent, float amplitude, double seconds) {
+    left_encoder.ResetCounts();
+    right_encoder.ResetCounts();
 
-            // From that one spot on top (facing right)
-            write_status("Moving towards ticket");
+    double startTime = TimeNow();
+    int count = 0;
 
-            // Turns to face left (to be able to reverse towards ticket)
-            turn_left_degrees(30, 180);
-            //RPS_check_x(RPS_Top_Level_X_Reference, 2); // 15.45
+    while (count < SYSID_MAX_SAMPLES) {
+        float time = TimeNow() - startTime;
+        if (time >= seconds) {
+            break;
+        }
 
-            // Reverses towards ticket
-            move_forward_inches(-FORWARD_SPEED, 13); // Initially 13.65
-            RPS_check_x(RPS_Top_Level_X_Reference + 13, 6);
+        float command = percent;
+        if (amplitude != 0) {
+            float cycles = SYSID_CHIRP_START * time + (SYSID_CHIRP_END - SYSID_CHIRP_START) * time * time / (2 * seconds);
+            command += amplitude * sin(2 * PI * cycles);
+        }
+        left_motor.SetPercent(command);
+        right_motor.SetPercent(command);
 
-            // Facing ticket
-            turn_left_degrees(TURN_SPEED, 90);
+        sysidSamples[count].time = time;
+        sysidSamples[count].counts[DRIVE_LEFT] = left_encoder.Counts();
+        sysidSamples[count].counts[DRIVE_RIGHT] = right_encoder.Counts();
+        sysidSamples[count].percent = command;
+        count++;
 
-            // Slides ticket from y=52.25
-            write_status("Sliding ticket");
-            on_arm_servo.SetDegree(45); // Initially 45
-            base_servo.SetDegree(0);
-            RPS_check_y(RPS_Top_Level_Y_Reference - 4.65, 8); // 52.25 - 4.65
+        Sleep(SYSID_SAMPLE_PERIOD);
+    }
 
-            move_forward_inches(20, 5.25); // Inserts arm into ticket slot, initially 0.25
+    left_motor.Stop();
+    right_motor.Stop();
+    Sleep(SYSID_SETTLE_TIME);
 
-            // Reverses away from ticket
-            on_arm_servo.SetDegree(180);
-            Sleep(0.25);
-            move_forward_inches(-20, 5.25);
+    return count;
+}
 
-        /*********************************************************************/
-        // Hot Plate
+/*******************************************************
+ * @brief Fits a line to one wheel's inches once it is up to speed. A first
+ * order wheel from still runs along speed * (time - timeConstant), so the
+ * line's slope is the speed and where it crosses 0 is the time constant.
+ *
+ * @param count Samples from sysid_record()
+ * @param side DRIVE_LEFT or DRIVE_RIGHT
+ * @param speed Set to inches per second
+ * @param timeConstant Set to seconds (0 if the wheel didn't turn)
+ */
+void sysid_fit_step(int count, int side, float &speed, float &timeConstant) {
+    float n = 0, sumT = 0, sumX = 0, sumTT = 0, sumTX = 0;
+    for (int i = 0; i < count; i++) {
+        if (sysidSamples[i].time >= SYSID_FIT_FROM) {
+            float t = sysidSamples[i].time;
+            float x = sysidSamples[i].counts[side] * INCH_PER_COUNT;
+            n++;
+            sumT += t;
+            sumX += x;
+            sumTT += t * t;
+            sumTX += t * x;
+        }
+    }
 
-            // From in front of ticket
-            write_status("Moving towards hot plate");
-            
-            // Resets arm positions
-            on_arm_servo.SetDegree(8);
-            base_servo.SetDegree(85);
+    float denominator = n * sumTT - sumT * sumT;
+    speed = (denominator > 0) ? (n * sumTX - sumT * sumX) / denominator : 0;
+    timeConstant = (speed > 0) ? (sumT - sumX / speed) / n : 0;
+}
 
-            // Moves towards the front
-            turn_right_degrees(TURN_SPEED, 90);
-            move_forward_inches(FORWARD_SPEED, 6.5); // Initially 6.25
-            RPS_check_x(RPS_Top_Level_X_Reference + 7.05, 2); // Initially 7.15
-            turn_right_degrees(TURN_SPEED, 90);
+/*******************************************************
+ * @brief Fits speed = gain * (percent - deadband) to the step speeds of one
+ * motor in one direction. Leaves the time constant alone.
+ */
+void sysid_fit_line(const float percents[], const float speeds[], int count, MotorModel &model) {
+    float sumP = 0, sumV = 0, sumPP = 0, sumPV = 0;
+    for (int i = 0; i < count; i++) {
+        sumP += percents[i];
+        sumV += speeds[i];
+        sumPP += percents[i] * percents[i];
+        sumPV += percents[i] * speeds[i];
+    }
 
-            // Currently at y=52.25, needs to be at y=55
-            RPS_correct_heading(90, 3);
-            move_forward_inches(FORWARD_SPEED, 2.75); // 2.75 initially
-            RPS_check_y(RPS_Top_Level_Y_Reference + 2.75, 4);
+    float denominator = count * sumPP - sumP * sumP;
+    model.gain = (denominator > 0) ? (count * sumPV - sumP * sumV) / denominator : 0;
+    model.deadband = (model.gain > 0) ? (sumP - sumV / model.gain) / count : 0;
+    if (model.deadband < 0) {
+        model.deadband = 0;
+    }
+}
 
-            /* 
-                * Flips burger when y=55 and facing towards it
-                * Finishes at y=56.45 in front of first plate
-                */
-            flip_burger();
+/*******************************************************
+ * @brief Runs a model through the commands of the last sysid_record() and
+ * compares the inches it gets with the encoder's
+ *
+ * @param side DRIVE_LEFT or DRIVE_RIGHT
+ * @return float RMS inches off
+ */
+float sysid_chirp_error(int count, int side, const MotorModel &model) {
+    float speed = 0, inches = 0, sumSquares = 0;
+    for (int i = 1; i < count; i++) {
+        float dt = sysidSamples[i].time - sysidSamples[i - 1].time;
+        speed += (motor_model_speed(model, sysidSamples[i - 1].percent) - speed) * (1 - exp(-dt / model.timeConstant));
+        inches += speed * dt;
+
+        float off = inches - sysidSamples[i].counts[side] * INCH_PER_COUNT;
+        sumSquares += off * off;
+    }
+    return (count > 1) ? sqrt(sumSquares / (count - 1)) : 0;
+}
 
-            RPS_check_y(RPS_Top_Level_Y_Reference + 4, 4); // Initially 55.95, initially plus 3.7
+/*******************************************************
+ * @brief Drives straight back until both encoders average a number of
+ * counts, or twice as long as that should take
+ */
+void sysid_return(int counts) {
+    left_encoder.ResetCounts();
+    right_encoder.ResetCounts();
 
-            turn_left_degrees(TURN_SPEED, 90);
+    float percent = -SYSID_CHIRP_PERCENT - BACKWARDS_CALIBRATOR;
+    left_motor.SetPercent(percent);
+    right_motor.SetPercent(percent);
 
-            // In front of initial plate, 4.05 inches from front, heading=0
-            RPS_check_x(RPS_Top_Level_X_Reference + 7.4, 4); // Initially 21.7
-            
+    double startTime = TimeNow();
+    while (((left_encoder.Counts() + right_encoder.Counts()) / 2 < counts) && (TimeNow() - startTime < 2 * SYSID_CHIRP_TIME));
 
-        /*********************************************************************/
-        // Ice cream lever
+    left_motor.Stop();
+    right_motor.Stop();
+    Sleep(SYSID_SETTLE_TIME);
+}
 
-            // From after flip_burger() (at y=55 in front of reverse plate (5.8 inches right from front))
-            // Needs to be at y=56.45 and x=15.45 (LEFT) (Can't check x though at y=56.45 since DEAD ZONE)
-            write_status("Moving towards ice cream");
-            
-            move_forward_inches(20, 4.5); // Moves to x=15.45, initially 5
-            //RPS_check_x(15.45); // IN DEADZONE
+/*******************************************************
+ * @brief Fits both drive motors on the surface the robot is on. Steps each
+ * of SYSID_STEP_PERCENTS forward then back for the gain, deadband and time
+ * constant in each direction. The backward steps use the raw percent, so the
+ * two directions show what BACKWARDS_CALIBRATOR makes up for. Then a forward
+ * chirp checks the forward models, and the chirp is driven back.
+ *
+ * @param surface SURFACE_FLOOR or SURFACE_RAMP (facing uphill)
+ * @param model Gets this surface's motors and chirp errors
+ */
+void sysid_surface(int surface, DriveModel &model) {
+    float speeds[DRIVE_SIDES][DRIVE_DIRECTIONS][SYSID_STEP_COUNT];
+    float timeConstants[DRIVE_SIDES][DRIVE_DIRECTIONS] = { { 0, 0 }, { 0, 0 } };
+
+    for (int i = 0; i < SYSID_STEP_COUNT; i++) {
+        for (int direction = 0; direction < DRIVE_DIRECTIONS; direction++) {
+            float percent = (direction == DRIVE_FORWARD) ? SYSID_STEP_PERCENTS[i] : -SYSID_STEP_PERCENTS[i];
+            int count = sysid_record(percent, 0, SYSID_STEP_TIME);
+
+            for (int side = 0; side < DRIVE_SIDES; side++) {
+                float timeConstant;
+                sysid_fit_step(count, side, speeds[side][direction][i], timeConstant);
+                timeConstants[side][direction] += timeConstant / SYSID_STEP_COUNT;
+            }
+        }
+    }
 
-            // Faces towards levers
-            turn_right_degrees(TURN_SPEED, 45);
+    for (int side = 0; side < DRIVE_SIDES; side++) {
+        for (int direction = 0; direction < DRIVE_DIRECTIONS; direction++) {
+            MotorModel &motor = model.motor[surface][side][direction];
+            sysid_fit_line(SYSID_STEP_PERCENTS, speeds[side][direction], SYSID_STEP_COUNT, motor);
+            motor.timeConstant = timeConstants[side][direction];
+        }
+    }
 
-            /*
-                * Flips correct ice cream lever when y=56.45 (VERTICALLY) and x=15.45 (LEFT)
-                * Must be facing towards ice cream levers.
-                * Finishes where it started.
-                */
-            flip_ice_cream_lever();
+    int count = sysid_record(SYSID_CHIRP_PERCENT, SYSID_CHIRP_AMPLITUDE, SYSID_CHIRP_TIME);
+    for (int side = 0; side < DRIVE_SIDES; side++) {
+        model.chirpError[surface][side] = motor_model_valid(model.motor[surface][side][DRIVE_FORWARD]) ?
+                                          sysid_chirp_error(count, side, model.motor[surface][side][DRIVE_FORWARD]) : 0;
+    }
+    sysid_return((left_encoder.Counts() + right_encoder.Counts()) / 2);
+}
 
-        /*********************************************************************/
-        // Final button
+/*******************************************************
+ * @brief Name start_menu() shows for a course
+ */
+const char *course_name(int courseNumber) {
+    for (int i = 0; i < MENU_COURSE_COUNT; i++) {
+        if (MENU_COURSES[i].courseNumber == courseNumber) {
+            return MENU_COURSES[i].name;
+        }
+    }
+    return "Unknown";
+}
 
-            // From after flip_ice_cream_lever()
-            // y=56.45, x=15.45 FACING LEVERS
-            write_status("Moving towards final button");
+/*******************************************************
+ * @brief Whether a course uses RPS and starts on the light. The test courses,
+ * the servo calibration and the drive sysid start on a touch instead.
+ */
+bool course_needs_rps(int courseNumber) {
+    return (courseNumber != TEST_COURSE_1) && (courseNumber != TEST_COURSE_2) && (courseNumber != TEST_COURSE_3) &&
+           (courseNumber != CALIBRATE_SERVOS) && (courseNumber != SYSID_DRIVE);
+}
 
-            // Turns to reverse down ramp
-            turn_right_degrees(TURN_SPEED, 45);
+/*******************************************************
+ * @brief Shows every course as a button and waits for one to be touched.
+ * Counts down on the status line and runs the default when it reaches 0. A
+ * touch that was already down when the menu opened doesn't count.
+ *
+ * @param defaultCourse Course to run when nothing is touched
+ * @param timeout Seconds to wait
+ * @return int Course number to run
+ */
+int start_menu(int defaultCourse, double timeout) {
+    LCD.Clear();
+    LCD.WriteRC("Default:", 0, 1);
+    LCD.WriteRC(course_name(defaultCourse), 0, 10);
 
-            // Reverses back out of dead zone to check heading
-            move_forward_inches(-FORWARD_SPEED, 4.20);
-            RPS_correct_heading(RPS_90_Degrees, 3);
+    // Buttons
+    for (int column = 1; column < MENU_COLUMNS; column++) {
+        LCD.DrawVerticalLine(column * MENU_BUTTON_WIDTH, MENU_TOP, 239);
+    }
+    for (int i = 0; i < MENU_COURSE_COUNT; i++) {
+        int column = i / MENU_ROWS;
+        int row = i % MENU_ROWS;
+        int top = MENU_TOP + row * MENU_BUTTON_HEIGHT;
 
-            // Moves down ramp
-            move_forward_inches(-RAMP_SPEED, 30.26);
+        LCD.DrawHorizontalLine(top, column * MENU_BUTTON_WIDTH, (column + 1) * MENU_BUTTON_WIDTH - 1);
+        LCD.WriteRC(MENU_COURSES[i].name, (top + MENU_BUTTON_HEIGHT / 2 - 8) / 17, column * MENU_BUTTON_WIDTH / 12 + 2);
+    }
 
-            // Heads towards final button
-            turn_left_degrees(TURN_SPEED, 45);
-            move_forward_inches(-50, 30);
+    double startTime = TimeNow();
+    int shownSeconds = -1;
+    bool released = false;
+    int x, y;
+
+    while (TimeNow() - startTime < timeout) {
+        // Redraws the countdown once a second
+        int seconds = (int)ceil(timeout - (TimeNow() - startTime));
+        if (seconds != shownSeconds) {
+            write_status("Starts in");
+            LCD.WriteRC(seconds, 1, 12);
+            shownSeconds = seconds;
+        }
 
+        if (!LCD.Touch(&x, &y)) {
+            released = true;
+        } else if (released && (y >= MENU_TOP)) {
+            int index = ((x / MENU_BUTTON_WIDTH) * MENU_ROWS) + ((y - MENU_TOP) / MENU_BUTTON_HEIGHT);
+            if ((index >= 0) && (index < MENU_COURSE_COUNT)) {
+                LCD.Clear();
+                write_status(MENU_COURSES[index].name);
+                idle_wait_release();
+                return MENU_COURSES[index].courseNumber;
+            }
+        }
 
-        break;
-    
-    default:
-        LCD.WriteRC("ERROR: NO COURSE SPECIFIED", 1, 0);
-        break;
+        idle_sleep(IDLE_POLL_PERIOD);
     }
+
+    LCD.Clear();
+    write_status(course_name(defaultCourse));
+    return defaultCourse;
 }
 
 /*****************************************************************
@@ -2134,23 +3827,90 @@ int main() {
     // Initiates servos 25.3 58.3
     initiate_servos();
 
-    // Initializes RPS
-    RPS.InitializeTouchMenu();
-
     // Clears the screen
     LCD.SetBackgroundColor(BACKGROUND_COLOR);
     LCD.SetFontColor(FONT_COLOR);
     LCD.Clear();
 
-    // Gets RPS heading values to decrease inconsistencies from course to course
-    // Clears screen to a yellow screen until touch is detected
-    update_RPS_Heading_values(60, true, true, true);
+    // Course to run, picked on the screen so switching doesn't need a rebuild
+    int courseNumber = menuCourse;
+    if (courseNumber < 0) {
+        courseNumber = start_menu(MENU_DEFAULT_COURSE, MENU_TIMEOUT);
+    }
+
+    if (course_needs_rps(courseNumber)) {
+        // Initializes RPS
+        RPS.InitializeTouchMenu();
+
+        // Gets RPS heading values to decrease inconsistencies from course to course
+        // Clears screen to a yellow screen until touch is detected
+        update_RPS_Heading_values(60, true, true, true);
 
-    // Waits until start light is read
-    read_start_light(45);
+        // Checks the motors, encoders, servos and RPS with the robot in the start box
+        if (selfTestAtStart) {
+            self_test();
+        }
+
+        // Waits until start light is read
+        read_start_light(45);
+    }
 
-    // Runs specified course number.
-    run_course(FINAL_COMP);
+    // Starts the turns from the track widths the last runs learned
+    track_width_load(TRACK_WIDTH_FILE, trackWidths, ROBOT_WIDTH * (1 - TRACK_WIDTH_LIMIT), ROBOT_WIDTH * (1 + TRACK_WIDTH_LIMIT));
+
+    // Starts recording the run, along with the RPS values and SD card files it depends on
+    sensor_trace_start(courseNumber);
+    sensor_trace_state("RPS_0_Degrees", RPS_0_Degrees);
+    sensor_trace_state("RPS_90_Degrees", RPS_90_Degrees);
+    sensor_trace_state("RPS_180_Degrees", RPS_180_Degrees);
+    sensor_trace_state("RPS_270_Degrees", RPS_270_Degrees);
+    sensor_trace_state("RPS_Top_Level_X_Reference", RPS_Top_Level_X_Reference);
+    sensor_trace_state("RPS_Top_Level_Y_Reference", RPS_Top_Level_Y_Reference);
+    sensor_trace_state("startIceCream", startIceCream);
+    sensor_trace_state("startX", startX);
+    sensor_trace_state("startY", startY);
+    sensor_trace_state("startHeading", startHeading);
+    sensor_trace_state("trackWidths.width[0][0]", trackWidths.width[0][0]);
+    sensor_trace_state("trackWidths.width[0][1]", trackWidths.width[0][1]);
+    sensor_trace_state("trackWidths.width[1][0]", trackWidths.width[1][0]);
+    sensor_trace_state("trackWidths.width[1][1]", trackWidths.width[1][1]);
+    sensor_trace_state("trackWidths.samples[0][0]", trackWidths.samples[0][0]);
+    sensor_trace_state("trackWidths.samples[0][1]", trackWidths.samples[0][1]);
+    sensor_trace_state("trackWidths.samples[1][0]", trackWidths.samples[1][0]);
+    sensor_trace_state("trackWidths.samples[1][1]", trackWidths.samples[1][1]);
+    sensor_trace_state("armModel.base.minPulse", armModel.base.minPulse); // Servo calibration from initiate_servos()
+    sensor_trace_state("armModel.base.maxPulse", armModel.base.maxPulse);
+    sensor_trace_state("armModel.base.speed", armModel.base.speed);
+    sensor_trace_state("armModel.onArm.minPulse", armModel.onArm.minPulse);
+    sensor_trace_state("armModel.onArm.maxPulse", armModel.onArm.maxPulse);
+    sensor_trace_state("armModel.onArm.speed", armModel.onArm.speed);
+
+    // Starts timing the hot paths
+    probe_start();
+
+    // Runs specified course number. A touch while it runs saves the telemetry.
+    telemetry_arm_touch(true);
+    run_course(courseNumber);
+    telemetry_arm_touch(false);
+
+    // Keeps what this run learned for the next one
+    track_width_save(TRACK_WIDTH_FILE, trackWidths);
+
+    // Saves the control loop samples (host/telemetry2csv)
+    telemetry_write(TELEMETRY_FILE);
+
+    // Writes the rest of the recording to the SD card
+    sensor_trace_stop();
+
+    // Saves the timeline of the run (host/timeline2json turns it into a Chrome trace)
+    // and where its time went (host/cost_report)
+    timeline_write(TIMELINE_FILE);
+    timeline_write_costs(TIMELINE_COST_FILE);
+
+    // Saves the hot path timings (host/probe_report) and shows a summary
+    probe_write(PROBES_FILE);
+    LCD.Clear();
+    probe_write_lcd(0);
 
     return 0;
 }
@@ -0,0 +1,113 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*               Mission lists               */
+/*                                           */
+/*  A mission is a constexpr list of steps   */
+/*  (drive, turn, RPS check, servo, sleep,   */
+/*  call...) built with mission(). Every     */
+/*  step type is its own struct, so the list */
+/*  is one nested type and running it is a   */
+/*  chain of inlined calls: the same         */
+/*  straight-line code as writing the calls  */
+/*  out by hand, with no table to walk.      */
+/*                                           */
+/*  Missions are checked while compiling:    */
+/*   - a step maker that gets a bad value    */
+/*     (a percent over 100, a negative       */
+/*     time...) calls mission_invalid(),     */
+/*     which isn't constexpr, so a constexpr */
+/*     mission with it doesn't compile       */
+/*   - each step type lists what it needs    */
+/*     set up first (MISSION_NEEDS_...) and  */
+/*     mission_run() static_asserts that the */
+/*     caller has it                         */
+/*                                           */
+/*  A mission is a step too, so shared parts */
+/*  of courses are missions of their own.    */
+/*  The step types for this robot are in     */
+/*  main.cpp. Only needs C++11.              */
+/*********************************************/
+
+#ifndef MISSION_H
+#define MISSION_H
+
+/************************************************/
+// Definitions
+
+// What a step needs set up before the mission runs (bit flags)
+#define MISSION_NEEDS_NOTHING 0
+#define MISSION_NEEDS_RPS 1 // RPS.InitializeTouchMenu()
+#define MISSION_NEEDS_RPS_VALUES 2 // update_RPS_Heading_values() (the headings and top level reference)
+
+// Long missions go past GCC's normal inlining limits, so the chain of run() calls is forced inline
+#define MISSION_INLINE inline __attribute__((always_inline))
+
+/*******************************************************
+ * @brief Called by step makers when a value is out of range. Not constexpr
+ * on purpose: in a constexpr mission the call is a compile error that
+ * names the reason.
+ *
+ * @param reason What was wrong
+ * @return float 0
+ */
+inline float mission_invalid(const char reason[]) {
+    return 0;
+}
+
+/*******************************************************
+ * @brief Checks a value is in [min, max] while building a mission
+ */
+constexpr float mission_range(float value, float min, float max, const char reason[]) {
+    return ((value >= min) && (value <= max)) ? value : mission_invalid(reason);
+}
+
+/*******************************************************
+ * @brief A list of steps run in order
+ */
+template <typename... Steps>
+struct Mission;
+
+template <>
+struct Mission<> {
+    static const int needs = MISSION_NEEDS_NOTHING;
+
+    constexpr Mission() {}
+    MISSION_INLINE void run() const {}
+};
+
+template <typename First, typename... Rest>
+struct Mission<First, Rest...> {
+    static const int needs = First::needs | Mission<Rest...>::needs;
+
+    constexpr Mission(First first, Rest... rest) : first(first), rest(rest...) {}
+
+    MISSION_INLINE void run() const {
+        first.run();
+        rest.run();
+    }
+
+    First first;
+    Mission<Rest...> rest;
+};
+
+/*******************************************************
+ * @brief Makes a mission from steps (or other missions)
+ */
+template <typename... Steps>
+constexpr Mission<Steps...> mission(Steps... steps) {
+    return Mission<Steps...>(steps...);
+}
+
+/*******************************************************
+ * @brief Runs a mission after checking the caller has set up what it needs
+ *
+ * @tparam have MISSION_NEEDS_ flags that are set up
+ * @param steps Mission to run
+ */
+template <int have, typename Steps>
+MISSION_INLINE void mission_run(const Steps &steps) {
+    static_assert((Steps::needs & ~have) == 0, "mission needs something that isn't set up yet (MISSION_NEEDS_)");
+    steps.run();
+}
+
+#endif
@@ -0,0 +1,215 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*              Timing probes                */
+/*                                           */
+/*  Times hot code paths. Put a ProbeScope   */
+/*  at the top of a block and every pass     */
+/*  through it lands in that probe's         */
+/*  histogram. On the robot the time comes   */
+/*  from the Cortex-M4 cycle counter (one    */
+/*  register read), in the host build from   */
+/*  a monotonic clock. Everything lives in   */
+/*  fixed arrays, nothing is allocated.      */
+/*                                           */
+/*  probe_write() saves the histograms to    */
+/*  the SD card (host/probe_report prints    */
+/*  them), probe_write_lcd() shows a         */
+/*  summary on the screen.                   */
+/*                                           */
+/*  Set PROBES to 0 before including this to */
+/*  compile every probe out.                 */
+/*********************************************/
+
+#ifndef PROBES_H
+#define PROBES_H
+
+#include <FEHLCD.h>
+#include <FEHSD.h>
+#include <stdint.h>
+
+#include "probes_format.h"
+
+#ifdef HOST_BUILD
+#include <chrono>
+#endif
+
+#ifndef PROBES
+#define PROBES 1
+#endif
+
+/************************************************/
+// Definitions
+#ifdef HOST_BUILD
+#define PROBE_TICKS_PER_SEC 1000000000UL // Nanoseconds
+#else
+#define PROBE_TICKS_PER_SEC 88000000UL // Proteus core clock
+#endif
+
+#define PROBE_CALIBRATION_PASSES 64 // Empty scopes timed by probe_start()
+
+// Cortex-M4 debug registers for the cycle counter
+#define PROBE_DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define PROBE_DEMCR_TRCENA (1UL << 24)
+#define PROBE_DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define PROBE_DWT_CTRL_CYCCNTENA 1UL
+#define PROBE_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+
+// Timed paths
+enum ProbeId {
+    PROBE_EMPTY = 0, // An empty scope, the cost of a probe itself
+    PROBE_PID_RIGHT, // RightPIDAdjustment()
+    PROBE_PID_LEFT, // LeftPIDAdjustment()
+    PROBE_PID_LOOP, // One pass of move_forward_PID() without its Sleep()
+    PROBE_ENCODER_STOP_LOOP, // The encoder stop loop, from the first count read to seeing the target
+    PROBE_RPS_HEADING, // Deciding which way RPS_correct_heading() pulses
+    PROBE_SHOW_RPS, // show_RPS_data()
+    PROBE_COUNT
+};
+
+// Names in files and on the screen (no spaces, the first 10 characters fit on the screen)
+const char *probeNames[PROBE_COUNT] = {
+    "empty", "pid_right", "pid_left", "pid_loop", "stop_loop", "rps_head", "show_rps"
+};
+
+/************************************************/
+// One probe (152 bytes)
+struct Probe {
+    uint32_t count;
+    uint32_t min, max;
+    uint64_t total;
+    uint32_t buckets[PROBE_BUCKETS];
+};
+
+/************************************************/
+// Global variables for the probes
+Probe probes[PROBE_COUNT];
+
+/*******************************************************
+ * @brief Current time in ticks. Wraps around, only differences mean anything.
+ */
+inline uint32_t probe_ticks() {
+#ifdef HOST_BUILD
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+    return PROBE_DWT_CYCCNT;
+#endif
+}
+
+/*******************************************************
+ * @brief Adds a time to a probe
+ *
+ * @param id ProbeId
+ * @param ticks Time in ticks
+ */
+inline void probe_record(int id, uint32_t ticks) {
+    Probe &probe = probes[id];
+
+    if ((probe.count == 0) || (ticks < probe.min)) {
+        probe.min = ticks;
+    }
+    if (ticks > probe.max) {
+        probe.max = ticks;
+    }
+    probe.count++;
+    probe.total += ticks;
+
+    // Bucket is the number of bits in the time (one CLZ instruction on the M4)
+    int bucket = ticks ? 32 - __builtin_clz(ticks) : 0;
+    probe.buckets[(bucket < PROBE_BUCKETS) ? bucket : PROBE_BUCKETS - 1]++;
+}
+
+/*******************************************************
+ * @brief Times the block it is declared in into a probe
+ */
+class ProbeScope {
+public:
+#if PROBES
+    ProbeScope(int id) : id(id), start(probe_ticks()) {}
+    ~ProbeScope() { probe_record(id, probe_ticks() - start); }
+
+private:
+    int id;
+    uint32_t start;
+#else
+    ProbeScope(int id) {}
+#endif
+};
+
+/*******************************************************
+ * @brief Starts the cycle counter, clears every probe and times the probes
+ * themselves into PROBE_EMPTY. Call once before the run.
+ */
+void probe_start() {
+#ifndef HOST_BUILD
+    PROBE_DEMCR |= PROBE_DEMCR_TRCENA;
+    PROBE_DWT_CYCCNT = 0;
+    PROBE_DWT_CTRL |= PROBE_DWT_CTRL_CYCCNTENA;
+#endif
+
+    for (int i = 0; i < PROBE_COUNT; i++) {
+        probes[i] = Probe();
+    }
+
+    for (int i = 0; i < PROBE_CALIBRATION_PASSES; i++) {
+        ProbeScope probe(PROBE_EMPTY);
+    }
+}
+
+/*******************************************************
+ * @brief Microseconds for a number of ticks
+ */
+inline float probe_us(uint64_t ticks) {
+    return ticks * (1e6f / PROBE_TICKS_PER_SEC);
+}
+
+/*******************************************************
+ * @brief Writes every probe's histogram to the SD card
+ *
+ * @param path File to write
+ */
+void probe_write(const char path[]) {
+    FEHFile *file = SD.FOpen(path, "w");
+
+    SD.FPrintf(file, "PROBES %d %lu\n", PROBES_VERSION, (unsigned long)PROBE_TICKS_PER_SEC);
+    for (int i = 0; i < PROBE_COUNT; i++) {
+        Probe &probe = probes[i];
+        unsigned long mean = probe.count ? (unsigned long)(probe.total / probe.count) : 0; // No 64 bit printf on the Proteus
+        SD.FPrintf(file, "P %s %lu %lu %lu %lu", probeNames[i], (unsigned long)probe.count, mean, (unsigned long)probe.min,
+                   (unsigned long)probe.max);
+        for (int b = 0; b < PROBE_BUCKETS; b++) {
+            SD.FPrintf(file, " %lu", (unsigned long)probe.buckets[b]);
+        }
+        SD.FPrintf(file, "\n");
+    }
+    SD.FPrintf(file, "END %d\n", PROBE_COUNT);
+
+    SD.FClose(file);
+}
+
+/*******************************************************
+ * @brief Shows the number of passes, mean and longest microseconds of every
+ * probe that ran, one row each starting at row
+ *
+ * @param row First row to write on
+ */
+void probe_write_lcd(int row) {
+    LCD.WriteRC("Probe", row, 0);
+    LCD.WriteRC("Runs", row, 11);
+    LCD.WriteRC("Mean", row, 17);
+    LCD.WriteRC("Max", row, 22);
+
+    for (int i = 0; i < PROBE_COUNT; i++) {
+        Probe &probe = probes[i];
+        if (probe.count == 0) {
+            continue;
+        }
+
+        row++;
+        LCD.WriteRC(probeNames[i], row, 0);
+        LCD.WriteRC((int)probe.count, row, 11);
+        LCD.WriteRC((int)probe_us(probe.total / probe.count), row, 17);
+        LCD.WriteRC((int)probe_us(probe.max), row, 22);
+    }
+}
+
+#endif
@@ -0,0 +1,33 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*          Timing probe file format         */
+/*                                           */
+/*  Shared by the probes on the robot        */
+/*  (probes.h) and the host report           */
+/*  (host/probe_report).                     */
+/*********************************************/
+
+#ifndef PROBES_FORMAT_H
+#define PROBES_FORMAT_H
+
+/************************************************/
+// Definitions
+#define PROBES_VERSION 1
+#define PROBES_FILE "probes.txt"
+
+// Histogram buckets per probe. Bucket b counts times of b bits: bucket 0 is 0 ticks,
+// bucket b is 2^(b-1) up to 2^b - 1 ticks. The last bucket also takes everything longer.
+#define PROBE_BUCKETS 32
+
+/*
+ * File layout (one probe per line):
+ *
+ *   PROBES <version> <ticks per second>
+ *   P <name> <count> <mean ticks> <min ticks> <max ticks> <bucket 0> ... <bucket PROBE_BUCKETS - 1>
+ *   ...
+ *   END <number of P lines>
+ *
+ * Names have no spaces. Ticks are CPU cycles on the robot and nanoseconds in the host build.
+ */
+
+#endif
@@ -0,0 +1,343 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*          Sensor trace recording           */
+/*                                           */
+/*  Records every sensor value the course    */
+/*  code reads and every motor/servo/Sleep   */
+/*  command it gives, so a failed run can    */
+/*  be replayed on a computer (host/replay). */
+/*                                           */
+/*  MUST be included after the FEH headers.  */
+/*  It swaps the FEH classes for versions    */
+/*  that record, so the course code itself   */
+/*  doesn't change.                          */
+/*********************************************/
+
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+#include "sensor_trace_format.h"
+
+#ifndef RECORD_SENSOR_TRACE
+#define RECORD_SENSOR_TRACE 0
+#endif
+
+// The host build has its own FEH stand-ins that replay traces, so nothing is wrapped there
+#if RECORD_SENSOR_TRACE && !defined(HOST_BUILD)
+
+#include <FEHSD.h>
+#include <cstring> // memcpy()
+
+/************************************************/
+// Definitions
+#define SENSOR_TRACE_CAPACITY 2304 // Records held in RAM before they are written out (36 KB)
+#define SENSOR_TRACE_FLUSH_MARGIN 0.02 // Seconds of a Sleep() kept free when writing records during it
+#define SENSOR_TRACE_MAX_COUNT 0xFFFFFFF0u // Longest run of identical reads stored in one record
+
+/************************************************/
+// Global variables for the recorder
+
+// Records waiting to be written. Indices are absolute, the slot is index % SENSOR_TRACE_CAPACITY
+SensorTraceRecord sensorTraceBuffer[SENSOR_TRACE_CAPACITY];
+unsigned long sensorTraceHead = 0; // Next record to fill
+unsigned long sensorTraceTail = 0; // Next record to write to the SD card
+
+// Index + 1 of the latest record for every input channel (0 if none yet)
+unsigned long sensorTraceLast[TRACE_FIRST_OUTPUT][SENSOR_TRACE_CHANNELS];
+
+unsigned int sensorTraceInputs = 0; // Number of inputs read since recording started
+bool sensorTraceRecording = false;
+bool sensorTraceOverflowed = false;
+FEHFile *sensorTraceFile = 0;
+
+/*******************************************************
+ * @brief Writes a value as the raw bits of a double so it isn't rounded
+ *
+ * @param file File to write to
+ * @param value Value to write
+ */
+void sensor_trace_write_bits(FEHFile *file, double value) {
+    unsigned int bits[2];
+    memcpy(bits, &value, sizeof(bits));
+
+    // High word first (little endian), written as two halves since %llx isn't always supported
+    SD.FPrintf(file, "%08x%08x\n", bits[1], bits[0]);
+}
+
+/*******************************************************
+ * @brief Adds a record to the buffer. Stops recording if the buffer is full, since a trace
+ * with a hole in it can't be replayed.
+ */
+inline void sensor_trace_append(int kind, int channel, unsigned int count, double value) {
+    if (sensorTraceHead - sensorTraceTail >= SENSOR_TRACE_CAPACITY) {
+        sensorTraceOverflowed = true;
+        sensorTraceRecording = false;
+        return;
+    }
+
+    SensorTraceRecord &record = sensorTraceBuffer[sensorTraceHead % SENSOR_TRACE_CAPACITY];
+    record.kind = kind;
+    record.channel = channel;
+    record.spare = 0;
+    record.count = count;
+    record.value = value;
+
+    sensorTraceHead++;
+}
+
+/*******************************************************
+ * @brief Records a value read by the course code. Repeated reads of the same value
+ * only bump the count of the last record for that channel.
+ *
+ * @param kind SensorTraceKind of the input
+ * @param channel Pin number, 0 if the input only has one
+ * @param value Value returned to the course code
+ */
+inline void sensor_trace_input(int kind, int channel, double value) {
+    if (!sensorTraceRecording) {
+        return;
+    }
+
+    sensorTraceInputs++;
+
+    // Merges with the latest record of this channel if it hasn't been written out yet
+    unsigned long last = sensorTraceLast[kind][channel];
+    if (last > sensorTraceTail) {
+        SensorTraceRecord &record = sensorTraceBuffer[(last - 1) % SENSOR_TRACE_CAPACITY];
+        if ((record.value == value) && (record.count < SENSOR_TRACE_MAX_COUNT)) {
+            record.count++;
+            return;
+        }
+    }
+
+    sensor_trace_append(kind, channel, 1, value);
+    sensorTraceLast[kind][channel] = sensorTraceHead;
+}
+
+/*******************************************************
+ * @brief Records a command given by the course code
+ *
+ * @param kind SensorTraceKind of the output
+ * @param channel Motor/servo port or encoder pin, 0 if there is only one
+ * @param value Value commanded
+ */
+inline void sensor_trace_output(int kind, int channel, double value) {
+    if (sensorTraceRecording) {
+        sensor_trace_append(kind, channel, sensorTraceInputs, value);
+    }
+}
+
+/*******************************************************
+ * @brief Writes buffered records to the SD card
+ *
+ * @param deadline TimeNow() value to stop writing at, negative to write everything
+ */
+void sensor_trace_write_records(double deadline) {
+    while ((sensorTraceTail < sensorTraceHead) && ((deadline < 0) || (TimeNow() < deadline))) {
+        SensorTraceRecord &record = sensorTraceBuffer[sensorTraceTail % SENSOR_TRACE_CAPACITY];
+        SD.FPrintf(sensorTraceFile, "%d %d %u ", record.kind, record.channel, record.count);
+        sensor_trace_write_bits(sensorTraceFile, record.value);
+        sensorTraceTail++;
+    }
+}
+
+/*******************************************************
+ * @brief Opens the trace file and starts recording
+ *
+ * @param courseNumber Course that is about to be run
+ */
+void sensor_trace_start(int courseNumber) {
+    sensorTraceFile = SD.FOpen(SENSOR_TRACE_FILE, "w");
+
+    sensorTraceHead = 0;
+    sensorTraceTail = 0;
+    sensorTraceInputs = 0;
+    sensorTraceOverflowed = false;
+    memset(sensorTraceLast, 0, sizeof(sensorTraceLast));
+
+    SD.FPrintf(sensorTraceFile, "SENSOR_TRACE %d\n", SENSOR_TRACE_VERSION);
+    SD.FPrintf(sensorTraceFile, "COURSE %d\n", courseNumber);
+
+    sensorTraceRecording = true;
+}
+
+/*******************************************************
+ * @brief Saves a global the course depends on so the replay can restore it
+ *
+ * @param name Name of the global (must match the table in host/replay.cpp)
+ * @param value Current value
+ */
+void sensor_trace_state(const char name[], double value) {
+    SD.FPrintf(sensorTraceFile, "STATE %s ", name);
+    sensor_trace_write_bits(sensorTraceFile, value);
+}
+
+/*******************************************************
+ * @brief Stops recording and writes the rest of the trace to the SD card
+ */
+void sensor_trace_stop() {
+    sensorTraceRecording = false;
+
+    sensor_trace_write_records(-1);
+    SD.FPrintf(sensorTraceFile, "END %lu %d\n", sensorTraceHead, sensorTraceOverflowed ? 1 : 0);
+    SD.FClose(sensorTraceFile);
+}
+
+/*******************************************************
+ * @brief Sleeps, using the time to write buffered records to the SD card
+ *
+ * @param seconds Time to sleep for
+ */
+void sensor_trace_sleep(double seconds) {
+    sensor_trace_output(TRACE_SLEEP, 0, seconds);
+
+    double deadline = TimeNow() + seconds;
+    if (sensorTraceRecording) {
+        sensor_trace_write_records(deadline - SENSOR_TRACE_FLUSH_MARGIN);
+    }
+
+    double remaining = deadline - TimeNow();
+    if (remaining > 0) {
+        Sleep(remaining);
+    }
+}
+
+/************************************************/
+// Recording versions of the FEH classes
+
+class TracedDigitalEncoder : public DigitalEncoder {
+public:
+    TracedDigitalEncoder(FEHIO::FEHIOPin pin) : DigitalEncoder(pin), tracePin(pin) {}
+
+    int Counts() {
+        int counts = DigitalEncoder::Counts();
+        sensor_trace_input(TRACE_ENCODER_COUNTS, tracePin, counts);
+        return counts;
+    }
+
+    void ResetCounts() {
+        sensor_trace_output(TRACE_ENCODER_RESET, tracePin, 0);
+        DigitalEncoder::ResetCounts();
+    }
+
+private:
+    int tracePin;
+};
+
+class TracedAnalogInputPin : public AnalogInputPin {
+public:
+    TracedAnalogInputPin(FEHIO::FEHIOPin pin) : AnalogInputPin(pin), tracePin(pin) {}
+
+    float Value() {
+        float value = AnalogInputPin::Value();
+        sensor_trace_input(TRACE_ANALOG_VALUE, tracePin, value);
+        return value;
+    }
+
+private:
+    int tracePin;
+};
+
+class TracedFEHMotor : public FEHMotor {
+public:
+    TracedFEHMotor(FEHMotor::FEHMotorPort port, float maxVoltage) : FEHMotor(port, maxVoltage), tracePort(port) {}
+
+    void SetPercent(float percent) {
+        sensor_trace_output(TRACE_MOTOR_PERCENT, tracePort, percent);
+        FEHMotor::SetPercent(percent);
+    }
+
+    void Stop() {
+        sensor_trace_output(TRACE_MOTOR_STOP, tracePort, 0);
+        FEHMotor::Stop();
+    }
+
+private:
+    int tracePort;
+};
+
+class TracedFEHServo : public FEHServo {
+public:
+    TracedFEHServo(FEHServo::FEHServoPort port) : FEHServo(port), tracePort(port) {}
+
+    void SetDegree(float degree) {
+        sensor_trace_output(TRACE_SERVO_DEGREE, tracePort, degree);
+        FEHServo::SetDegree(degree);
+    }
+
+private:
+    int tracePort;
+};
+
+class TracedRPS {
+public:
+    void InitializeTouchMenu() { RPS.InitializeTouchMenu(); }
+
+    float Heading() { return trace(TRACE_RPS_HEADING, RPS.Heading()); }
+    float X() { return trace(TRACE_RPS_X, RPS.X()); }
+    float Y() { return trace(TRACE_RPS_Y, RPS.Y()); }
+    int Time() { return trace(TRACE_RPS_TIME, RPS.Time()); }
+    char CurrentRegionLetter() { return trace(TRACE_RPS_REGION, RPS.CurrentRegionLetter()); }
+    int GetIceCream() { return trace(TRACE_RPS_ICE_CREAM, RPS.GetIceCream()); }
+
+private:
+    template <typename T> T trace(int kind, T value) {
+        sensor_trace_input(kind, 0, value);
+        return value;
+    }
+};
+
+class TracedLCD {
+public:
+    void Clear() { LCD.Clear(); }
+    void ClearBuffer() { LCD.ClearBuffer(); }
+    void SetBackgroundColor(unsigned int color) { LCD.SetBackgroundColor(color); }
+    void SetFontColor(unsigned int color) { LCD.SetFontColor(color); }
+    void FillRectangle(int x, int y, int width, int height) { LCD.FillRectangle(x, y, width, height); }
+    void DrawHorizontalLine(int y, int x1, int x2) { LCD.DrawHorizontalLine(y, x1, x2); }
+    void DrawVerticalLine(int x, int y1, int y2) { LCD.DrawVerticalLine(x, y1, y2); }
+    template <typename T> void Write(T value) { LCD.Write(value); }
+    template <typename T> void WriteLine(T value) { LCD.WriteLine(value); }
+    template <typename T> void WriteRC(T value, int row, int col) { LCD.WriteRC(value, row, col); }
+
+    bool Touch(int *x, int *y) {
+        bool pressed = LCD.Touch(x, y);
+        sensor_trace_input(TRACE_LCD_TOUCH, 0, sensor_trace_encode_touch(pressed, *x, *y));
+        return pressed;
+    }
+};
+
+TracedRPS traced_RPS;
+TracedLCD traced_LCD;
+
+inline double traced_TimeNow() {
+    double time = TimeNow();
+    sensor_trace_input(TRACE_TIME_NOW, 0, time);
+    return time;
+}
+
+inline void traced_Sleep(int msec) { sensor_trace_sleep(msec / 1000.0); }
+inline void traced_Sleep(float seconds) { sensor_trace_sleep(seconds); }
+inline void traced_Sleep(double seconds) { sensor_trace_sleep(seconds); }
+
+/************************************************/
+// Everything after this point uses the recording versions
+#define DigitalEncoder TracedDigitalEncoder
+#define AnalogInputPin TracedAnalogInputPin
+#define FEHMotor TracedFEHMotor
+#define FEHServo TracedFEHServo
+#define RPS traced_RPS
+#define LCD traced_LCD
+#define TimeNow() traced_TimeNow() // Function-like so (TimeNow)() still reaches the real one
+#define Sleep traced_Sleep
+
+#else
+
+// Recording is off (or this is the host build), so these do nothing
+inline void sensor_trace_start(int courseNumber) {}
+inline void sensor_trace_state(const char name[], double value) {}
+inline void sensor_trace_stop() {}
+
+#endif
+
+#endif
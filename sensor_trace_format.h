@@ -0,0 +1,85 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*         Sensor trace file format          */
+/*                                           */
+/*  Shared by the recorder on the robot      */
+/*  (sensor_trace.h) and the host replay     */
+/*  harness (host/replay.cpp).               */
+/*********************************************/
+
+#ifndef SENSOR_TRACE_FORMAT_H
+#define SENSOR_TRACE_FORMAT_H
+
+/************************************************/
+// Definitions
+#define SENSOR_TRACE_VERSION 1
+#define SENSOR_TRACE_FILE "trace.txt" // File written to the SD card
+#define SENSOR_TRACE_CHANNELS 32 // Enough for every FEHIO pin (P0_0 -> P3_7)
+
+/*
+ * File layout (one entry per line, values written as the raw bits of a double in hex so nothing is lost):
+ *
+ *   SENSOR_TRACE <version>
+ *   COURSE <course number>
+ *   STATE <name> <value bits>  <- globals the course depends on (RPS references etc.)
+ *   <kind> <channel> <count> <value bits>
+ *   ...
+ *   END <number of records> <1 if the buffer overflowed, 0 if not>
+ *
+ * Inputs are run-length encoded per channel: count is how many reads in a row returned value.
+ * Outputs store in count how many inputs had been read when the command was given, so a replay
+ * can tell if a command happened at a different point than it did on the robot.
+ */
+
+/************************************************/
+// Record kinds
+enum SensorTraceKind {
+    // Inputs (values the course code reads)
+    TRACE_TIME_NOW = 0,
+    TRACE_ENCODER_COUNTS = 1,
+    TRACE_ANALOG_VALUE = 2,
+    TRACE_RPS_HEADING = 3,
+    TRACE_RPS_X = 4,
+    TRACE_RPS_Y = 5,
+    TRACE_RPS_TIME = 6,
+    TRACE_RPS_REGION = 7,
+    TRACE_RPS_ICE_CREAM = 8,
+    TRACE_LCD_TOUCH = 9, // x + 320 * y when pressed, -1 when not
+
+    // Outputs (decisions the course code makes)
+    TRACE_MOTOR_PERCENT = 10,
+    TRACE_MOTOR_STOP = 11,
+    TRACE_SERVO_DEGREE = 12,
+    TRACE_SLEEP = 13,
+    TRACE_ENCODER_RESET = 14,
+
+    TRACE_KIND_COUNT = 15
+};
+
+// First kind that is an output
+#define TRACE_FIRST_OUTPUT TRACE_MOTOR_PERCENT
+
+/************************************************/
+// A single trace record (16 bytes). Values are doubles since TimeNow() has to replay exactly,
+// the PID speed math divides by differences between its values.
+struct SensorTraceRecord {
+    unsigned char kind; // SensorTraceKind
+    unsigned char channel; // Pin/port number, 0 for sources with one channel
+    unsigned short spare;
+    unsigned int count; // Inputs: consecutive reads. Outputs: inputs read before the command
+    double value;
+};
+
+/*******************************************************
+ * @brief Packs a touch reading into a single trace value
+ *
+ * @param pressed true if the screen was touched
+ * @param x x-coord of the touch
+ * @param y y-coord of the touch
+ * @return double Encoded touch
+ */
+inline double sensor_trace_encode_touch(bool pressed, int x, int y) {
+    return pressed ? (double)(x + 320 * y) : -1.0;
+}
+
+#endif
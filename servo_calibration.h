@@ -0,0 +1,100 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*            Servo calibration file         */
+/*                                           */
+/*  Keeps each arm servo's min/max pulse     */
+/*  widths and how fast its horn turns on    */
+/*  the SD card, so the CALIBRATE_SERVOS     */
+/*  sweep only has to be run when a servo is */
+/*  changed and initiate_servos() picks the  */
+/*  numbers up on every run. Without a file  */
+/*  (or with a bad line) the #define values  */
+/*  in main.cpp are used.                    */
+/*                                           */
+/*  File layout:                             */
+/*    SERVOS <version>                       */
+/*    BASE <min> <max> <degrees/second>      */
+/*    ON_ARM <min> <max> <degrees/second>    */
+/*    END                                    */
+/*********************************************/
+
+#ifndef SERVO_CALIBRATION_H
+#define SERVO_CALIBRATION_H
+
+#include <FEHSD.h>
+
+/************************************************/
+// Definitions
+#define SERVO_CALIBRATION_VERSION 1
+#define SERVO_CALIBRATION_FILE "servos.txt"
+
+#define SERVO_PULSE_LOWEST 500 // Shortest pulse the sweep sends (microseconds)
+#define SERVO_PULSE_HIGHEST 2500 // Longest pulse the sweep sends
+
+/*******************************************************
+ * @brief One servo's calibration
+ */
+struct ServoCalibration {
+    int minPulse, maxPulse; // SetMin()/SetMax() values (microseconds)
+    float speed; // Degrees per second the horn turns, timed over its full travel
+};
+
+/*******************************************************
+ * @brief Whether a calibration could be real
+ */
+inline bool servo_calibration_valid(const ServoCalibration &calibration) {
+    return (calibration.minPulse >= SERVO_PULSE_LOWEST) && (calibration.maxPulse <= SERVO_PULSE_HIGHEST) &&
+           (calibration.minPulse < calibration.maxPulse) && (calibration.speed > 0);
+}
+
+/*******************************************************
+ * @brief Reads the calibration file. A servo whose line is missing or bad
+ * keeps the values it came in with.
+ *
+ * @param path File to read
+ * @return bool true if both servos were read
+ */
+bool servo_calibration_load(const char path[], ServoCalibration &base, ServoCalibration &onArm) {
+    FEHFile *file = SD.FOpen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    int version = 0;
+    ServoCalibration readBase, readOnArm;
+    bool haveBase = false, haveOnArm = false;
+
+    if ((SD.FScanf(file, "SERVOS %d", &version) == 1) && (version == SERVO_CALIBRATION_VERSION)) {
+        haveBase = (SD.FScanf(file, " BASE %d %d %f", &readBase.minPulse, &readBase.maxPulse, &readBase.speed) == 3) &&
+                   servo_calibration_valid(readBase);
+        haveOnArm = (SD.FScanf(file, " ON_ARM %d %d %f", &readOnArm.minPulse, &readOnArm.maxPulse, &readOnArm.speed) == 3) &&
+                    servo_calibration_valid(readOnArm);
+    }
+    SD.FClose(file);
+
+    if (haveBase) {
+        base = readBase;
+    }
+    if (haveOnArm) {
+        onArm = readOnArm;
+    }
+    return haveBase && haveOnArm;
+}
+
+/*******************************************************
+ * @brief Writes the calibration file
+ *
+ * @param path File to write
+ */
+void servo_calibration_save(const char path[], const ServoCalibration &base, const ServoCalibration &onArm) {
+    FEHFile *file = SD.FOpen(path, "w");
+
+    SD.FPrintf(file, "SERVOS %d\n", SERVO_CALIBRATION_VERSION);
+    SD.FPrintf(file, "BASE %d %d %.1f\n", base.minPulse, base.maxPulse, base.speed);
+    SD.FPrintf(file, "ON_ARM %d %d %.1f\n", onArm.minPulse, onArm.maxPulse, onArm.speed);
+    SD.FPrintf(file, "END\n");
+
+    SD.FClose(file);
+}
+
+#endif
@@ -0,0 +1,211 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*         Cooperative task executor         */
+/*                                           */
+/*  Lets several behaviors (a drive, an arm  */
+/*  sequence, a screen update) take turns    */
+/*  instead of each one blocking until it is */
+/*  done. A task is a class with a step()    */
+/*  that runs until it has to wait, then     */
+/*  returns. The TASK_ macros keep its place */
+/*  in a switch on __LINE__ (protothreads),  */
+/*  so a task needs no stack of its own and  */
+/*  nothing is allocated. Locals don't       */
+/*  survive a wait, keep them as members.    */
+/*                                           */
+/*  TaskExecutor::run() steps every task in  */
+/*  turn until the main one is done, and     */
+/*  Sleep()s when they are all waiting for a */
+/*  time. A prioritized task is also stepped */
+/*  after each of the others, so it never    */
+/*  waits behind more than one of them.      */
+/*                                           */
+/*  MUST be included after telemetry.h.      */
+/*********************************************/
+
+#ifndef TASK_H
+#define TASK_H
+
+/************************************************/
+// Definitions
+#define TASK_CAPACITY 8 // Tasks one executor runs at once (including the main one)
+
+/************************************************/
+// Global variables for the tasks
+double taskNow = 0; // Time of the current pass of the executor. Read once per pass.
+
+/*******************************************************
+ * @brief A behavior that runs a bit at a time. Subclasses put their body
+ * in step() between TASK_BEGIN() and TASK_END().
+ */
+class Task {
+public:
+    Task() : resume(0), wake(0), done(false) {}
+    virtual ~Task() {}
+
+    // Runs until the task waits or finishes
+    virtual void step() = 0;
+
+    // Starts the task over from the top
+    void restart() {
+        resume = 0;
+        wake = 0;
+        done = false;
+    }
+
+    int resume; // Line to carry on from, 0 to start
+    double wake; // Not stepped again until taskNow reaches this
+    bool done;
+};
+
+/************************************************/
+// Task body macros. Only use them directly in step(), not inside another switch.
+
+#define TASK_BEGIN() \
+    switch (resume) { \
+    case 0:
+
+#define TASK_END() \
+    } \
+    done = true
+
+// Lets the other tasks run, then carries on
+#define TASK_YIELD() \
+    do { \
+        resume = __LINE__; \
+        return; \
+    case __LINE__:; \
+    } while (0)
+
+// Checks cond on every pass and carries on once it is true
+#define TASK_WAIT_UNTIL(cond) \
+    do { \
+        resume = __LINE__; \
+    case __LINE__: \
+        if (!(cond)) { \
+            return; \
+        } \
+    } while (0)
+
+// Carries on once seconds have gone by. Measured from the pass it was called in,
+// so back to back sleeps add up exactly like Sleep() calls would.
+#define TASK_SLEEP(seconds) \
+    do { \
+        wake = taskNow + (seconds); \
+        resume = __LINE__; \
+        return; \
+    case __LINE__:; \
+    } while (0)
+
+// Runs another task (a member of this one) to the end as part of this one
+#define TASK_AWAIT(child) \
+    do { \
+        (child).restart(); \
+        resume = __LINE__; \
+    case __LINE__: \
+        (child).step(); \
+        if (!(child).done) { \
+            wake = (child).wake; \
+            return; \
+        } \
+    } while (0)
+
+/*******************************************************
+ * @brief Runs tasks side by side on one thread
+ */
+class TaskExecutor {
+public:
+    TaskExecutor() : count(0), priority(0) {}
+
+    /*******************************************************
+     * @brief Adds a task that runs alongside the main one until it is done.
+     * Background tasks that never finish are dropped when run() returns.
+     *
+     * @return bool false if every slot is taken
+     */
+    bool spawn(Task &task) {
+        if (count >= TASK_CAPACITY - 1) {
+            return false;
+        }
+        task.restart();
+        tasks[count++] = &task;
+        return true;
+    }
+
+    /*******************************************************
+     * @brief Steps a task (the main one or a spawned one) again after every
+     * other task's step, for one that has to notice something quickly, like
+     * a drive waiting on its counts. Cleared when run() returns.
+     */
+    void prioritize(Task &task) {
+        priority = &task;
+    }
+
+    /*******************************************************
+     * @brief Steps the main task and every spawned one until the main one is done
+     *
+     * @param main Task that decides when the run is over
+     * @param line Line it was called from (filled in automatically, used by the cost report)
+     */
+    void run(Task &main, int line = TIMELINE_CALL_SITE) {
+        main.restart();
+        tasks[count++] = &main;
+
+        while (!main.done) {
+            // Decides what runs, so it goes through the sensor trace (not timeline_time())
+            taskNow = TimeNow();
+
+            // Steps every task whose time has come, and finds the next wake up of the rest
+            bool ready = false;
+            double nextWake = 0;
+            for (int i = 0; i < count; i++) {
+                Task &task = *tasks[i];
+                if (task.done) {
+                    continue;
+                }
+
+                if (task.wake <= taskNow) {
+                    task.step();
+                    if (&task != priority) {
+                        step_priority();
+                    }
+                }
+
+                if (!task.done) {
+                    if (task.wake <= taskNow) {
+                        ready = true;
+                    } else if (!nextWake || (task.wake < nextWake)) {
+                        nextWake = task.wake;
+                    }
+                }
+            }
+
+            // Everybody is waiting for a time, so sleep until the first one
+            if (!ready && !main.done && nextWake) {
+                double seconds = nextWake - TimeNow();
+                if (seconds > 0) {
+                    Sleep(seconds, line);
+                }
+            }
+        }
+
+        count = 0;
+        priority = 0;
+    }
+
+private:
+    Task *tasks[TASK_CAPACITY];
+    int count;
+    Task *priority; // Stepped after every other task's step, 0 for none
+
+    /*******************************************************
+     * @brief Steps the prioritized task if it is ready
+     */
+    void step_priority() {
+        if (priority && !priority->done && (priority->wake <= taskNow)) {
+            priority->step();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,256 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*            Telemetry recorder             */
+/*                                           */
+/*  Keeps the latest control loop samples    */
+/*  (encoder counts, motor commands, RPS     */
+/*  pose, PID terms, stage) in a fixed ring  */
+/*  buffer of binary samples. A sample is a  */
+/*  copy of values the code already has, so  */
+/*  taking one in a loop costs almost        */
+/*  nothing. The buffer goes to the SD card  */
+/*  in one burst with telemetry_write()      */
+/*  after the run, or when the screen is     */
+/*  touched during a Sleep() while the touch */
+/*  dump is armed (telemetry_arm_touch(),    */
+/*  around run_course(), to save a run that  */
+/*  went wrong). host/telemetry2csv          */
+/*  turns the file into a spreadsheet.       */
+/*                                           */
+/*  MUST be included after timeline.h and    */
+/*  control_math.h. Define TELEMETRY_LEFT_   */
+/*  and TELEMETRY_RIGHT_ ENCODER/MOTOR       */
+/*  first.                                   */
+/*********************************************/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <FEHSD.h>
+#include <cstring> // memcpy()
+
+#include "telemetry_format.h"
+
+/************************************************/
+// Definitions
+#define TELEMETRY_CAPACITY 768 // Samples kept in RAM (24 KB)
+#define TELEMETRY_TOUCH_MIN_SLEEP 0.1 // Shortest Sleep() in seconds that checks the screen for a touch
+
+/************************************************/
+// Global variables for the recorder
+TelemetrySample telemetrySamples[TELEMETRY_CAPACITY];
+unsigned long telemetryCount = 0; // Samples taken, the latest is at (telemetryCount - 1) % TELEMETRY_CAPACITY
+
+// Latest values, copied into every sample
+TelemetrySample telemetryLatest;
+
+bool telemetryTouchArmed = false; // A touch during a Sleep() saves the telemetry, only while the course runs
+bool telemetryTouched = true; // Screen was held at the last check (it is at start up, from the menus)
+
+/*******************************************************
+ * @brief Fixed point for a sample field, clamped so it doesn't wrap
+ */
+inline int16_t telemetry_fixed(float value, float scale) {
+    float scaled = value * scale;
+    if (scaled > 32767) {
+        return 32767;
+    } else if (scaled < -32768) {
+        return -32768;
+    }
+    return (int16_t)scaled;
+}
+
+/*******************************************************
+ * @brief Adds a sample of the latest values to the buffer, overwriting the oldest one if it is full
+ *
+ * @param source TelemetrySource of the sample
+ */
+inline void telemetry_sample(int source) {
+    TelemetrySample &sample = telemetrySamples[telemetryCount % TELEMETRY_CAPACITY];
+    sample = telemetryLatest;
+    sample.time = timeline_time();
+    sample.stage = timelineStageIndex;
+    sample.source = source;
+    telemetryCount++;
+}
+
+/*******************************************************
+ * @brief Adds a sample with the terms of the last PID pass
+ *
+ * @param left Left wheel PID state
+ * @param right Right wheel PID state
+ */
+template <typename T>
+void telemetry_sample_pid(const PIDWheel<T> &left, const PIDWheel<T> &right) {
+    const PIDWheel<T> *wheels[2] = { &left, &right };
+    for (int i = 0; i < 2; i++) {
+        telemetryLatest.pid[i][0] = telemetry_fixed((float)wheels[i]->pTerm, 100);
+        telemetryLatest.pid[i][1] = telemetry_fixed((float)wheels[i]->iTerm, 100);
+        telemetryLatest.pid[i][2] = telemetry_fixed((float)wheels[i]->dTerm, 100);
+    }
+    telemetry_sample(TELEMETRY_PID);
+}
+
+/*******************************************************
+ * @brief Writes the samples in the buffer to the SD card, oldest first
+ *
+ * @param path File to write
+ */
+void telemetry_write(const char path[]) {
+    FEHFile *file = SD.FOpen(path, "w");
+
+    unsigned long first = (telemetryCount > TELEMETRY_CAPACITY) ? telemetryCount - TELEMETRY_CAPACITY : 0;
+
+    SD.FPrintf(file, "TELEMETRY %d\n", TELEMETRY_VERSION);
+    for (unsigned long i = first; i < telemetryCount; i++) {
+        uint32_t words[TELEMETRY_WORDS];
+        memcpy(words, &telemetrySamples[i % TELEMETRY_CAPACITY], sizeof(words));
+        SD.FPrintf(file, "S %08lx %08lx %08lx %08lx %08lx %08lx %08lx %08lx\n", (unsigned long)words[0], (unsigned long)words[1],
+                   (unsigned long)words[2], (unsigned long)words[3], (unsigned long)words[4], (unsigned long)words[5],
+                   (unsigned long)words[6], (unsigned long)words[7]);
+    }
+    SD.FPrintf(file, "END %lu %lu\n", telemetryCount - first, telemetryCount);
+
+    SD.FClose(file);
+}
+
+/************************************************/
+// Versions of the FEH classes that keep the latest values for the samples
+
+class TelemetryDigitalEncoder : public DigitalEncoder {
+public:
+    TelemetryDigitalEncoder(FEHIO::FEHIOPin pin) : DigitalEncoder(pin), side(telemetry_side(pin)) {}
+
+    int Counts() {
+        int counts = DigitalEncoder::Counts();
+        if (side >= 0) {
+            telemetryLatest.counts[side] = counts;
+        }
+        return counts;
+    }
+
+    void ResetCounts() {
+        DigitalEncoder::ResetCounts();
+        if (side >= 0) {
+            telemetryLatest.counts[side] = 0;
+        }
+    }
+
+private:
+    int side; // 0 left, 1 right, -1 if it isn't a drive encoder
+
+    static int telemetry_side(int pin) {
+        return (pin == TELEMETRY_LEFT_ENCODER) ? 0 : ((pin == TELEMETRY_RIGHT_ENCODER) ? 1 : -1);
+    }
+};
+
+class TelemetryFEHMotor : public FEHMotor {
+public:
+    TelemetryFEHMotor(FEHMotor::FEHMotorPort port, float maxVoltage) : FEHMotor(port, maxVoltage) {
+        side = (port == TELEMETRY_LEFT_MOTOR) ? 0 : ((port == TELEMETRY_RIGHT_MOTOR) ? 1 : -1);
+    }
+
+    void SetPercent(float percent) {
+        FEHMotor::SetPercent(percent);
+        if (side >= 0) {
+            telemetryLatest.percent[side] = telemetry_fixed(percent, 100);
+        }
+    }
+
+    void Stop() {
+        FEHMotor::Stop();
+        if (side >= 0) {
+            telemetryLatest.percent[side] = 0;
+        }
+    }
+
+private:
+    int side; // 0 left, 1 right, -1 if it isn't a drive motor
+};
+
+class TelemetryRPS {
+public:
+    void InitializeTouchMenu() { RPS.InitializeTouchMenu(); }
+
+    float Heading() {
+        float heading = RPS.Heading();
+        telemetryLatest.rpsHeading = telemetry_fixed(heading, 10);
+        return heading;
+    }
+
+    float X() {
+        float x = RPS.X();
+        telemetryLatest.rpsX = telemetry_fixed(x, 100);
+        return x;
+    }
+
+    float Y() {
+        float y = RPS.Y();
+        telemetryLatest.rpsY = telemetry_fixed(y, 100);
+        return y;
+    }
+
+    int Time() { return RPS.Time(); }
+    char CurrentRegionLetter() { return RPS.CurrentRegionLetter(); }
+    int GetIceCream() { return RPS.GetIceCream(); }
+};
+
+TelemetryRPS telemetry_RPS;
+
+/*******************************************************
+ * @brief Turns the touch dump on or off. The setup before the run (menus,
+ * RPS heading presses) touches the screen on purpose, so it is only armed
+ * while the course runs. A touch already down when it is armed doesn't count.
+ */
+inline void telemetry_arm_touch(bool armed) {
+    telemetryTouchArmed = armed;
+    telemetryTouched = true;
+}
+
+/*******************************************************
+ * @brief Checks the screen at the start of a long enough Sleep() and saves the
+ * telemetry when it has just been touched. The sleep that follows keeps the
+ * caller's length, since Sleep() is recorded for replays and the host
+ * benchmarks find loops by it. The touch read (about 0.2 ms) adds to the pause.
+ *
+ * @param seconds Length of the Sleep() about to happen
+ */
+inline void telemetry_check_touch(double seconds) {
+    if (!telemetryTouchArmed || (seconds < TELEMETRY_TOUCH_MIN_SLEEP)) {
+        return;
+    }
+
+    int x, y;
+    bool touched = LCD.Touch(&x, &y);
+    if (touched && !telemetryTouched) {
+        telemetry_write(TELEMETRY_FILE);
+    }
+    telemetryTouched = touched;
+}
+
+inline void telemetry_Sleep(int msec, int line = TIMELINE_CALL_SITE) {
+    telemetry_check_touch(msec / 1000.0);
+    Sleep(msec, line);
+}
+
+inline void telemetry_Sleep(float seconds, int line = TIMELINE_CALL_SITE) {
+    telemetry_check_touch(seconds);
+    Sleep(seconds, line);
+}
+
+inline void telemetry_Sleep(double seconds, int line = TIMELINE_CALL_SITE) {
+    telemetry_check_touch(seconds);
+    Sleep(seconds, line);
+}
+
+// Replaces the earlier versions with versions that wrap them
+#undef DigitalEncoder
+#undef FEHMotor
+#undef RPS
+#undef Sleep
+#define DigitalEncoder TelemetryDigitalEncoder
+#define FEHMotor TelemetryFEHMotor
+#define RPS telemetry_RPS
+#define Sleep telemetry_Sleep
+
+#endif
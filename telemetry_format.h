@@ -0,0 +1,56 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*          Telemetry file format            */
+/*                                           */
+/*  Shared by the recorder on the robot      */
+/*  (telemetry.h) and the host converter     */
+/*  (host/telemetry2csv).                    */
+/*********************************************/
+
+#ifndef TELEMETRY_FORMAT_H
+#define TELEMETRY_FORMAT_H
+
+#include <stdint.h>
+
+/************************************************/
+// Definitions
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_FILE "telemetry.txt"
+#define TELEMETRY_WORDS 8 // 32 bit words in a sample
+
+// What took a sample
+enum TelemetrySource {
+    TELEMETRY_PID = 0, // A pass of move_forward_PID()
+    TELEMETRY_MOVE_START = 1, // An encoder move or turn set its motors
+    TELEMETRY_MOVE_STOP = 2, // An encoder move or turn reached its target
+    TELEMETRY_RPS = 3, // A pass of an RPS correction
+    TELEMETRY_SOURCES = 4
+};
+
+/************************************************/
+// One sample (32 bytes). Fixed point where a float isn't needed.
+struct TelemetrySample {
+    float time; // Seconds from TimeNow()
+    int16_t counts[2]; // Left, right encoder counts last read
+    int16_t percent[2]; // Left, right motor percent last commanded, in hundredths
+    int16_t rpsX, rpsY; // Last RPS position read, in hundredths of an inch (-100 is no signal)
+    int16_t rpsHeading; // Last RPS heading read, in tenths of a degree (-10 is no signal)
+    uint8_t stage; // Index of the timeline stage (0 outside any stage)
+    uint8_t source; // TelemetrySource
+    int16_t pid[2][3]; // Left, right P, I and D terms of the last PID pass, in hundredths of a percent
+};
+
+static_assert(sizeof(TelemetrySample) == TELEMETRY_WORDS * 4, "TelemetrySample must stay 32 bytes with no padding");
+
+/*
+ * File layout (one sample per line, oldest first):
+ *
+ *   TELEMETRY <version>
+ *   S <word 0> ... <word 7>  <- the sample's bytes as little endian 32 bit words in hex
+ *   ...
+ *   END <samples in the file> <samples recorded in the run>
+ *
+ * The buffer only holds the latest samples, so the second END number can be larger than the first.
+ */
+
+#endif
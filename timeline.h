@@ -0,0 +1,398 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*              Run timeline                 */
+/*                                           */
+/*  Records begin/end events for motion      */
+/*  functions, corrections, Sleep() and      */
+/*  course stages, plus servo commands.      */
+/*  timeline_write() saves them to the SD    */
+/*  card, host/timeline2json turns the file  */
+/*  into a Chrome trace (chrome://tracing,   */
+/*  ui.perfetto.dev).                        */
+/*                                           */
+/*  The same hooks charge every second of    */
+/*  the run to one cost category, per stage  */
+/*  and per call site line. timeline_write_  */
+/*  costs() saves them, host/cost_report     */
+/*  prints the breakdown.                    */
+/*                                           */
+/*  MUST be included after sensor_trace.h.   */
+/*********************************************/
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <FEHSD.h>
+#include <cstring> // strcmp()
+
+#include "timeline_format.h"
+
+#ifdef HOST_BUILD
+#include "feh_host.h"
+#endif
+
+/************************************************/
+// Definitions
+#define TIMELINE_CAPACITY 1024 // Events kept in RAM (16 KB)
+#define TIMELINE_COST_SITES 512 // (line, stage, category) totals kept in RAM (4 KB)
+#define TIMELINE_COST_DEPTH 16 // Deepest nesting of timed calls
+#define TIMELINE_STAGES 16
+
+// Line the function was called from. Used as a default argument so callers don't have to pass it.
+#define TIMELINE_CALL_SITE __builtin_LINE()
+
+/************************************************/
+// A single event (16 bytes)
+struct TimelineEvent {
+    const char *name; // Must be a string literal, only the pointer is kept
+    float time; // Seconds from TimeNow()
+    float arg; // Distance, degrees, seconds... whatever the event is about
+    char phase;
+    unsigned char track;
+};
+
+/************************************************/
+// Global variables for the timeline
+TimelineEvent timelineEvents[TIMELINE_CAPACITY];
+int timelineCount = 0;
+bool timelineOverflowed = false;
+const char *timelineStage = 0; // Stage that is currently open, 0 if none
+
+/************************************************/
+// Global variables for cost attribution
+
+// Time charged to one category at one call site in one stage (8 bytes)
+struct TimelineCostSite {
+    float seconds;
+    short line;
+    unsigned char stage;
+    unsigned char cost;
+};
+
+// A timed call that hasn't returned yet
+struct TimelineCostFrame {
+    unsigned char cost; // Category its time is charged to
+    short line; // Call site in the outermost timed call
+};
+
+TimelineCostSite timelineCostSites[TIMELINE_COST_SITES];
+int timelineCostSiteCount = 0;
+bool timelineCostOverflowed = false;
+TimelineCostFrame timelineCostStack[TIMELINE_COST_DEPTH];
+int timelineCostDepth = 0;
+double timelineCostLastTime = -1; // When time was last charged, -1 before the first call
+const char *timelineStageNames[TIMELINE_STAGES] = { "(none)" };
+int timelineStageCount = 1;
+int timelineStageIndex = 0; // Index of the open stage in timelineStageNames
+bool timelineServoPending = false; // true if a servo was commanded and nothing has waited for it yet
+
+/*******************************************************
+ * @brief Current time for instrumentation (events, costs, telemetry). Never
+ * recorded: on the Proteus the parentheses skip the sensor trace's TimeNow()
+ * wrapper, and on the host it is the hardware's Clock(), so a replay doesn't
+ * spend trace input on reads the robot never recorded. Nothing the course
+ * decides may depend on it.
+ */
+inline double timeline_time() {
+#ifdef HOST_BUILD
+    return host_hardware().Clock();
+#else
+    return (TimeNow)();
+#endif
+}
+
+/*******************************************************
+ * @brief Adds an event to the timeline
+ *
+ * @param phase 'B', 'E' or 'i'
+ * @param track TimelineTrack the event goes on
+ * @param name Name of the event (string literal)
+ * @param arg Value shown with the event
+ */
+inline void timeline_event(char phase, int track, const char name[], float arg) {
+    if (timelineCount >= TIMELINE_CAPACITY) {
+        timelineOverflowed = true;
+        return;
+    }
+
+    TimelineEvent &event = timelineEvents[timelineCount++];
+    event.name = name;
+    event.time = timeline_time();
+    event.arg = arg;
+    event.phase = phase;
+    event.track = track;
+}
+
+/*******************************************************
+ * @brief Charges the time since the last call to the innermost timed call
+ */
+void timeline_cost_charge() {
+    double now = timeline_time();
+    if (timelineCostLastTime < 0) {
+        timelineCostLastTime = now;
+        return;
+    }
+
+    float seconds = now - timelineCostLastTime;
+    timelineCostLastTime = now;
+
+    int cost = COST_OTHER;
+    int line = 0;
+    if (timelineCostDepth > 0) {
+        TimelineCostFrame &frame = timelineCostStack[(timelineCostDepth < TIMELINE_COST_DEPTH) ? timelineCostDepth - 1 : TIMELINE_COST_DEPTH - 1];
+        cost = frame.cost;
+        line = frame.line;
+    }
+
+    // Same site as last time is the common case (a loop inside one call)
+    for (int i = timelineCostSiteCount - 1; i >= 0; i--) {
+        TimelineCostSite &site = timelineCostSites[i];
+        if ((site.line == line) && (site.stage == timelineStageIndex) && (site.cost == cost)) {
+            site.seconds += seconds;
+            return;
+        }
+    }
+
+    if (timelineCostSiteCount >= TIMELINE_COST_SITES) {
+        timelineCostOverflowed = true;
+        return;
+    }
+
+    TimelineCostSite &site = timelineCostSites[timelineCostSiteCount++];
+    site.seconds = seconds;
+    site.line = line;
+    site.stage = timelineStageIndex;
+    site.cost = cost;
+}
+
+/*******************************************************
+ * @brief Starts charging time to a timed call
+ *
+ * @param cost TimelineCost of the call
+ * @param line Line it was called from
+ */
+void timeline_cost_push(int cost, int line) {
+    timeline_cost_charge();
+
+    // Motion, RPS corrections and sensor waits own everything they do except screen I/O.
+    // The outermost call site gets the time so it points at a line in run_course().
+    if ((timelineCostDepth > 0) && (timelineCostDepth <= TIMELINE_COST_DEPTH)) {
+        TimelineCostFrame &outer = timelineCostStack[timelineCostDepth - 1];
+        bool owned = (outer.cost == COST_MOTION) || (outer.cost == COST_RPS) || (outer.cost == COST_SENSOR_WAIT);
+        if (owned && (cost != COST_LCD)) {
+            cost = outer.cost;
+        }
+        if (outer.line) {
+            line = outer.line;
+        }
+    }
+
+    if (timelineCostDepth < TIMELINE_COST_DEPTH) {
+        timelineCostStack[timelineCostDepth].cost = cost;
+        timelineCostStack[timelineCostDepth].line = line;
+    }
+    timelineCostDepth++;
+}
+
+/*******************************************************
+ * @brief Stops charging time to the innermost timed call
+ */
+void timeline_cost_pop() {
+    timeline_cost_charge();
+    if (timelineCostDepth > 0) {
+        timelineCostDepth--;
+    }
+}
+
+/*******************************************************
+ * @brief Begin event on construction, end event when it goes out of scope.
+ * Declare one at the top of a function to put the whole function on the timeline.
+ */
+class TimelineScope {
+public:
+    TimelineScope(const char name[], float arg = 0, int cost = COST_OTHER, int line = 0) : name(name) {
+        // Anything other than a Sleep means nobody is waiting on the servo anymore
+        if (cost != COST_SLEEP) {
+            timelineServoPending = false;
+        } else if (timelineServoPending) {
+            cost = COST_SERVO_WAIT;
+            timelineServoPending = false;
+        }
+
+        timeline_cost_push(cost, line);
+        timeline_event('B', TIMELINE_TRACK_ROBOT, name, arg);
+    }
+
+    ~TimelineScope() {
+        timeline_event('E', TIMELINE_TRACK_ROBOT, name, 0);
+        timeline_cost_pop();
+    }
+
+private:
+    const char *name;
+};
+
+/*******************************************************
+ * @brief Ends the current course stage (if any) and starts a new one
+ *
+ * @param name Name of the stage (string literal)
+ */
+void timeline_stage(const char name[]) {
+    if (timelineStage) {
+        timeline_event('E', TIMELINE_TRACK_STAGE, timelineStage, 0);
+    }
+
+    timeline_cost_charge();
+    timelineStageIndex = 0;
+    for (int i = 1; i < timelineStageCount; i++) {
+        if (!strcmp(timelineStageNames[i], name)) {
+            timelineStageIndex = i;
+        }
+    }
+    if (!timelineStageIndex && (timelineStageCount < TIMELINE_STAGES)) {
+        timelineStageIndex = timelineStageCount++;
+        timelineStageNames[timelineStageIndex] = name;
+    }
+
+    timelineStage = name;
+    timeline_event('B', TIMELINE_TRACK_STAGE, name, 0);
+}
+
+/*******************************************************
+ * @brief Ends the current course stage
+ */
+void timeline_stage_end() {
+    if (timelineStage) {
+        timeline_event('E', TIMELINE_TRACK_STAGE, timelineStage, 0);
+        timelineStage = 0;
+    }
+
+    timeline_cost_charge();
+    timelineStageIndex = 0;
+}
+
+/*******************************************************
+ * @brief Writes the timeline to the SD card
+ *
+ * @param path File to write
+ */
+void timeline_write(const char path[]) {
+    FEHFile *file = SD.FOpen(path, "w");
+
+    SD.FPrintf(file, "TIMELINE %d\n", TIMELINE_VERSION);
+    for (int i = 0; i < timelineCount; i++) {
+        TimelineEvent &event = timelineEvents[i];
+        SD.FPrintf(file, "%c %d %lu %ld %s\n", event.phase, event.track, (unsigned long)(event.time * 1e6),
+                   (long)(event.arg * 1000), event.name);
+    }
+    SD.FPrintf(file, "END %d %d\n", timelineCount, timelineOverflowed ? 1 : 0);
+
+    SD.FClose(file);
+}
+
+/*******************************************************
+ * @brief Writes the time charged to each category, stage and call site to the SD card
+ *
+ * @param path File to write
+ */
+void timeline_write_costs(const char path[]) {
+    timeline_cost_charge();
+
+    FEHFile *file = SD.FOpen(path, "w");
+
+    SD.FPrintf(file, "COSTS %d\n", TIMELINE_VERSION);
+    for (int i = 0; i < timelineStageCount; i++) {
+        SD.FPrintf(file, "STAGE %d %s\n", i, timelineStageNames[i]);
+    }
+    for (int i = 0; i < timelineCostSiteCount; i++) {
+        TimelineCostSite &site = timelineCostSites[i];
+        SD.FPrintf(file, "C %d %d %d %lu\n", site.stage, site.cost, site.line, (unsigned long)(site.seconds * 1e6));
+    }
+    SD.FPrintf(file, "END %d %d\n", timelineCostSiteCount, timelineCostOverflowed ? 1 : 0);
+
+    SD.FClose(file);
+}
+
+/************************************************/
+// Sleep(), servos and the screen show up on the timeline by themselves
+
+inline void timeline_Sleep(int msec, int line = TIMELINE_CALL_SITE) {
+    TimelineScope timeline("Sleep", msec / 1000.0f, COST_SLEEP, line);
+    Sleep(msec);
+}
+
+inline void timeline_Sleep(float seconds, int line = TIMELINE_CALL_SITE) {
+    TimelineScope timeline("Sleep", seconds, COST_SLEEP, line);
+    Sleep(seconds);
+}
+
+inline void timeline_Sleep(double seconds, int line = TIMELINE_CALL_SITE) {
+    TimelineScope timeline("Sleep", seconds, COST_SLEEP, line);
+    Sleep(seconds);
+}
+
+class TimelineFEHServo : public FEHServo {
+public:
+    TimelineFEHServo(FEHServo::FEHServoPort port) : FEHServo(port), timelinePort(port) {}
+
+    void SetDegree(float degree) {
+        static const char *names[] = {
+            "Servo0 SetDegree", "Servo1 SetDegree", "Servo2 SetDegree", "Servo3 SetDegree",
+            "Servo4 SetDegree", "Servo5 SetDegree", "Servo6 SetDegree", "Servo7 SetDegree"
+        };
+
+        timeline_event('i', TIMELINE_TRACK_SERVO, names[timelinePort & 7], degree);
+        FEHServo::SetDegree(degree);
+        timelineServoPending = true;
+    }
+
+private:
+    int timelinePort;
+};
+
+// Screen calls are too frequent for the timeline, so they are only charged to COST_LCD
+class TimelineLCD {
+public:
+    void Clear(int line = TIMELINE_CALL_SITE) { Cost cost(line); LCD.Clear(); }
+    void ClearBuffer(int line = TIMELINE_CALL_SITE) { Cost cost(line); LCD.ClearBuffer(); }
+    void SetBackgroundColor(unsigned int color) { LCD.SetBackgroundColor(color); }
+    void SetFontColor(unsigned int color) { LCD.SetFontColor(color); }
+    void FillRectangle(int x, int y, int width, int height, int line = TIMELINE_CALL_SITE) {
+        Cost cost(line);
+        LCD.FillRectangle(x, y, width, height);
+    }
+    void DrawHorizontalLine(int y, int x1, int x2, int line = TIMELINE_CALL_SITE) {
+        Cost cost(line);
+        LCD.DrawHorizontalLine(y, x1, x2);
+    }
+    void DrawVerticalLine(int x, int y1, int y2, int line = TIMELINE_CALL_SITE) {
+        Cost cost(line);
+        LCD.DrawVerticalLine(x, y1, y2);
+    }
+    template <typename T> void Write(T value, int line = TIMELINE_CALL_SITE) { Cost cost(line); LCD.Write(value); }
+    template <typename T> void WriteLine(T value, int line = TIMELINE_CALL_SITE) { Cost cost(line); LCD.WriteLine(value); }
+    template <typename T> void WriteRC(T value, int row, int col, int line = TIMELINE_CALL_SITE) {
+        Cost cost(line);
+        LCD.WriteRC(value, row, col);
+    }
+    bool Touch(int *x, int *y, int line = TIMELINE_CALL_SITE) { Cost cost(line); return LCD.Touch(x, y); }
+
+private:
+    // Charges the call to COST_LCD without a timeline event
+    struct Cost {
+        Cost(int line) { timeline_cost_push(COST_LCD, line); }
+        ~Cost() { timeline_cost_pop(); }
+    };
+};
+
+TimelineLCD timeline_LCD;
+
+// Replaces the sensor trace versions (if any) with versions that wrap them
+#undef Sleep
+#undef FEHServo
+#undef LCD
+#define Sleep timeline_Sleep
+#define FEHServo TimelineFEHServo
+#define LCD timeline_LCD
+
+#endif
@@ -0,0 +1,62 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*       Timeline and cost file formats      */
+/*                                           */
+/*  Shared by the recorder on the robot      */
+/*  (timeline.h) and the host tools          */
+/*  (host/timeline2json, host/cost_report).  */
+/*********************************************/
+
+#ifndef TIMELINE_FORMAT_H
+#define TIMELINE_FORMAT_H
+
+/************************************************/
+// Definitions
+#define TIMELINE_VERSION 1
+#define TIMELINE_FILE "timeline.txt"
+#define TIMELINE_COST_FILE "costs.txt"
+
+// Rows in the trace viewer
+enum TimelineTrack {
+    TIMELINE_TRACK_ROBOT = 1, // Motion, corrections and sleeps (these nest)
+    TIMELINE_TRACK_STAGE = 2, // Course stages from run_course()
+    TIMELINE_TRACK_SERVO = 3 // Servo commands
+};
+
+// What a stretch of time is charged to
+enum TimelineCost {
+    COST_OTHER = 0, // Course code between calls, composite routines like flip_burger()
+    COST_MOTION = 1, // Driving and turning
+    COST_RPS = 2, // RPS_correct_heading(), RPS_check_x(), RPS_check_y()
+    COST_SLEEP = 3, // Sleep() called from course code
+    COST_SERVO_WAIT = 4, // First Sleep() after a servo command
+    COST_SENSOR_WAIT = 5, // detect_color(), read_start_light()
+    COST_LCD = 6, // Screen writes and touch reads
+    COST_COUNT = 7
+};
+
+/*
+ * Timeline file layout (one event per line):
+ *
+ *   TIMELINE <version>
+ *   <phase> <track> <time in microseconds> <arg * 1000> <name>
+ *   ...
+ *   END <number of events> <1 if the buffer overflowed, 0 if not>
+ *
+ * Phases are B (begin), E (end) and i (instant), same as the Chrome trace format.
+ */
+
+/*
+ * Cost file layout:
+ *
+ *   COSTS <version>
+ *   STAGE <index> <name>
+ *   ...
+ *   C <stage> <category> <line> <microseconds>
+ *   ...
+ *   END <number of C lines> <1 if the site table overflowed, 0 if not>
+ *
+ * Stage 0 is time outside any stage. Line 0 is time outside any timed call.
+ */
+
+#endif
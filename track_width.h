@@ -0,0 +1,112 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*             Track width file              */
+/*                                           */
+/*  Keeps the effective track widths the     */
+/*  turns have learned from RPS on the SD    */
+/*  card, so each run starts from what the   */
+/*  last one ended with. Scrub makes the     */
+/*  width the wheels act like differ from    */
+/*  ROBOT_WIDTH, and differently on the      */
+/*  ramp and at higher turn speeds. Without  */
+/*  a file (or with a bad line) every width  */
+/*  starts at ROBOT_WIDTH. Everything here   */
+/*  is inline, since the replay tool         */
+/*  includes it next to main.cpp.            */
+/*                                           */
+/*  File layout (slow, then fast turns):     */
+/*    TRACK <version>                        */
+/*    FLOOR <width> <samples> <width> <samp> */
+/*    RAMP <width> <samples> <width> <samp>  */
+/*    END                                    */
+/*********************************************/
+
+#ifndef TRACK_WIDTH_H
+#define TRACK_WIDTH_H
+
+#include <FEHSD.h>
+
+/************************************************/
+// Definitions
+#define TRACK_WIDTH_VERSION 1
+#define TRACK_WIDTH_FILE "track.txt"
+
+#define TRACK_WIDTH_SURFACES 2 // Same order as SURFACE_FLOOR and SURFACE_RAMP
+#define TRACK_WIDTH_SPEEDS 2 // Slow and fast turns
+
+/*******************************************************
+ * @brief Learned widths for each surface and turn speed
+ */
+struct TrackWidths {
+    float width[TRACK_WIDTH_SURFACES][TRACK_WIDTH_SPEEDS]; // Inches
+    int samples[TRACK_WIDTH_SURFACES][TRACK_WIDTH_SPEEDS]; // Turns they came from
+};
+
+/*******************************************************
+ * @brief Reads one surface's line. Leaves it alone if the line is bad.
+ */
+inline bool track_width_load_line(FEHFile *file, const char format[], float width[], int samples[], float lowest,
+                                  float highest) {
+    float readWidth[TRACK_WIDTH_SPEEDS];
+    int readSamples[TRACK_WIDTH_SPEEDS];
+    if (SD.FScanf(file, format, &readWidth[0], &readSamples[0], &readWidth[1], &readSamples[1]) != 4) {
+        return false;
+    }
+
+    for (int i = 0; i < TRACK_WIDTH_SPEEDS; i++) {
+        if ((readWidth[i] < lowest) || (readWidth[i] > highest) || (readSamples[i] < 0)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < TRACK_WIDTH_SPEEDS; i++) {
+        width[i] = readWidth[i];
+        samples[i] = readSamples[i];
+    }
+    return true;
+}
+
+/*******************************************************
+ * @brief Reads the track width file. A surface whose line is missing or has
+ * a width outside lowest..highest keeps the values it came in with.
+ *
+ * @param path File to read
+ * @return bool true if both surfaces were read
+ */
+inline bool track_width_load(const char path[], TrackWidths &widths, float lowest, float highest) {
+    FEHFile *file = SD.FOpen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    int version = 0;
+    bool haveFloor = false, haveRamp = false;
+
+    if ((SD.FScanf(file, "TRACK %d", &version) == 1) && (version == TRACK_WIDTH_VERSION)) {
+        haveFloor = track_width_load_line(file, " FLOOR %f %d %f %d", widths.width[0], widths.samples[0], lowest, highest);
+        haveRamp = haveFloor &&
+                   track_width_load_line(file, " RAMP %f %d %f %d", widths.width[1], widths.samples[1], lowest, highest);
+    }
+    SD.FClose(file);
+
+    return haveFloor && haveRamp;
+}
+
+/*******************************************************
+ * @brief Writes the track width file
+ *
+ * @param path File to write
+ */
+inline void track_width_save(const char path[], const TrackWidths &widths) {
+    FEHFile *file = SD.FOpen(path, "w");
+
+    SD.FPrintf(file, "TRACK %d\n", TRACK_WIDTH_VERSION);
+    SD.FPrintf(file, "FLOOR %.3f %d %.3f %d\n", widths.width[0][0], widths.samples[0][0], widths.width[0][1],
+               widths.samples[0][1]);
+    SD.FPrintf(file, "RAMP %.3f %d %.3f %d\n", widths.width[1][0], widths.samples[1][0], widths.width[1][1],
+               widths.samples[1][1]);
+    SD.FPrintf(file, "END\n");
+
+    SD.FClose(file);
+}
+
+#endif
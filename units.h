@@ -0,0 +1,90 @@
+/*********************************************/
+/*      Team A3 FEH Robot Project Code       */
+/*                Unit types                 */
+/*                                           */
+/*  Inches, Counts, Degrees, Percent,        */
+/*  InchesPerSecond and Seconds are each     */
+/*  their own type around one float, so      */
+/*  passing a percent where a speed goes (or */
+/*  inches where degrees go) is a compile    */
+/*  error instead of a wrong move. They are  */
+/*  exactly a float in memory and every      */
+/*  operation is constexpr, so they cost     */
+/*  nothing over the bare numbers.           */
+/*                                           */
+/*  Write values with a suffix (12_in,       */
+/*  90_deg, 45_pct, 5_ips, 0.5_s) or the     */
+/*  type's name (Inches(9 + DIST_AXIS_CDS)). */
+/*  .value gets the float back out for the   */
+/*  FEH calls.                               */
+/*********************************************/
+
+#ifndef UNITS_H
+#define UNITS_H
+
+/*******************************************************
+ * @brief A float in some unit. Only adds, subtracts and compares with the same
+ * unit, and scales by a plain number.
+ */
+template <typename Unit>
+struct Quantity {
+    float value;
+
+    constexpr Quantity() : value(0) {}
+    constexpr explicit Quantity(float value) : value(value) {}
+
+    constexpr Quantity operator-() const { return Quantity(-value); }
+    constexpr Quantity operator+(Quantity other) const { return Quantity(value + other.value); }
+    constexpr Quantity operator-(Quantity other) const { return Quantity(value - other.value); }
+    constexpr Quantity operator*(float scale) const { return Quantity(value * scale); }
+    constexpr Quantity operator/(float scale) const { return Quantity(value / scale); }
+    constexpr float operator/(Quantity other) const { return value / other.value; }
+
+    constexpr bool operator<(Quantity other) const { return value < other.value; }
+    constexpr bool operator>(Quantity other) const { return value > other.value; }
+    constexpr bool operator<=(Quantity other) const { return value <= other.value; }
+    constexpr bool operator>=(Quantity other) const { return value >= other.value; }
+};
+
+template <typename Unit>
+constexpr Quantity<Unit> operator*(float scale, Quantity<Unit> quantity) {
+    return quantity * scale;
+}
+
+/************************************************/
+// Units
+struct InchUnit {};
+struct CountUnit {};
+struct DegreeUnit {};
+struct PercentUnit {};
+struct InchPerSecondUnit {};
+struct SecondUnit {};
+
+typedef Quantity<InchUnit> Inches; // Distance driven
+typedef Quantity<CountUnit> Counts; // Encoder counts (fractional while they are a target)
+typedef Quantity<DegreeUnit> Degrees; // Angle turned or heading
+typedef Quantity<PercentUnit> Percent; // Motor power, -100 to 100
+typedef Quantity<InchPerSecondUnit> InchesPerSecond; // Speed for move_forward_PID()
+typedef Quantity<SecondUnit> Seconds; // Time
+
+// Distance over time is a speed
+constexpr InchesPerSecond operator/(Inches inches, Seconds seconds) {
+    return InchesPerSecond(inches.value / seconds.value);
+}
+
+/************************************************/
+// Suffixes. Whole numbers and decimals both work (12_in, 11.5_in).
+#define UNITS_SUFFIX(Type, suffix) \
+    constexpr Type operator"" suffix(long double value) { return Type((float)(double)value); } \
+    constexpr Type operator"" suffix(unsigned long long value) { return Type((float)(double)value); }
+
+UNITS_SUFFIX(Inches, _in)
+UNITS_SUFFIX(Counts, _counts)
+UNITS_SUFFIX(Degrees, _deg)
+UNITS_SUFFIX(Percent, _pct)
+UNITS_SUFFIX(InchesPerSecond, _ips)
+UNITS_SUFFIX(Seconds, _s)
+
+#undef UNITS_SUFFIX
+
+#endif